@@ -27,4 +27,9 @@ cd ..
 mkdir VK
 cd VK
 cmake ..\.. -DGFX_API=VK
+cd ..
+
+mkdir CPU
+cd CPU
+cmake ..\.. -DGFX_API=CPU
 cd ..
\ No newline at end of file
@@ -0,0 +1,647 @@
+//CAS Sample
+//
+// Copyright(c) 2019 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Microbenchmark for the CPU CAS kernels.
+// Times every tier and CAS_* variant in sharpen-only mode over the sample's common render resolutions and in scaling
+// mode over the example area ratios documented above CAS_AREA_LIMIT in ffx_cas.h.
+// Each case is warmed up, repeated, and reported as ns/pixel and GB/s from the median with percentiles; --json writes
+// the same data so runs on different hosts or revisions can be compared.
+// Where perf_event_open is usable the timed runs are also wrapped in hardware counters, giving IPC and cache/TLB misses
+// per pixel to tell latency bound cases from ALU bound ones. Without counters only the timings are reported.
+// Finally every case is placed on a roofline: counted float ops and compulsory bytes per pixel give the arithmetic
+// intensity, which is compared with the host's measured copy bandwidth and multiply-add peak for the tier.
+
+#include "CAS_Bench.h"
+#include "CAS_PerfCounters.h"
+#include "CAS_Roofline.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+
+using namespace CAS_SAMPLE_CPU;
+
+struct ScalingCase
+{
+    const char* pName;
+    uint32_t InputWidth;
+    uint32_t InputHeight;
+    uint32_t OutputWidth;
+    uint32_t OutputHeight;
+};
+
+// Example resolutions listed above CAS_AREA_LIMIT in ffx_cas.h.
+static const ScalingCase s_ScalingCases[] =
+{
+    { "1280x720->1080p",  1280,  720, 1920, 1080 },
+    { "1536x864->1080p",  1536,  864, 1920, 1080 },
+    { "1792x1008->1440p", 1792, 1008, 2560, 1440 },
+    { "1920x1080->1440p", 1920, 1080, 2560, 1440 },
+    { "1920x1080->4K",    1920, 1080, 3840, 2160 },
+    { "2048x1152->1440p", 2048, 1152, 2560, 1440 },
+    { "2560x1440->4K",    2560, 1440, 3840, 2160 },
+    { "3072x1728->4K",    3072, 1728, 3840, 2160 },
+};
+
+
+struct BenchResult
+{
+    CAS_Tier                TierId;
+    std::string             Tier;
+    std::string             Variant;
+    std::string             Mode;
+    std::string             Case;
+    uint32_t                InputWidth;
+    uint32_t                InputHeight;
+    uint32_t                OutputWidth;
+    uint32_t                OutputHeight;
+    double                  MinNs;
+    double                  MedianNs;
+    double                  MeanNs;
+    double                  P10Ns;
+    double                  P90Ns;
+    double                  P99Ns;
+    double                  NsPerPixel;
+    double                  GBPerSecond;
+    CAS_CounterValues       Counters;           // Mean per run.
+    CAS_KernelCost          Cost;               // Per output pixel.
+    double                  BytesPerPixel;      // Compulsory memory traffic per output pixel.
+    uint64_t                ClassifyDiffs;      // --no-classify: pixels that differ with classification on,
+    double                  ClassifyMaxDiff;    // and the largest channel difference.
+};
+
+struct HostRoofline
+{
+    double                  Bandwidth = 0.0;    // GB/s
+    double                  PeakFlops[CAS_Tier_Count] = {};   // GFLOP/s
+};
+
+//
+// With --no-classify, filters an image of textured, flat and saturated bands once with classification and once
+// without, and counts the output pixels that differ, to check kernel changes against what SetClassification() states.
+//
+static void CompareClassification(const BenchOptions& options, CAS_Tier tier, uint32_t variant, bool sharpenOnly,
+                                  uint32_t inputWidth, uint32_t inputHeight, uint32_t outputWidth, uint32_t outputHeight, BenchResult& result)
+{
+    std::vector<uint8_t> inputStorage, classifiedStorage, fullStorage;
+    CAS_Image input = {}, classified = {}, full = {};
+    FillTestImage(inputStorage, input, inputWidth, inputHeight, options.Format);
+    FillTestImage(classifiedStorage, classified, outputWidth, outputHeight, options.Format);
+    FillTestImage(fullStorage, full, outputWidth, outputHeight, options.Format);
+
+    // The second quarter of the rows is flat in stripes of 32 columns, the third a checker of 0 and 1, which is saturated.
+    const uint32_t pixelSize = CAS_Filter::GetFormatSize(options.Format);
+    for (uint32_t y = inputHeight / 4; y < inputHeight * 3 / 4; ++y)
+    {
+        for (uint32_t x = 0; x < inputWidth; ++x)
+        {
+            float rgb[3];
+            for (uint32_t c = 0; c < 3; ++c)
+            {
+                rgb[c] = (y < inputHeight / 2) ? static_cast<float>((x / 32 + c * 5) % 17) * (1.0f / 16.0f) : static_cast<float>(((x / 3) ^ (y / 3)) & 1);
+            }
+            StorePixel(options.Format, inputStorage.data() + static_cast<size_t>(y) * input.RowPitch + x * pixelSize, rgb);
+        }
+    }
+
+    const CAS_State casState = sharpenOnly ? CAS_State_SharpenOnly : CAS_State_Upsample;
+    CAS_Filter filter;
+    filter.OnCreate(options.Threads, tier);
+    filter.SetVariant(variant);
+    filter.OnCreateWindowSizeDependentResources(inputWidth, inputHeight, outputWidth, outputHeight, casState);
+    filter.UpdateSharpness(options.Sharpness, casState);
+    filter.SetClassification(true);
+    filter.Upscale(input, classified, casState);
+    filter.SetClassification(false);
+    filter.Upscale(input, full, casState);
+    filter.OnDestroyWindowSizeDependentResources();
+    filter.OnDestroy();
+
+    result.ClassifyDiffs = 0;
+    result.ClassifyMaxDiff = 0.0;
+    for (uint32_t y = 0; y < outputHeight; ++y)
+    {
+        for (uint32_t x = 0; x < outputWidth; ++x)
+        {
+            float a[3], b[3];
+            CAS_Filter::LoadPixel(classified, x, y, a[0], a[1], a[2]);
+            CAS_Filter::LoadPixel(full, x, y, b[0], b[1], b[2]);
+            double diff = 0.0;
+            for (int c = 0; c < 3; ++c)
+            {
+                diff = std::max(diff, static_cast<double>(std::fabs(a[c] - b[c])));
+            }
+            result.ClassifyDiffs += (diff > 0.0) ? 1 : 0;
+            result.ClassifyMaxDiff = std::max(result.ClassifyMaxDiff, diff);
+        }
+    }
+}
+
+static BenchResult RunCase(const BenchOptions& options, CAS_Tier tier, uint32_t variant, bool sharpenOnly, const char* pCaseName,
+                           uint32_t inputWidth, uint32_t inputHeight, uint32_t outputWidth, uint32_t outputHeight)
+{
+    std::vector<uint8_t> inputStorage, outputStorage;
+    CAS_Image input = {}, output = {};
+    FillTestImage(inputStorage, input, inputWidth, inputHeight, options.Format);
+    FillTestImage(outputStorage, output, outputWidth, outputHeight, options.Format);
+
+    const CAS_State casState = sharpenOnly ? CAS_State_SharpenOnly : CAS_State_Upsample;
+
+    // Opened before the filter creates its thread pool so the workers inherit the counters.
+    CAS_PerfCounters counters;
+    if (options.Counters)
+    {
+        counters.Open();
+    }
+
+    CAS_Filter filter;
+    filter.OnCreate(options.Threads, tier);
+    filter.SetVariant(variant);
+    filter.SetClassification(options.Classify);
+    filter.OnCreateWindowSizeDependentResources(inputWidth, inputHeight, outputWidth, outputHeight, casState);
+    filter.UpdateSharpness(options.Sharpness, casState);
+
+    for (uint32_t i = 0; i < options.Warmup; ++i)
+    {
+        filter.Upscale(input, output, casState);
+    }
+
+    std::vector<double> samples;
+    samples.reserve(options.Repeat);
+    CAS_CounterValues counterSum = {};
+    bool countersValid[CAS_Counter_Count];
+    for (int c = 0; c < CAS_Counter_Count; ++c)
+    {
+        countersValid[c] = counters.IsAvailable(static_cast<CAS_Counter>(c));
+    }
+    for (uint32_t i = 0; i < options.Repeat; ++i)
+    {
+        CAS_CounterValues runCounters;
+        counters.Start();
+        auto start = std::chrono::steady_clock::now();
+        filter.Upscale(input, output, casState);
+        auto end = std::chrono::steady_clock::now();
+        counters.Stop(runCounters);
+        samples.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+
+        for (int c = 0; c < CAS_Counter_Count; ++c)
+        {
+            counterSum.Value[c] += runCounters.Value[c];
+            countersValid[c] = countersValid[c] && runCounters.Valid[c];
+        }
+    }
+
+    filter.OnDestroyWindowSizeDependentResources();
+    filter.OnDestroy();
+
+    std::sort(samples.begin(), samples.end());
+    double sum = 0.0;
+    for (double s : samples)
+    {
+        sum += s;
+    }
+
+    // Compulsory traffic: every source texel read once and every output pixel written once.
+    const double pixelSize = static_cast<double>(CAS_Filter::GetFormatSize(options.Format));
+    const double outputPixels = static_cast<double>(outputWidth) * outputHeight;
+    const double bytes = (static_cast<double>(inputWidth) * inputHeight + outputPixels) * pixelSize;
+
+    BenchResult result;
+    result.TierId = tier;
+    result.Tier = CAS_Filter::GetTierName(tier);
+    result.Variant = CAS_Filter::GetVariantName(variant);
+    result.Mode = sharpenOnly ? "SharpenOnly" : "Upsample";
+    result.Case = pCaseName;
+    result.InputWidth = inputWidth;
+    result.InputHeight = inputHeight;
+    result.OutputWidth = outputWidth;
+    result.OutputHeight = outputHeight;
+    result.MinNs = samples.front();
+    result.MedianNs = Percentile(samples, 0.5);
+    result.MeanNs = sum / static_cast<double>(samples.size());
+    result.P10Ns = Percentile(samples, 0.1);
+    result.P90Ns = Percentile(samples, 0.9);
+    result.P99Ns = Percentile(samples, 0.99);
+    result.NsPerPixel = result.MedianNs / outputPixels;
+    result.GBPerSecond = bytes / result.MedianNs;
+    CAS_Roofline::CountKernelCost(sharpenOnly, variant, result.Cost);
+    result.BytesPerPixel = bytes / outputPixels;
+    for (int c = 0; c < CAS_Counter_Count; ++c)
+    {
+        result.Counters.Value[c] = counterSum.Value[c] / options.Repeat;
+        result.Counters.Valid[c] = countersValid[c];
+    }
+    result.ClassifyDiffs = 0;
+    result.ClassifyMaxDiff = 0.0;
+    if (!options.Classify)
+    {
+        CompareClassification(options, tier, variant, sharpenOnly, inputWidth, inputHeight, outputWidth, outputHeight, result);
+    }
+    return result;
+}
+
+static void WriteJson(const BenchOptions& options, const HostRoofline& host, const std::vector<BenchResult>& results, FILE* pFile)
+{
+    static const char* s_formatNames[] = { "RGBA32F", "RGBA16F", "RGBA8", "R10G10B10A2", "R32F", "RG32F", "R8", "RG8" };
+
+    fprintf(pFile, "{\n");
+    fprintf(pFile, "  \"timestamp\": %lld,\n", static_cast<long long>(time(nullptr)));
+    fprintf(pFile, "  \"threads\": %u,\n", options.Threads);
+    fprintf(pFile, "  \"format\": \"%s\",\n", s_formatNames[options.Format]);
+    fprintf(pFile, "  \"sharpness\": %g,\n", options.Sharpness);
+    fprintf(pFile, "  \"warmup\": %u,\n", options.Warmup);
+    fprintf(pFile, "  \"repeat\": %u,\n", options.Repeat);
+    if (options.Roofline)
+    {
+        fprintf(pFile, "  \"host\": { \"bandwidth_gb_s\": %.2f, \"peak_gflops\": {", host.Bandwidth);
+        const char* pSeparator = " ";
+        for (int tier = 0; tier < CAS_Tier_Count; ++tier)
+        {
+            if (host.PeakFlops[tier] > 0.0)
+            {
+                fprintf(pFile, "%s\"%s\": %.2f", pSeparator, CAS_Filter::GetTierName(static_cast<CAS_Tier>(tier)), host.PeakFlops[tier]);
+                pSeparator = ", ";
+            }
+        }
+        fprintf(pFile, " } },\n");
+    }
+    fprintf(pFile, "  \"results\": [\n");
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const BenchResult& r = results[i];
+        fprintf(pFile, "    { \"tier\": \"%s\", \"variant\": \"%s\", \"mode\": \"%s\", \"case\": \"%s\", "
+                       "\"input\": [%u, %u], \"output\": [%u, %u], "
+                       "\"min_ns\": %.0f, \"median_ns\": %.0f, \"mean_ns\": %.0f, \"p10_ns\": %.0f, \"p90_ns\": %.0f, \"p99_ns\": %.0f, "
+                       "\"ns_per_pixel\": %.4f, \"gb_per_s\": %.3f, "
+                       "\"flops_per_pixel\": %.2f, \"int_ops_per_pixel\": %.2f, \"bytes_per_pixel\": %.2f, \"counters\": {",
+                r.Tier.c_str(), r.Variant.c_str(), r.Mode.c_str(), r.Case.c_str(),
+                r.InputWidth, r.InputHeight, r.OutputWidth, r.OutputHeight,
+                r.MinNs, r.MedianNs, r.MeanNs, r.P10Ns, r.P90Ns, r.P99Ns,
+                r.NsPerPixel, r.GBPerSecond,
+                r.Cost.Flops, r.Cost.IntOps, r.BytesPerPixel);
+
+        // Counters the host could not provide are left out rather than written as 0.
+        const char* pSeparator = " ";
+        for (int c = 0; c < CAS_Counter_Count; ++c)
+        {
+            if (r.Counters.Valid[c])
+            {
+                fprintf(pFile, "%s\"%s\": %llu", pSeparator, CAS_PerfCounters::GetCounterName(static_cast<CAS_Counter>(c)),
+                        static_cast<unsigned long long>(r.Counters.Value[c]));
+                pSeparator = ", ";
+            }
+        }
+        fprintf(pFile, " }");
+        if (!options.Classify)
+        {
+            fprintf(pFile, ", \"classify_diff_pixels\": %llu, \"classify_max_diff\": %g", static_cast<unsigned long long>(r.ClassifyDiffs), r.ClassifyMaxDiff);
+        }
+        fprintf(pFile, " }%s\n", (i + 1 < results.size()) ? "," : "");
+    }
+    fprintf(pFile, "  ]\n");
+    fprintf(pFile, "}\n");
+}
+
+//
+// Attainable throughput is min(peak, intensity * bandwidth); the kernel is memory bound left of the ridge point and
+// compute bound right of it. Integer ops of the approximations are reported but not part of the float intensity.
+//
+static void PrintRoofline(const HostRoofline& host, const std::vector<BenchResult>& results)
+{
+    printf("\nRoofline: copy bandwidth %.1f GB/s, multiply-add peak", host.Bandwidth);
+    for (int tier = 0; tier < CAS_Tier_Count; ++tier)
+    {
+        if (host.PeakFlops[tier] > 0.0)
+        {
+            printf(" %s %.1f", CAS_Filter::GetTierName(static_cast<CAS_Tier>(tier)), host.PeakFlops[tier]);
+        }
+    }
+    printf(" GFLOP/s\n");
+    printf("%-7s %-44s %-12s %-18s %9s %9s %8s %9s %9s %11s %7s %-7s\n", "Tier", "Variant", "Mode", "Case",
+           "flop/px", "intop/px", "byte/px", "flop/byte", "GFLOP/s", "attainable", "%roof", "bound");
+    for (const BenchResult& r : results)
+    {
+        const double peak = host.PeakFlops[r.TierId];
+        const double intensity = r.Cost.Flops / r.BytesPerPixel;
+        const double achieved = r.Cost.Flops / r.NsPerPixel;
+        const double memoryRoof = intensity * host.Bandwidth;
+        const double attainable = std::min(peak, memoryRoof);
+        printf("%-7s %-44s %-12s %-18s %9.1f %9.1f %8.2f %9.2f %9.2f %11.2f %6.1f%% %-7s\n", r.Tier.c_str(), r.Variant.c_str(), r.Mode.c_str(), r.Case.c_str(),
+               r.Cost.Flops, r.Cost.IntOps, r.BytesPerPixel, intensity, achieved, attainable,
+               attainable > 0.0 ? 100.0 * achieved / attainable : 0.0, memoryRoof < peak ? "memory" : "compute");
+    }
+}
+
+static void PrintCounter(bool valid, double value, int width, int precision)
+{
+    if (valid)
+    {
+        printf(" %*.*f", width, precision, value);
+    }
+    else
+    {
+        printf(" %*s", width, "-");
+    }
+}
+
+static void PrintUsage()
+{
+    printf("Usage: CAS_Bench [options]\n"
+           "  --tier <scalar|sse2|avx2|all>     Kernel tiers to run (default all supported)\n"
+           "  --variant <0-7|all>               CAS_Variant flags to run (default all)\n"
+           "  --mode <sharpen|upsample|all>     Filter modes to run (default all)\n"
+           "  --format <rgba32f|rgba16f|rgba8>  Input and output format, r32f and r8 filter one channel (default rgba16f)\n"
+           "  --threads <n>                     Worker threads, 0 = all hardware threads (default 1)\n"
+           "  --warmup <n>                      Untimed runs per case (default 3)\n"
+           "  --repeat <n>                      Timed runs per case (default 15)\n"
+           "  --sharpness <0-1>                 Sharpness passed to CasSetup() (default 0)\n"
+           "  --quick                           Only 1080p sharpen and 1080p->1440p upsample\n"
+           "  --no-counters                     Skip the perf_event_open hardware counters\n"
+           "  --no-roofline                     Skip the host bandwidth/peak measurement and roofline report\n"
+           "  --no-classify                     Run the full filter on every 8x8 block, also flat and saturated ones, and\n"
+           "                                    report the pixels that differ with classification on\n"
+           "  --thread-scaling                  Run the strong, weak and batch thread scaling suite instead, on the\n"
+           "                                    first --tier (default best) and --variant (default 0)\n"
+           "  --max-threads <n>                 Largest thread count for --thread-scaling (default all hardware threads)\n"
+           "  --batch <n>                       Images per batch for --thread-scaling (default 256)\n"
+           "  --batch-size <n>                  Width and height of the batch images (default 256)\n"
+           "  --json <file>                     Also write the results as JSON\n");
+}
+
+static bool ParseOptions(int argc, char** argv, BenchOptions& options)
+{
+    bool allTiers = true;
+    bool allVariants = true;
+    for (int i = 1; i < argc; ++i)
+    {
+        const char* pArg = argv[i];
+        const char* pValue = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        if (strcmp(pArg, "--quick") == 0)
+        {
+            options.Quick = true;
+            continue;
+        }
+        if (strcmp(pArg, "--thread-scaling") == 0)
+        {
+            options.ThreadScaling = true;
+            continue;
+        }
+        if (strcmp(pArg, "--no-roofline") == 0)
+        {
+            options.Roofline = false;
+            continue;
+        }
+        if (strcmp(pArg, "--no-classify") == 0)
+        {
+            options.Classify = false;
+            continue;
+        }
+        if (strcmp(pArg, "--no-counters") == 0)
+        {
+            options.Counters = false;
+            continue;
+        }
+        if (!pValue)
+        {
+            return false;
+        }
+        ++i;
+        if (strcmp(pArg, "--tier") == 0)
+        {
+            if (strcmp(pValue, "all") != 0)
+            {
+                allTiers = false;
+                for (int tier = 0; tier < CAS_Tier_Count; ++tier)
+                {
+                    std::string name = CAS_Filter::GetTierName(static_cast<CAS_Tier>(tier));
+                    std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+                    if (name == pValue)
+                    {
+                        options.Tiers.push_back(static_cast<CAS_Tier>(tier));
+                    }
+                }
+            }
+        }
+        else if (strcmp(pArg, "--variant") == 0)
+        {
+            if (strcmp(pValue, "all") != 0)
+            {
+                allVariants = false;
+                options.Variants.push_back(static_cast<uint32_t>(atoi(pValue)) % CAS_Variant_Count);
+            }
+        }
+        else if (strcmp(pArg, "--mode") == 0)
+        {
+            options.SharpenOnly = strcmp(pValue, "upsample") != 0;
+            options.Upsample = strcmp(pValue, "sharpen") != 0;
+        }
+        else if (strcmp(pArg, "--format") == 0)
+        {
+            options.Format = strcmp(pValue, "rgba32f") == 0 ? CAS_Format_RGBA32F : strcmp(pValue, "rgba8") == 0 ? CAS_Format_RGBA8 :
+                             strcmp(pValue, "r32f") == 0 ? CAS_Format_R32F : strcmp(pValue, "r8") == 0 ? CAS_Format_R8 : CAS_Format_RGBA16F;
+        }
+        else if (strcmp(pArg, "--threads") == 0)
+        {
+            options.Threads = static_cast<uint32_t>(atoi(pValue));
+        }
+        else if (strcmp(pArg, "--warmup") == 0)
+        {
+            options.Warmup = static_cast<uint32_t>(atoi(pValue));
+        }
+        else if (strcmp(pArg, "--repeat") == 0)
+        {
+            options.Repeat = std::max(1, atoi(pValue));
+        }
+        else if (strcmp(pArg, "--sharpness") == 0)
+        {
+            options.Sharpness = static_cast<float>(atof(pValue));
+        }
+        else if (strcmp(pArg, "--max-threads") == 0)
+        {
+            options.MaxThreads = static_cast<uint32_t>(atoi(pValue));
+        }
+        else if (strcmp(pArg, "--batch") == 0)
+        {
+            options.BatchImages = std::max(1, atoi(pValue));
+        }
+        else if (strcmp(pArg, "--batch-size") == 0)
+        {
+            options.BatchImageSize = std::max(8, atoi(pValue));
+        }
+        else if (strcmp(pArg, "--json") == 0)
+        {
+            options.pJsonPath = pValue;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    options.TierSpecified = !allTiers;
+    if (allTiers)
+    {
+        for (int tier = 0; tier < CAS_Tier_Count; ++tier)
+        {
+            options.Tiers.push_back(static_cast<CAS_Tier>(tier));
+        }
+    }
+    if (allVariants)
+    {
+        for (uint32_t variant = 0; variant < CAS_Variant_Count; ++variant)
+        {
+            options.Variants.push_back(variant);
+        }
+    }
+    if (options.Threads == 0)
+    {
+        options.Threads = CAS_ThreadPool::GetHardwareThreadCount();
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    BenchOptions options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    if (options.ThreadScaling)
+    {
+        return RunThreadScalingBench(options);
+    }
+
+    std::vector<ResolutionInfo> resolutions;
+    CAS_Filter::GetCommonResolutions(resolutions);
+
+    if (options.Counters)
+    {
+        CAS_PerfCounters probe;
+        if (!probe.Open())
+        {
+            printf("Hardware counters unavailable, timing only: %s\n", probe.GetError().c_str());
+            options.Counters = false;
+        }
+    }
+
+    printf("%-7s %-44s %-12s %-18s %12s %12s %12s %10s %9s", "Tier", "Variant", "Mode", "Case", "median(us)", "p10(us)", "p90(us)", "ns/pixel", "GB/s");
+    if (options.Counters)
+    {
+        printf(" %6s %9s %9s %9s", "IPC", "L1D/px", "LLC/px", "DTLB/px");
+    }
+    if (!options.Classify)
+    {
+        printf(" %12s %12s", "classify px", "classify max");
+    }
+    printf("\n");
+
+    std::vector<BenchResult> results;
+    for (CAS_Tier tier : options.Tiers)
+    {
+        if (!CAS_Filter::IsTierSupported(tier))
+        {
+            printf("%-7s not supported on this CPU, skipped\n", CAS_Filter::GetTierName(tier));
+            continue;
+        }
+
+        for (uint32_t variant : options.Variants)
+        {
+            std::vector<BenchResult> caseResults;
+            if (options.SharpenOnly)
+            {
+                for (const ResolutionInfo& res : resolutions)
+                {
+                    if (options.Quick && res.Height != 1080)
+                    {
+                        continue;
+                    }
+                    caseResults.push_back(RunCase(options, tier, variant, true, res.pName, res.Width, res.Height, res.Width, res.Height));
+                }
+            }
+            if (options.Upsample)
+            {
+                for (const ScalingCase& scaling : s_ScalingCases)
+                {
+                    if (options.Quick && strcmp(scaling.pName, "1920x1080->1440p") != 0)
+                    {
+                        continue;
+                    }
+                    caseResults.push_back(RunCase(options, tier, variant, false, scaling.pName,
+                                                  scaling.InputWidth, scaling.InputHeight, scaling.OutputWidth, scaling.OutputHeight));
+                }
+            }
+
+            for (const BenchResult& r : caseResults)
+            {
+                printf("%-7s %-44s %-12s %-18s %12.1f %12.1f %12.1f %10.3f %9.2f", r.Tier.c_str(), r.Variant.c_str(), r.Mode.c_str(), r.Case.c_str(),
+                       r.MedianNs * 1e-3, r.P10Ns * 1e-3, r.P90Ns * 1e-3, r.NsPerPixel, r.GBPerSecond);
+                if (options.Counters)
+                {
+                    const CAS_CounterValues& c = r.Counters;
+                    const double pixels = static_cast<double>(r.OutputWidth) * r.OutputHeight;
+                    PrintCounter(c.Valid[CAS_Counter_Cycles] && c.Valid[CAS_Counter_Instructions] && c.Value[CAS_Counter_Cycles] != 0,
+                                 static_cast<double>(c.Value[CAS_Counter_Instructions]) / static_cast<double>(c.Value[CAS_Counter_Cycles]), 6, 2);
+                    PrintCounter(c.Valid[CAS_Counter_L1DMisses], c.Value[CAS_Counter_L1DMisses] / pixels, 9, 4);
+                    PrintCounter(c.Valid[CAS_Counter_LLCMisses], c.Value[CAS_Counter_LLCMisses] / pixels, 9, 4);
+                    PrintCounter(c.Valid[CAS_Counter_DTLBMisses], c.Value[CAS_Counter_DTLBMisses] / pixels, 9, 4);
+                }
+                if (!options.Classify)
+                {
+                    printf(" %12llu %12.3g", static_cast<unsigned long long>(r.ClassifyDiffs), r.ClassifyMaxDiff);
+                }
+                printf("\n");
+                results.push_back(r);
+            }
+            fflush(stdout);
+        }
+    }
+
+    HostRoofline host;
+    if (options.Roofline && !results.empty())
+    {
+        host.Bandwidth = CAS_Roofline::MeasureBandwidth(options.Threads);
+        for (CAS_Tier tier : options.Tiers)
+        {
+            host.PeakFlops[tier] = CAS_Roofline::MeasurePeakFlops(tier, options.Threads);
+        }
+        PrintRoofline(host, results);
+    }
+
+    if (options.pJsonPath)
+    {
+        FILE* pFile = fopen(options.pJsonPath, "w");
+        if (!pFile)
+        {
+            fprintf(stderr, "Could not open %s for writing\n", options.pJsonPath);
+            return 1;
+        }
+        WriteJson(options, host, results, pFile);
+        fclose(pFile);
+    }
+    return 0;
+}
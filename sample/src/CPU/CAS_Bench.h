@@ -0,0 +1,66 @@
+//CAS Sample
+//
+// Copyright(c) 2019 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "CAS_CPU.h"
+
+namespace CAS_SAMPLE_CPU
+{
+    struct BenchOptions
+    {
+        std::vector<CAS_Tier>   Tiers;
+        std::vector<uint32_t>   Variants;
+        bool                    SharpenOnly = true;
+        bool                    Upsample = true;
+        uint32_t                Warmup = 3;
+        uint32_t                Repeat = 15;
+        uint32_t                Threads = 1;
+        CAS_Format              Format = CAS_Format_RGBA16F;
+        float                   Sharpness = 0.0f;
+        bool                    Quick = false;
+        bool                    Counters = true;
+        bool                    Roofline = true;
+        bool                    Classify = true;        // CAS_Filter::SetClassification().
+        bool                    ThreadScaling = false;
+        bool                    TierSpecified = false;
+        uint32_t                MaxThreads = 0;         // 0 = all hardware threads.
+        uint32_t                BatchImages = 256;
+        uint32_t                BatchImageSize = 256;
+        const char             *pJsonPath = nullptr;
+    };
+
+    // Writes RGB clamped to {0 to 1} and alpha 1 into one texel of the format.
+    void StorePixel(CAS_Format format, uint8_t* pPixel, const float rgb[3]);
+
+    // Fills an image with a deterministic mix of gradients, hard edges and noise in {0 to 1}.
+    void FillTestImage(std::vector<uint8_t>& storage, CAS_Image& image, uint32_t width, uint32_t height, CAS_Format format);
+
+    // Copies an image into newly allocated storage of another format, RGB clamped to {0 to 1}.
+    void ConvertImage(const CAS_Image& source, std::vector<uint8_t>& storage, CAS_Image& image, CAS_Format format);
+
+    // Linearly interpolated percentile p in [0, 1] of an ascending sorted list.
+    double Percentile(const std::vector<double>& sorted, double p);
+
+    // Strong, weak and many-small-images scaling of the tiled executor, see CAS_BenchThreads.cpp.
+    int RunThreadScalingBench(const BenchOptions& options);
+}
@@ -0,0 +1,123 @@
+//CAS Sample
+//
+// Copyright(c) 2019 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <algorithm>
+#include <cstring>
+
+#include "CAS_Bench.h"
+
+namespace CAS_SAMPLE_CPU
+{
+    void StorePixel(CAS_Format format, uint8_t* pPixel, const float rgb[3])
+    {
+        if (format == CAS_Format_R10G10B10A2)
+        {
+            uint32_t packed = 3u << 30;
+            for (int c = 0; c < 3; ++c)
+            {
+                packed |= static_cast<uint32_t>(std::min(std::max(rgb[c], 0.0f), 1.0f) * 1023.0f + 0.5f) << (c * 10);
+            }
+            memcpy(pPixel, &packed, 4);
+            return;
+        }
+        // One and two channel formats keep red, or red and green.
+        const int channels = static_cast<int>(CAS_Filter::GetFormatChannels(format));
+        const bool wide = (format == CAS_Format_RGBA32F || format == CAS_Format_R32F || format == CAS_Format_RG32F);
+        for (int c = 0; c < channels; ++c)
+        {
+            float v = c < 3 ? std::min(std::max(rgb[c], 0.0f), 1.0f) : 1.0f;
+            if (wide)
+            {
+                memcpy(pPixel + c * 4, &v, 4);
+            }
+            else if (format == CAS_Format_RGBA16F)
+            {
+                // Values are in {0 to 1}, so a simple normal-range conversion is enough here.
+                uint32_t bits;
+                memcpy(&bits, &v, 4);
+                uint16_t half = v < 6.103515625e-5f ? 0 : static_cast<uint16_t>(((bits >> 13) & 0x3ffu) | ((((bits >> 23) & 0xffu) - 112u) << 10));
+                memcpy(pPixel + c * 2, &half, 2);
+            }
+            else
+            {
+                pPixel[c] = static_cast<uint8_t>(v * 255.0f + 0.5f);
+            }
+        }
+    }
+
+    static void AllocateImage(std::vector<uint8_t>& storage, CAS_Image& image, uint32_t width, uint32_t height, CAS_Format format)
+    {
+        image.Width = width;
+        image.Height = height;
+        image.RowPitch = width * CAS_Filter::GetFormatSize(format);
+        image.Format = format;
+        storage.assign(static_cast<size_t>(image.RowPitch) * height, 0);
+        image.pData = storage.data();
+    }
+
+    void FillTestImage(std::vector<uint8_t>& storage, CAS_Image& image, uint32_t width, uint32_t height, CAS_Format format)
+    {
+        const uint32_t pixelSize = CAS_Filter::GetFormatSize(format);
+        AllocateImage(storage, image, width, height, format);
+
+        uint32_t seed = 0x12345678u;
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                seed = seed * 1664525u + 1013904223u;
+                float noise = static_cast<float>(seed >> 8) * (1.0f / 16777216.0f);
+                float gradient = static_cast<float>(x) / static_cast<float>(width);
+                float edge = (((x >> 5) ^ (y >> 5)) & 1) ? 0.8f : 0.2f;
+                float rgb[3] =
+                {
+                    0.5f * gradient + 0.4f * edge + 0.1f * noise,
+                    0.3f * gradient + 0.5f * edge + 0.2f * noise,
+                    0.6f * (1.0f - gradient) + 0.3f * edge + 0.1f * noise,
+                };
+
+                StorePixel(format, storage.data() + static_cast<size_t>(y) * image.RowPitch + x * pixelSize, rgb);
+            }
+        }
+    }
+
+    void ConvertImage(const CAS_Image& source, std::vector<uint8_t>& storage, CAS_Image& image, CAS_Format format)
+    {
+        const uint32_t pixelSize = CAS_Filter::GetFormatSize(format);
+        AllocateImage(storage, image, source.Width, source.Height, format);
+        for (uint32_t y = 0; y < source.Height; ++y)
+        {
+            for (uint32_t x = 0; x < source.Width; ++x)
+            {
+                float rgb[3];
+                CAS_Filter::LoadPixel(source, x, y, rgb[0], rgb[1], rgb[2]);
+                StorePixel(format, storage.data() + static_cast<size_t>(y) * image.RowPitch + x * pixelSize, rgb);
+            }
+        }
+    }
+
+    double Percentile(const std::vector<double>& sorted, double p)
+    {
+        double rank = p * static_cast<double>(sorted.size() - 1);
+        size_t lo = static_cast<size_t>(rank);
+        size_t hi = std::min(lo + 1, sorted.size() - 1);
+        double t = rank - static_cast<double>(lo);
+        return sorted[lo] * (1.0 - t) + sorted[hi] * t;
+    }
+}
@@ -0,0 +1,293 @@
+//CAS Sample
+//
+// Copyright(c) 2019 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Thread scaling of the tiled CPU executor, run with CAS_Bench --thread-scaling.
+//  - Strong scaling: a fixed frame filtered with 1..N threads, efficiency = T(1) / (n * T(n)).
+//  - Weak scaling: the frame grows with the thread count (a fixed number of rows per thread), efficiency = T(1) / T(n).
+//  - Batch: many small images. "image" runs one single threaded filter per thread and spreads whole images over them,
+//    "tile" runs one filter with n threads over each image in turn, which is what a frame sized workload does.
+// Efficiency is relative to the 1 thread run of the same benchmark; the first thread count below s_FalloffEfficiency is
+// reported as the fall off point.
+
+#include "CAS_Bench.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace CAS_SAMPLE_CPU
+{
+    static const double s_FalloffEfficiency = 0.8;
+
+    // Rows of output per thread for weak scaling, at the 1080p width.
+    static const uint32_t s_WeakRowsPerThread = 128;
+
+    struct ThreadScalingResult
+    {
+        std::string     Benchmark;
+        std::string     Mode;
+        uint32_t        Threads;
+        uint32_t        Width;          // Output size of one image.
+        uint32_t        Height;
+        uint32_t        Images;
+        double          MedianNs;
+        double          MPixelsPerSecond;
+        double          Efficiency;
+    };
+
+    static double MeasureMedianNs(const BenchOptions& options, const std::function<void()>& run)
+    {
+        for (uint32_t i = 0; i < options.Warmup; ++i)
+        {
+            run();
+        }
+
+        std::vector<double> samples;
+        for (uint32_t i = 0; i < options.Repeat; ++i)
+        {
+            auto start = std::chrono::steady_clock::now();
+            run();
+            auto end = std::chrono::steady_clock::now();
+            samples.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+        }
+        std::sort(samples.begin(), samples.end());
+        return Percentile(samples, 0.5);
+    }
+
+    // Output size to input size for the mode, up-sampling uses a 1.5x ratio per axis like 720p to 1080p.
+    static void GetInputSize(bool sharpenOnly, uint32_t width, uint32_t height, uint32_t& inputWidth, uint32_t& inputHeight)
+    {
+        inputWidth = sharpenOnly ? width : (width * 2 + 2) / 3;
+        inputHeight = sharpenOnly ? height : (height * 2 + 2) / 3;
+    }
+
+    static double RunFrame(const BenchOptions& options, CAS_Tier tier, uint32_t variant, bool sharpenOnly, uint32_t threads, uint32_t width, uint32_t height)
+    {
+        uint32_t inputWidth, inputHeight;
+        GetInputSize(sharpenOnly, width, height, inputWidth, inputHeight);
+
+        std::vector<uint8_t> inputStorage, outputStorage;
+        CAS_Image input = {}, output = {};
+        FillTestImage(inputStorage, input, inputWidth, inputHeight, options.Format);
+        FillTestImage(outputStorage, output, width, height, options.Format);
+
+        const CAS_State casState = sharpenOnly ? CAS_State_SharpenOnly : CAS_State_Upsample;
+        CAS_Filter filter;
+        filter.OnCreate(threads, tier);
+        filter.SetVariant(variant);
+        filter.SetClassification(options.Classify);
+        filter.OnCreateWindowSizeDependentResources(inputWidth, inputHeight, width, height, casState);
+        filter.UpdateSharpness(options.Sharpness, casState);
+
+        double ns = MeasureMedianNs(options, [&] { filter.Upscale(input, output, casState); });
+
+        filter.OnDestroyWindowSizeDependentResources();
+        filter.OnDestroy();
+        return ns;
+    }
+
+    static double RunBatch(const BenchOptions& options, CAS_Tier tier, uint32_t variant, bool sharpenOnly, uint32_t threads, bool imageParallel)
+    {
+        const uint32_t size = options.BatchImageSize;
+        uint32_t inputWidth, inputHeight;
+        GetInputSize(sharpenOnly, size, size, inputWidth, inputHeight);
+
+        std::vector<std::vector<uint8_t>> inputStorage(options.BatchImages), outputStorage(options.BatchImages);
+        std::vector<CAS_Image> inputs(options.BatchImages), outputs(options.BatchImages);
+        for (uint32_t i = 0; i < options.BatchImages; ++i)
+        {
+            FillTestImage(inputStorage[i], inputs[i], inputWidth, inputHeight, options.Format);
+            FillTestImage(outputStorage[i], outputs[i], size, size, options.Format);
+        }
+
+        // Image parallel: one single threaded filter per pool thread. Tile parallel: one filter owning all the threads.
+        const CAS_State casState = sharpenOnly ? CAS_State_SharpenOnly : CAS_State_Upsample;
+        const uint32_t filterCount = imageParallel ? threads : 1;
+        std::vector<CAS_Filter> filters(filterCount);
+        for (CAS_Filter& filter : filters)
+        {
+            filter.OnCreate(imageParallel ? 1 : threads, tier);
+            filter.SetVariant(variant);
+            filter.SetClassification(options.Classify);
+            filter.OnCreateWindowSizeDependentResources(inputWidth, inputHeight, size, size, casState);
+            filter.UpdateSharpness(options.Sharpness, casState);
+        }
+
+        CAS_ThreadPool pool;
+        pool.OnCreate(imageParallel ? threads : 1);
+
+        double ns = MeasureMedianNs(options, [&]
+        {
+            if (imageParallel)
+            {
+                pool.Run(options.BatchImages, [&](uint32_t image, uint32_t threadIndex)
+                {
+                    filters[threadIndex].Upscale(inputs[image], outputs[image], casState);
+                });
+            }
+            else
+            {
+                for (uint32_t image = 0; image < options.BatchImages; ++image)
+                {
+                    filters[0].Upscale(inputs[image], outputs[image], casState);
+                }
+            }
+        });
+
+        pool.OnDestroy();
+        for (CAS_Filter& filter : filters)
+        {
+            filter.OnDestroyWindowSizeDependentResources();
+            filter.OnDestroy();
+        }
+        return ns;
+    }
+
+    static void GetThreadCounts(uint32_t maxThreads, std::vector<uint32_t>& counts)
+    {
+        for (uint32_t n = 1; n < maxThreads; n *= 2)
+        {
+            counts.push_back(n);
+        }
+        counts.push_back(maxThreads);
+    }
+
+    static void WriteThreadScalingJson(const BenchOptions& options, CAS_Tier tier, uint32_t variant, const std::vector<ThreadScalingResult>& results, FILE* pFile)
+    {
+        fprintf(pFile, "{\n");
+        fprintf(pFile, "  \"timestamp\": %lld,\n", static_cast<long long>(time(nullptr)));
+        fprintf(pFile, "  \"tier\": \"%s\",\n", CAS_Filter::GetTierName(tier));
+        fprintf(pFile, "  \"variant\": \"%s\",\n", CAS_Filter::GetVariantName(variant).c_str());
+        fprintf(pFile, "  \"hardware_threads\": %u,\n", CAS_ThreadPool::GetHardwareThreadCount());
+        fprintf(pFile, "  \"warmup\": %u,\n", options.Warmup);
+        fprintf(pFile, "  \"repeat\": %u,\n", options.Repeat);
+        fprintf(pFile, "  \"thread_scaling\": [\n");
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const ThreadScalingResult& r = results[i];
+            fprintf(pFile, "    { \"benchmark\": \"%s\", \"mode\": \"%s\", \"threads\": %u, \"output\": [%u, %u], \"images\": %u, "
+                           "\"median_ns\": %.0f, \"mpixels_per_s\": %.2f, \"efficiency\": %.3f }%s\n",
+                    r.Benchmark.c_str(), r.Mode.c_str(), r.Threads, r.Width, r.Height, r.Images,
+                    r.MedianNs, r.MPixelsPerSecond, r.Efficiency, (i + 1 < results.size()) ? "," : "");
+        }
+        fprintf(pFile, "  ]\n");
+        fprintf(pFile, "}\n");
+    }
+
+    int RunThreadScalingBench(const BenchOptions& options)
+    {
+        const CAS_Tier tier = options.TierSpecified && !options.Tiers.empty() ? options.Tiers[0] : CAS_Filter::GetBestTier();
+        const uint32_t variant = options.Variants.empty() ? 0 : options.Variants[0];
+        const uint32_t maxThreads = options.MaxThreads ? options.MaxThreads : CAS_ThreadPool::GetHardwareThreadCount();
+
+        std::vector<uint32_t> threadCounts;
+        GetThreadCounts(maxThreads, threadCounts);
+
+        printf("Thread scaling: %s %s, %u hardware threads\n", CAS_Filter::GetTierName(tier), CAS_Filter::GetVariantName(variant).c_str(),
+               CAS_ThreadPool::GetHardwareThreadCount());
+        printf("%-12s %-12s %8s %-12s %7s %12s %12s %10s\n", "Benchmark", "Mode", "Threads", "Output", "Images", "median(us)", "MPixel/s", "Efficiency");
+
+        std::vector<ThreadScalingResult> results;
+        for (int mode = 0; mode < 2; ++mode)
+        {
+            const bool sharpenOnly = (mode == 0);
+            if ((sharpenOnly && !options.SharpenOnly) || (!sharpenOnly && !options.Upsample))
+            {
+                continue;
+            }
+
+            for (int benchmark = 0; benchmark < 4; ++benchmark)
+            {
+                static const char* s_names[] = { "strong", "weak", "batch-image", "batch-tile" };
+                double baseNs = 0.0;
+                uint32_t falloff = 0;
+                for (uint32_t threads : threadCounts)
+                {
+                    ThreadScalingResult r;
+                    r.Benchmark = s_names[benchmark];
+                    r.Mode = sharpenOnly ? "SharpenOnly" : "Upsample";
+                    r.Threads = threads;
+                    r.Images = 1;
+                    switch (benchmark)
+                    {
+                    case 0:
+                        r.Width = 2560;
+                        r.Height = 1440;
+                        r.MedianNs = RunFrame(options, tier, variant, sharpenOnly, threads, r.Width, r.Height);
+                        break;
+                    case 1:
+                        r.Width = 1920;
+                        r.Height = s_WeakRowsPerThread * threads;
+                        r.MedianNs = RunFrame(options, tier, variant, sharpenOnly, threads, r.Width, r.Height);
+                        break;
+                    default:
+                        r.Width = options.BatchImageSize;
+                        r.Height = options.BatchImageSize;
+                        r.Images = options.BatchImages;
+                        r.MedianNs = RunBatch(options, tier, variant, sharpenOnly, threads, benchmark == 2);
+                        break;
+                    }
+
+                    // Strong scaling and batches keep the work fixed, weak scaling grows it with the threads.
+                    if (threads == 1)
+                    {
+                        baseNs = r.MedianNs;
+                    }
+                    const double idealNs = (benchmark == 1) ? baseNs : baseNs / threads;
+                    r.Efficiency = baseNs > 0.0 ? idealNs / r.MedianNs : 0.0;
+                    r.MPixelsPerSecond = static_cast<double>(r.Width) * r.Height * r.Images / r.MedianNs * 1e3;
+                    if (falloff == 0 && r.Efficiency < s_FalloffEfficiency)
+                    {
+                        falloff = threads;
+                    }
+
+                    char size[32];
+                    snprintf(size, sizeof(size), "%ux%u", r.Width, r.Height);
+                    printf("%-12s %-12s %8u %-12s %7u %12.1f %12.1f %9.1f%%\n", r.Benchmark.c_str(), r.Mode.c_str(), r.Threads, size, r.Images,
+                           r.MedianNs * 1e-3, r.MPixelsPerSecond, r.Efficiency * 100.0);
+                    fflush(stdout);
+                    results.push_back(r);
+                }
+
+                if (falloff)
+                {
+                    printf("%-12s %-12s efficiency drops below %.0f%% at %u threads\n", s_names[benchmark], sharpenOnly ? "SharpenOnly" : "Upsample",
+                           s_FalloffEfficiency * 100.0, falloff);
+                }
+            }
+        }
+
+        if (options.pJsonPath)
+        {
+            FILE* pFile = fopen(options.pJsonPath, "w");
+            if (!pFile)
+            {
+                fprintf(stderr, "Could not open %s for writing\n", options.pJsonPath);
+                return 1;
+            }
+            WriteThreadScalingJson(options, tier, variant, results, pFile);
+            fclose(pFile);
+        }
+        return 0;
+    }
+}
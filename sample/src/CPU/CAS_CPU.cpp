@@ -0,0 +1,2312 @@
+//CAS Sample
+//
+// Copyright(c) 2019 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "CAS_CPU.h"
+#include "CAS_ColorChain.h"
+#include "CAS_Kernels.h"
+#include "CAS_Profile.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <cpuid.h>
+#endif
+
+// CAS
+#define A_CPU
+#if defined(__GNUC__)
+#define A_GCC
+#endif
+#include "ffx_a.h"
+#include "ffx_cas.h"
+
+namespace CAS_SAMPLE_CPU
+{
+    // Tiles per side of the groups a fused cascade runs on.
+    static const uint32_t s_cascadeGroup = 4;
+
+    static inline float CasAsFloat(uint32_t u)
+    {
+        float f;
+        memcpy(&f, &u, sizeof(f));
+        return f;
+    }
+
+    static inline uint32_t CasAlign8(uint32_t x)
+    {
+        return (x + 7u) & ~7u;
+    }
+
+    static float CasHalfToFloat(uint16_t h)
+    {
+        uint32_t sign = static_cast<uint32_t>(h & 0x8000u) << 16;
+        uint32_t exponent = (h >> 10) & 0x1fu;
+        uint32_t mantissa = h & 0x3ffu;
+        if (exponent == 0)
+        {
+            // Zero or denormal.
+            float f = static_cast<float>(mantissa) * (1.0f / 16777216.0f);
+            return sign ? -f : f;
+        }
+        if (exponent == 31)
+        {
+            return CasAsFloat(sign | 0x7f800000u | (mantissa << 13));
+        }
+        return CasAsFloat(sign | ((exponent + 112u) << 23) | (mantissa << 13));
+    }
+
+    //==============================================================================================================
+    // Format conversion
+    //==============================================================================================================
+    static inline void CasDecodePixel(CAS_Format format, const uint8_t* pRow, int32_t x, float& r, float& g, float& b)
+    {
+        switch (format)
+        {
+        case CAS_Format_RGBA32F:
+        {
+            const float* p = reinterpret_cast<const float*>(pRow) + x * 4;
+            r = p[0]; g = p[1]; b = p[2];
+            break;
+        }
+        case CAS_Format_RGBA16F:
+        {
+            const uint16_t* p = reinterpret_cast<const uint16_t*>(pRow) + x * 4;
+            r = CasHalfToFloat(p[0]); g = CasHalfToFloat(p[1]); b = CasHalfToFloat(p[2]);
+            break;
+        }
+        case CAS_Format_R10G10B10A2:
+        {
+            const uint32_t packed = reinterpret_cast<const uint32_t*>(pRow)[x];
+            r = (packed & 1023u) * (1.0f / 1023.0f); g = ((packed >> 10) & 1023u) * (1.0f / 1023.0f); b = ((packed >> 20) & 1023u) * (1.0f / 1023.0f);
+            break;
+        }
+        // One channel is gray, two have no blue.
+        case CAS_Format_R32F:
+        {
+            r = g = b = reinterpret_cast<const float*>(pRow)[x];
+            break;
+        }
+        case CAS_Format_RG32F:
+        {
+            const float* p = reinterpret_cast<const float*>(pRow) + x * 2;
+            r = p[0]; g = p[1]; b = 0.0f;
+            break;
+        }
+        case CAS_Format_R8:
+        {
+            r = g = b = pRow[x] * (1.0f / 255.0f);
+            break;
+        }
+        case CAS_Format_RG8:
+        {
+            const uint8_t* p = pRow + x * 2;
+            r = p[0] * (1.0f / 255.0f); g = p[1] * (1.0f / 255.0f); b = 0.0f;
+            break;
+        }
+        default:
+        {
+            const uint8_t* p = pRow + x * 4;
+            r = p[0] * (1.0f / 255.0f); g = p[1] * (1.0f / 255.0f); b = p[2] * (1.0f / 255.0f);
+            break;
+        }
+        }
+    }
+
+    // CasDecodePixel() of count texels from x on, the format switch hoisted out of the loop. Only the planes of the
+    // channels the format has are written.
+    static void CasDecodeSpan(CAS_Format format, const uint8_t* pRow, int32_t x, uint32_t count, float* pR, float* pG, float* pB)
+    {
+        switch (format)
+        {
+        case CAS_Format_RGBA32F:
+        {
+            const float* p = reinterpret_cast<const float*>(pRow) + x * 4;
+            for (uint32_t i = 0; i < count; ++i, p += 4)
+            {
+                pR[i] = p[0]; pG[i] = p[1]; pB[i] = p[2];
+            }
+            break;
+        }
+        case CAS_Format_RGBA16F:
+        {
+            const uint16_t* p = reinterpret_cast<const uint16_t*>(pRow) + x * 4;
+            for (uint32_t i = 0; i < count; ++i, p += 4)
+            {
+                pR[i] = CasHalfToFloat(p[0]); pG[i] = CasHalfToFloat(p[1]); pB[i] = CasHalfToFloat(p[2]);
+            }
+            break;
+        }
+        case CAS_Format_R10G10B10A2:
+        {
+            const uint32_t* p = reinterpret_cast<const uint32_t*>(pRow) + x;
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                pR[i] = (p[i] & 1023u) * (1.0f / 1023.0f); pG[i] = ((p[i] >> 10) & 1023u) * (1.0f / 1023.0f); pB[i] = ((p[i] >> 20) & 1023u) * (1.0f / 1023.0f);
+            }
+            break;
+        }
+        case CAS_Format_R32F:
+        {
+            memcpy(pR, reinterpret_cast<const float*>(pRow) + x, count * sizeof(float));
+            break;
+        }
+        case CAS_Format_RG32F:
+        {
+            const float* p = reinterpret_cast<const float*>(pRow) + x * 2;
+            for (uint32_t i = 0; i < count; ++i, p += 2)
+            {
+                pR[i] = p[0]; pG[i] = p[1];
+            }
+            break;
+        }
+        case CAS_Format_R8:
+        {
+            const uint8_t* p = pRow + x;
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                pR[i] = p[i] * (1.0f / 255.0f);
+            }
+            break;
+        }
+        case CAS_Format_RG8:
+        {
+            const uint8_t* p = pRow + x * 2;
+            for (uint32_t i = 0; i < count; ++i, p += 2)
+            {
+                pR[i] = p[0] * (1.0f / 255.0f); pG[i] = p[1] * (1.0f / 255.0f);
+            }
+            break;
+        }
+        default:
+        {
+            const uint8_t* p = pRow + x * 4;
+            for (uint32_t i = 0; i < count; ++i, p += 4)
+            {
+                pR[i] = p[0] * (1.0f / 255.0f); pG[i] = p[1] * (1.0f / 255.0f); pB[i] = p[2] * (1.0f / 255.0f);
+            }
+            break;
+        }
+        }
+    }
+
+    // Alpha of count texels from x on, the channel CasDecodeSpan() leaves out.
+    static void CasDecodeAlphaSpan(CAS_Format format, const uint8_t* pRow, int32_t x, uint32_t count, float* pA)
+    {
+        switch (format)
+        {
+        case CAS_Format_RGBA32F:
+        {
+            const float* p = reinterpret_cast<const float*>(pRow) + x * 4;
+            for (uint32_t i = 0; i < count; ++i, p += 4)
+            {
+                pA[i] = p[3];
+            }
+            break;
+        }
+        case CAS_Format_RGBA16F:
+        {
+            const uint16_t* p = reinterpret_cast<const uint16_t*>(pRow) + x * 4;
+            for (uint32_t i = 0; i < count; ++i, p += 4)
+            {
+                pA[i] = CasHalfToFloat(p[3]);
+            }
+            break;
+        }
+        case CAS_Format_R10G10B10A2:
+        {
+            const uint32_t* p = reinterpret_cast<const uint32_t*>(pRow) + x;
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                pA[i] = (p[i] >> 30) * (1.0f / 3.0f);
+            }
+            break;
+        }
+        case CAS_Format_R32F:
+        case CAS_Format_RG32F:
+        case CAS_Format_R8:
+        case CAS_Format_RG8:
+        {
+            std::fill(pA, pA + count, 1.0f);
+            break;
+        }
+        default:
+        {
+            const uint8_t* p = pRow + x * 4;
+            for (uint32_t i = 0; i < count; ++i, p += 4)
+            {
+                pA[i] = p[3] * (1.0f / 255.0f);
+            }
+            break;
+        }
+        }
+    }
+
+    // Reduction of the input while it is decoded (CAS_Filter::SetReduction()): source texel (x, y) is the weighted sum of
+    // the Taps x Taps input texels from (x * Factor + Start, y * Factor + Start) on.
+    struct CasReduction
+    {
+        int32_t             Factor;
+        int32_t             Start;
+        uint32_t            Taps;
+        const float*        pWeights;
+        int32_t             LastX;      // Last column and row of the input frame.
+        int32_t             LastY;
+        std::vector<float>* pRow;       // Scratch for one decoded input row.
+    };
+
+    // Input image placed in the input frame, it holds the frame texels from (X, Y) on.
+    struct CasSource
+    {
+        const CAS_Image*    pImage;
+        int32_t             X;
+        int32_t             Y;
+        int32_t             LastX;      // Last column and row of the frame, reads clamp to them like the shader's sampler.
+        int32_t             LastY;
+        const CasReduction* pReduction; // Frame of reduced texels, X and Y are in input texels then. nullptr reads as is.
+        const CAS_ColorTransform* pTransform; // Applied to the decoded rows of a window, not by CasDecodeRow() itself.
+    };
+
+    static void CasDecodeReducedRow(const CasSource& source, int32_t y, int32_t x0, uint32_t count, float* pR, float* pG, float* pB, float* pA);
+
+    // Converts frame texels [x0, x0+count) of row y into planar floats, clamping reads to the frame edge and then to the
+    // image (the second clamp only matters when the image does not cover the footprint). Alpha goes to pA when it is not
+    // nullptr.
+    static void CasDecodeRow(const CasSource& source, int32_t y, int32_t x0, uint32_t count, float* pR, float* pG, float* pB, float* pA)
+    {
+        if (source.pReduction)
+        {
+            CasDecodeReducedRow(source, y, x0, count, pR, pG, pB, pA);
+            return;
+        }
+
+        const CAS_Image& image = *source.pImage;
+        y = std::min(std::max(y, std::max(source.Y, 0)), std::min(source.LastY, source.Y + static_cast<int32_t>(image.Height) - 1)) - source.Y;
+        const uint8_t* pRow = static_cast<const uint8_t*>(image.pData) + static_cast<size_t>(y) * image.RowPitch;
+        const int32_t lastX = std::min(source.LastX, source.X + static_cast<int32_t>(image.Width) - 1);
+        const int32_t firstX = std::min(std::max(source.X, 0), lastX);
+
+        // Texels left of the image repeat its first column, then the span inside it, then the last column.
+        uint32_t i = 0;
+        for (; i < count && x0 + static_cast<int32_t>(i) < firstX; ++i)
+        {
+            CasDecodePixel(image.Format, pRow, firstX - source.X, pR[i], pG[i], pB[i]);
+            if (pA)
+            {
+                CasDecodeAlphaSpan(image.Format, pRow, firstX - source.X, 1, pA + i);
+            }
+        }
+        const int32_t inside = std::min(x0 + static_cast<int32_t>(count), lastX + 1) - (x0 + static_cast<int32_t>(i));
+        if (inside > 0)
+        {
+            CasDecodeSpan(image.Format, pRow, x0 + static_cast<int32_t>(i) - source.X, static_cast<uint32_t>(inside), pR + i, pG + i, pB + i);
+            if (pA)
+            {
+                // Same row, still in L1.
+                CasDecodeAlphaSpan(image.Format, pRow, x0 + static_cast<int32_t>(i) - source.X, static_cast<uint32_t>(inside), pA + i);
+            }
+            i += static_cast<uint32_t>(inside);
+        }
+        for (; i < count; ++i)
+        {
+            CasDecodePixel(image.Format, pRow, lastX - source.X, pR[i], pG[i], pB[i]);
+            if (pA)
+            {
+                CasDecodeAlphaSpan(image.Format, pRow, lastX - source.X, 1, pA + i);
+            }
+        }
+    }
+
+    // The reduced texels clamp to the reduced frame like any source, their taps to the input frame. The tap rows of the
+    // span are decoded and summed vertically first, then the horizontal weights run once per texel.
+    static void CasDecodeReducedRow(const CasSource& source, int32_t y, int32_t x0, uint32_t count, float* pR, float* pG, float* pB, float* pA)
+    {
+        const CasReduction& reduction = *source.pReduction;
+        const int32_t firstX = std::min(std::max(x0, 0), source.LastX);
+        const int32_t lastX = std::min(std::max(x0 + static_cast<int32_t>(count) - 1, 0), source.LastX);
+        const int32_t tapX = firstX * reduction.Factor + reduction.Start;
+        const uint32_t tapCount = static_cast<uint32_t>((lastX - firstX) * reduction.Factor) + reduction.Taps;
+        const uint32_t channels = pA ? 4 : 3;
+        if (reduction.pRow->size() < tapCount * channels * 2)
+        {
+            reduction.pRow->resize(tapCount * channels * 2);
+        }
+        float* pTap = reduction.pRow->data();
+        float* pSum = pTap + tapCount * channels;
+
+        const CasSource input = { source.pImage, source.X, source.Y, reduction.LastX, reduction.LastY, nullptr, nullptr };
+        const int32_t tapY = std::min(std::max(y, 0), source.LastY) * reduction.Factor + reduction.Start;
+        std::fill(pSum, pSum + tapCount * channels, 0.0f);
+        for (uint32_t ty = 0; ty < reduction.Taps; ++ty)
+        {
+            CasDecodeRow(input, tapY + static_cast<int32_t>(ty), tapX, tapCount, pTap, pTap + tapCount, pTap + tapCount * 2, pA ? pTap + tapCount * 3 : nullptr);
+            const float weight = reduction.pWeights[ty];
+            for (uint32_t i = 0; i < tapCount * channels; ++i)
+            {
+                pSum[i] += weight * pTap[i];
+            }
+        }
+
+        const float* pSumR = pSum;
+        const float* pSumG = pSum + tapCount;
+        const float* pSumB = pSum + tapCount * 2;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const int32_t x = std::min(std::max(x0 + static_cast<int32_t>(i), 0), source.LastX);
+            const uint32_t first = static_cast<uint32_t>((x - firstX) * reduction.Factor);
+            float r = 0.0f, g = 0.0f, b = 0.0f;
+            for (uint32_t tx = 0; tx < reduction.Taps; ++tx)
+            {
+                const float weight = reduction.pWeights[tx];
+                r += weight * pSumR[first + tx];
+                g += weight * pSumG[first + tx];
+                b += weight * pSumB[first + tx];
+            }
+            pR[i] = r;
+            pG[i] = g;
+            pB[i] = b;
+        }
+        if (pA)
+        {
+            const float* pSumA = pSum + tapCount * 3;
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                const int32_t x = std::min(std::max(x0 + static_cast<int32_t>(i), 0), source.LastX);
+                const uint32_t first = static_cast<uint32_t>((x - firstX) * reduction.Factor);
+                float a = 0.0f;
+                for (uint32_t tx = 0; tx < reduction.Taps; ++tx)
+                {
+                    a += reduction.pWeights[tx] * pSumA[first + tx];
+                }
+                pA[i] = a;
+            }
+        }
+    }
+
+    static float CasSrgbFromLinear(float v)
+    {
+        v = v > 0.0f ? std::min(v, 1.0f) : 0.0f;
+        return v < 0.0031308f ? v * 12.92f : 1.055f * std::pow(v, 1.0f / 2.4f) - 0.055f;
+    }
+
+    // SMPTE ST 2084, exact constants rather than the rounded ones of AToPqF1(). x is in units of 10000 nits.
+    static const double s_pqM1 = 2610.0 / 16384.0;
+    static const double s_pqM2 = 2523.0 / 4096.0 * 128.0;
+    static const double s_pqC1 = 3424.0 / 4096.0;
+    static const double s_pqC2 = 2413.0 / 4096.0 * 32.0;
+    static const double s_pqC3 = 2392.0 / 4096.0 * 32.0;
+
+    static float CasPqFromLinear(float x)
+    {
+        x = x > 0.0f ? std::min(x, 1.0f) : 0.0f;
+        const float p = std::pow(x, static_cast<float>(s_pqM1));
+        return std::pow((static_cast<float>(s_pqC1) + static_cast<float>(s_pqC2) * p) / (1.0f + static_cast<float>(s_pqC3) * p), static_cast<float>(s_pqM2));
+    }
+
+    // Exact linear to 8-bit sRGB without pow: Thresholds[k] is the smallest linear value that rounds to code k, and
+    // Buckets holds the code at the start of 4096 even steps of the linear range. No step spans two code boundaries (the
+    // curve is at most 12.92 * 255 codes per unit), so a bucket's code and one compare give the rounded result.
+    struct CasSrgbTable
+    {
+        float       Thresholds[257];
+        uint8_t     Buckets[4096];
+
+        CasSrgbTable()
+        {
+            Thresholds[0] = -1.0f;
+            for (uint32_t code = 1; code < 256; ++code)
+            {
+                const double srgb = (code - 0.5) / 255.0;
+                const double linear = srgb <= 0.04045 ? srgb / 12.92 : std::pow((srgb + 0.055) / 1.055, 2.4);
+                // Rounded up, a float just below the exact threshold still rounds to the code below.
+                Thresholds[code] = static_cast<float>(linear);
+                if (static_cast<double>(Thresholds[code]) < linear)
+                {
+                    Thresholds[code] = std::nextafter(Thresholds[code], 2.0f);
+                }
+            }
+            Thresholds[256] = 2.0f;
+            uint32_t code = 0;
+            for (uint32_t bucket = 0; bucket < 4096; ++bucket)
+            {
+                const float start = static_cast<float>(bucket) / 4096.0f;
+                while (Thresholds[code + 1] <= start)
+                {
+                    ++code;
+                }
+                Buckets[bucket] = static_cast<uint8_t>(code);
+            }
+        }
+    };
+
+    static inline uint8_t CasSrgb8FromLinear(const CasSrgbTable& table, float v)
+    {
+        v = v > 0.0f ? std::min(v, 1.0f) : 0.0f;
+        const uint32_t code = table.Buckets[std::min(static_cast<uint32_t>(v * 4096.0f), 4095u)];
+        return static_cast<uint8_t>(code + (v >= table.Thresholds[code + 1] ? 1 : 0));
+    }
+
+    // Exact linear to 10-bit PQ in the same way. The curve climbs from code 0 to 1 by 1.2e-9, so the buckets are spaced
+    // on the float bits instead, 128 per octave from the first threshold up to 1, where no bucket spans two boundaries.
+    struct CasPqTable
+    {
+        float                   Thresholds[1025];
+        uint32_t                Base;               // Float bits >> 16 of the first bucket.
+        std::vector<uint16_t>   Buckets;
+
+        CasPqTable()
+        {
+            Thresholds[0] = -1.0f;
+            for (uint32_t code = 1; code < 1024; ++code)
+            {
+                const double p = std::pow((code - 0.5) / 1023.0, 1.0 / s_pqM2);
+                const double linear = std::pow(std::max(p - s_pqC1, 0.0) / (s_pqC2 - s_pqC3 * p), 1.0 / s_pqM1);
+                Thresholds[code] = static_cast<float>(linear);
+                if (static_cast<double>(Thresholds[code]) < linear)
+                {
+                    Thresholds[code] = std::nextafter(Thresholds[code], 2.0f);
+                }
+            }
+            Thresholds[1024] = 2.0f;
+
+            uint32_t bits;
+            memcpy(&bits, &Thresholds[1], sizeof(bits));
+            Base = bits >> 16;
+            Buckets.resize((0x3f800000u >> 16) - Base + 1);
+            uint32_t code = 0;
+            for (uint32_t bucket = 0; bucket < Buckets.size(); ++bucket)
+            {
+                const float start = CasAsFloat((Base + bucket) << 16);
+                while (Thresholds[code + 1] <= start)
+                {
+                    ++code;
+                }
+                Buckets[bucket] = static_cast<uint16_t>(code);
+            }
+        }
+    };
+
+    static inline uint32_t CasPq10FromLinear(const CasPqTable& table, float x)
+    {
+        x = x > 0.0f ? std::min(x, 1.0f) : 0.0f;
+        uint32_t bits;
+        memcpy(&bits, &x, sizeof(bits));
+        const uint32_t bucket = (bits >> 16) > table.Base ? (bits >> 16) - table.Base : 0;
+        const uint32_t code = table.Buckets[bucket];
+        return code + (x >= table.Thresholds[code + 1] ? 1 : 0);
+    }
+
+    // Saturates like a UNORM render target would, output transforms can leave [0, 1].
+    static inline uint8_t CasUnorm8(float v)
+    {
+        return static_cast<uint8_t>(AMinF1(AMaxF1(v, 0.0f), 1.0f) * 255.0f + 0.5f);
+    }
+
+    // Stores planar floats into row pixels from x0 on with encode applied to each channel, alpha set to 1 like the
+    // shader does. Formats with fewer channels only read their planes.
+    template <typename Encode>
+    static void CasStoreRow(CAS_Format format, uint8_t* pRow, uint32_t x0, uint32_t count, const float* pR, const float* pG, const float* pB, const Encode& encode)
+    {
+        switch (format)
+        {
+        case CAS_Format_RGBA32F:
+        {
+            float* p = reinterpret_cast<float*>(pRow) + x0 * 4;
+            for (uint32_t i = 0; i < count; ++i, p += 4)
+            {
+                p[0] = encode(pR[i]); p[1] = encode(pG[i]); p[2] = encode(pB[i]); p[3] = 1.0f;
+            }
+            break;
+        }
+        case CAS_Format_RGBA16F:
+        {
+            uint16_t* p = reinterpret_cast<uint16_t*>(pRow) + x0 * 4;
+            for (uint32_t i = 0; i < count; ++i, p += 4)
+            {
+                p[0] = static_cast<uint16_t>(AU1_AH1_AF1(encode(pR[i])));
+                p[1] = static_cast<uint16_t>(AU1_AH1_AF1(encode(pG[i])));
+                p[2] = static_cast<uint16_t>(AU1_AH1_AF1(encode(pB[i])));
+                p[3] = 0x3c00;
+            }
+            break;
+        }
+        case CAS_Format_R10G10B10A2:
+        {
+            uint32_t* p = reinterpret_cast<uint32_t*>(pRow) + x0;
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                const uint32_t r = static_cast<uint32_t>(AMinF1(AMaxF1(encode(pR[i]), 0.0f), 1.0f) * 1023.0f + 0.5f);
+                const uint32_t g = static_cast<uint32_t>(AMinF1(AMaxF1(encode(pG[i]), 0.0f), 1.0f) * 1023.0f + 0.5f);
+                const uint32_t b = static_cast<uint32_t>(AMinF1(AMaxF1(encode(pB[i]), 0.0f), 1.0f) * 1023.0f + 0.5f);
+                p[i] = r | (g << 10) | (b << 20) | (3u << 30);
+            }
+            break;
+        }
+        case CAS_Format_R32F:
+        {
+            float* p = reinterpret_cast<float*>(pRow) + x0;
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                p[i] = encode(pR[i]);
+            }
+            break;
+        }
+        case CAS_Format_RG32F:
+        {
+            float* p = reinterpret_cast<float*>(pRow) + x0 * 2;
+            for (uint32_t i = 0; i < count; ++i, p += 2)
+            {
+                p[0] = encode(pR[i]); p[1] = encode(pG[i]);
+            }
+            break;
+        }
+        case CAS_Format_R8:
+        {
+            uint8_t* p = pRow + x0;
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                p[i] = CasUnorm8(encode(pR[i]));
+            }
+            break;
+        }
+        case CAS_Format_RG8:
+        {
+            uint8_t* p = pRow + x0 * 2;
+            for (uint32_t i = 0; i < count; ++i, p += 2)
+            {
+                p[0] = CasUnorm8(encode(pR[i]));
+                p[1] = CasUnorm8(encode(pG[i]));
+            }
+            break;
+        }
+        default:
+        {
+            uint8_t* p = pRow + x0 * 4;
+            for (uint32_t i = 0; i < count; ++i, p += 4)
+            {
+                p[0] = CasUnorm8(encode(pR[i]));
+                p[1] = CasUnorm8(encode(pG[i]));
+                p[2] = CasUnorm8(encode(pB[i]));
+                p[3] = 255;
+            }
+            break;
+        }
+        }
+    }
+
+    //==============================================================================================================
+    // Dithered quantization
+    //==============================================================================================================
+    // A transfer curve sampled at the start of 128 buckets per octave of the float exponent, from 2^-30 up to 1, and
+    // interpolated linearly in between (the mantissa bits below the bucket are the position in it). Within 1e-5 of the
+    // curve over the whole range, close enough for dithered stores, which do not round to nearest.
+    struct CasCurveTable
+    {
+        static const uint32_t   s_base = (127u - 30u) << 7;     // Float bits >> 16 of 2^-30.
+        std::vector<float>      Values;
+
+        template <typename Curve>
+        explicit CasCurveTable(const Curve& curve)
+        {
+            Values.resize((0x3f800000u >> 16) - s_base + 2);
+            for (uint32_t bucket = 0; bucket < Values.size(); ++bucket)
+            {
+                Values[bucket] = static_cast<float>(curve(static_cast<double>(CasAsFloat((s_base + bucket) << 16))));
+            }
+        }
+
+        float Evaluate(float x) const
+        {
+            x = x > 0.0f ? std::min(x, 1.0f) : 0.0f;
+            uint32_t bits;
+            memcpy(&bits, &x, sizeof(bits));
+            if ((bits >> 16) < s_base)
+            {
+                return Values[0] * x * 1073741824.0f;
+            }
+            const uint32_t bucket = (bits >> 16) - s_base;
+            const float t = static_cast<float>(bits & 0xffffu) * (1.0f / 65536.0f);
+            return Values[bucket] + (Values[bucket + 1] - Values[bucket]) * t;
+        }
+    };
+
+    static double CasSrgbCurve(double x)
+    {
+        return x < 0.0031308 ? x * 12.92 : 1.055 * std::pow(x, 1.0 / 2.4) - 0.055;
+    }
+
+    static double CasPqCurve(double x)
+    {
+        const double p = std::pow(x, s_pqM1);
+        return std::pow((s_pqC1 + s_pqC2 * p) / (1.0 + s_pqC3 * p), s_pqM2);
+    }
+
+    static const uint8_t s_bayer8x8[64] =
+    {
+         0, 32,  8, 40,  2, 34, 10, 42,
+        48, 16, 56, 24, 50, 18, 58, 26,
+        12, 44,  4, 36, 14, 46,  6, 38,
+        60, 28, 52, 20, 62, 30, 54, 22,
+         3, 35, 11, 43,  1, 33,  9, 41,
+        51, 19, 59, 27, 49, 17, 57, 25,
+        15, 47,  7, 39, 13, 45,  5, 37,
+        63, 31, 55, 23, 61, 29, 53, 21,
+    };
+
+    // 64x64 blue noise thresholds made by the void and cluster method (Ulichney 1993) on a torus, so the tile repeats
+    // without seams: a sparse pattern of ones is relaxed until its tightest cluster is its largest void, then ones are
+    // ranked by removing the tightest cluster and zeros by filling the largest void. Built once, on first use.
+    struct CasBlueNoise
+    {
+        static const uint32_t   s_size = 64;
+        float                   Thresholds[s_size * s_size];
+
+        CasBlueNoise()
+        {
+            const uint32_t count = s_size * s_size;
+            const uint32_t mask = s_size - 1;
+            std::vector<float> kernel(count);
+            for (uint32_t y = 0; y < s_size; ++y)
+            {
+                for (uint32_t x = 0; x < s_size; ++x)
+                {
+                    const float dx = static_cast<float>(std::min(x, s_size - x));
+                    const float dy = static_cast<float>(std::min(y, s_size - y));
+                    kernel[y * s_size + x] = std::exp(-(dx * dx + dy * dy) / (2.0f * 1.5f * 1.5f));
+                }
+            }
+
+            std::vector<uint8_t> pattern(count, 0);
+            std::vector<float> energy(count, 0.0f);
+            auto update = [&](uint32_t index, float sign)
+            {
+                const uint32_t px = index & mask, py = index / s_size;
+                for (uint32_t y = 0; y < s_size; ++y)
+                {
+                    for (uint32_t x = 0; x < s_size; ++x)
+                    {
+                        energy[y * s_size + x] += sign * kernel[((y - py) & mask) * s_size + ((x - px) & mask)];
+                    }
+                }
+            };
+            // Tightest cluster: the one with the highest energy, largest void: the zero with the lowest.
+            auto find = [&](uint8_t value, bool highest)
+            {
+                uint32_t best = 0;
+                float bestEnergy = highest ? -1.0f : 1e30f;
+                for (uint32_t i = 0; i < count; ++i)
+                {
+                    if (pattern[i] == value && (highest ? energy[i] > bestEnergy : energy[i] < bestEnergy))
+                    {
+                        best = i;
+                        bestEnergy = energy[i];
+                    }
+                }
+                return best;
+            };
+
+            uint32_t seed = 0x2545f491u;
+            uint32_t ones = 0;
+            while (ones < count / 10)
+            {
+                seed = seed * 1664525u + 1013904223u;
+                const uint32_t index = (seed >> 8) % count;
+                if (!pattern[index])
+                {
+                    pattern[index] = 1;
+                    update(index, 1.0f);
+                    ++ones;
+                }
+            }
+            for (;;)
+            {
+                const uint32_t cluster = find(1, true);
+                pattern[cluster] = 0;
+                update(cluster, -1.0f);
+                const uint32_t hole = find(0, false);
+                pattern[hole] = 1;
+                update(hole, 1.0f);
+                if (hole == cluster)
+                {
+                    break;
+                }
+            }
+
+            std::vector<uint32_t> rank(count);
+            const std::vector<uint8_t> initial = pattern;
+            const std::vector<float> initialEnergy = energy;
+            for (uint32_t left = ones; left > 0; --left)
+            {
+                const uint32_t cluster = find(1, true);
+                pattern[cluster] = 0;
+                update(cluster, -1.0f);
+                rank[cluster] = left - 1;
+            }
+            pattern = initial;
+            energy = initialEnergy;
+            for (uint32_t filled = ones; filled < count; ++filled)
+            {
+                const uint32_t hole = find(0, false);
+                pattern[hole] = 1;
+                update(hole, 1.0f);
+                rank[hole] = filled;
+            }
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                Thresholds[i] = (static_cast<float>(rank[i]) + 0.5f) / static_cast<float>(count);
+            }
+        }
+    };
+
+    static inline uint32_t CasHash(uint32_t x)
+    {
+        x ^= x >> 16; x *= 0x7feb352du;
+        x ^= x >> 15; x *= 0x846ca68bu;
+        x ^= x >> 16;
+        return x;
+    }
+
+    // Quantizes to floor(encoded * maxCode + threshold + grain): the threshold is 0.5 without dither (round to nearest)
+    // or the pattern value at the pixel, the same for all channels so the noise stays neutral, and the grain is a
+    // triangular hash of the pixel and seed.
+    static void CasEncodeDitheredRow(const CAS_Target& target, uint8_t* pRow, uint32_t y, uint32_t x0, uint32_t count, const float* pR, const float* pG, const float* pB)
+    {
+        static const CasCurveTable s_srgbCurve(CasSrgbCurve);
+        static const CasCurveTable s_pqCurve(CasPqCurve);
+        const CasCurveTable* pCurve = target.Transfer == CAS_Transfer_sRGB ? &s_srgbCurve : target.Transfer == CAS_Transfer_PQ ? &s_pqCurve : nullptr;
+        const float scale = target.Transfer == CAS_Transfer_PQ ? (target.MaxNits > 0.0f ? target.MaxNits : 10000.0f) * (1.0f / 10000.0f) : 1.0f;
+        const bool tenBit = (target.Image.Format == CAS_Format_R10G10B10A2);
+        const float maxCode = tenBit ? 1023.0f : 255.0f;
+        const uint32_t maxValue = tenBit ? 1023u : 255u;
+        const uint32_t channels = std::min(CAS_Filter::GetFormatChannels(target.Image.Format), 3u);
+        const float grain = target.Grain * maxCode;
+
+        const uint32_t offset = CasHash(target.Seed);
+        const uint32_t patternX = offset & 63, patternY = (offset >> 8) & 63;
+        const float* pBlueNoise = nullptr;
+        if (target.Dither == CAS_Dither_BlueNoise)
+        {
+            static const CasBlueNoise s_blueNoise;
+            pBlueNoise = s_blueNoise.Thresholds + ((y + patternY) & 63) * 64;
+        }
+        const uint8_t* pBayer = s_bayer8x8 + ((y + patternY) & 7) * 8;
+        const uint32_t grainRow = CasHash(y ^ CasHash(target.Seed + 0x9e3779b9u));
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const uint32_t x = x0 + i;
+            float threshold = 0.5f;
+            if (pBlueNoise)
+            {
+                threshold = pBlueNoise[(x + patternX) & 63];
+            }
+            else if (target.Dither == CAS_Dither_Ordered)
+            {
+                threshold = (static_cast<float>(pBayer[(x + patternX) & 7]) + 0.5f) * (1.0f / 64.0f);
+            }
+            if (grain > 0.0f)
+            {
+                const uint32_t noise = CasHash(x ^ grainRow);
+                threshold += grain * (static_cast<float>(noise & 0xffffu) + static_cast<float>(noise >> 16) - 65535.0f) * (1.0f / 65536.0f);
+            }
+
+            uint32_t code[3];
+            const float value[3] = { pR[i], channels > 1 ? pG[i] : 0.0f, channels > 2 ? pB[i] : 0.0f };
+            for (uint32_t c = 0; c < channels; ++c)
+            {
+                const float encoded = pCurve ? pCurve->Evaluate(value[c] * scale) : AMinF1(AMaxF1(value[c], 0.0f), 1.0f);
+                // Clamped at 0 first, so the conversion truncates like floor().
+                code[c] = std::min(static_cast<uint32_t>(AMaxF1(encoded * maxCode + threshold, 0.0f)), maxValue);
+            }
+            if (tenBit)
+            {
+                reinterpret_cast<uint32_t*>(pRow)[x] = code[0] | (code[1] << 10) | (code[2] << 20) | (3u << 30);
+            }
+            else if (channels < 3)
+            {
+                for (uint32_t c = 0; c < channels; ++c)
+                {
+                    pRow[x * channels + c] = static_cast<uint8_t>(code[c]);
+                }
+            }
+            else
+            {
+                uint8_t* p = pRow + x * 4;
+                p[0] = static_cast<uint8_t>(code[0]); p[1] = static_cast<uint8_t>(code[1]); p[2] = static_cast<uint8_t>(code[2]); p[3] = 255;
+            }
+        }
+    }
+
+    // Writes planar floats into output row y starting at x0 with a transfer function. 8-bit sRGB and 10-bit PQ go
+    // through the exact tables, the other combinations evaluate the curve.
+    static void CasEncodeRow(const CAS_Target& target, uint32_t y, uint32_t x0, uint32_t count, const float* pR, const float* pG, const float* pB)
+    {
+        const CAS_Image& image = target.Image;
+        const CAS_Transfer transfer = target.Transfer;
+        const float maxNits = target.MaxNits;
+        uint8_t* pRow = static_cast<uint8_t*>(image.pData) + static_cast<size_t>(y) * image.RowPitch;
+        const bool eightBit = (image.Format == CAS_Format_RGBA8 || image.Format == CAS_Format_R8 || image.Format == CAS_Format_RG8);
+        if ((target.Dither != CAS_Dither_None || target.Grain > 0.0f) && (eightBit || image.Format == CAS_Format_R10G10B10A2))
+        {
+            CasEncodeDitheredRow(target, pRow, y, x0, count, pR, pG, pB);
+            return;
+        }
+        if (transfer == CAS_Transfer_sRGB && eightBit)
+        {
+            static const CasSrgbTable s_srgbTable;
+            if (image.Format == CAS_Format_R8)
+            {
+                for (uint32_t i = 0; i < count; ++i)
+                {
+                    pRow[x0 + i] = CasSrgb8FromLinear(s_srgbTable, pR[i]);
+                }
+                return;
+            }
+            if (image.Format == CAS_Format_RG8)
+            {
+                uint8_t* p = pRow + x0 * 2;
+                for (uint32_t i = 0; i < count; ++i, p += 2)
+                {
+                    p[0] = CasSrgb8FromLinear(s_srgbTable, pR[i]);
+                    p[1] = CasSrgb8FromLinear(s_srgbTable, pG[i]);
+                }
+                return;
+            }
+            uint8_t* p = pRow + x0 * 4;
+            for (uint32_t i = 0; i < count; ++i, p += 4)
+            {
+                p[0] = CasSrgb8FromLinear(s_srgbTable, pR[i]);
+                p[1] = CasSrgb8FromLinear(s_srgbTable, pG[i]);
+                p[2] = CasSrgb8FromLinear(s_srgbTable, pB[i]);
+                p[3] = 255;
+            }
+            return;
+        }
+
+        // Linear 1 is maxNits, PQ 1 is 10000 nits.
+        const float nitsScale = (maxNits > 0.0f ? maxNits : 10000.0f) * (1.0f / 10000.0f);
+        if (transfer == CAS_Transfer_PQ && image.Format == CAS_Format_R10G10B10A2)
+        {
+            static const CasPqTable s_pqTable;
+            uint32_t* p = reinterpret_cast<uint32_t*>(pRow) + x0;
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                p[i] = CasPq10FromLinear(s_pqTable, pR[i] * nitsScale) | (CasPq10FromLinear(s_pqTable, pG[i] * nitsScale) << 10) |
+                    (CasPq10FromLinear(s_pqTable, pB[i] * nitsScale) << 20) | (3u << 30);
+            }
+            return;
+        }
+
+        switch (transfer)
+        {
+        case CAS_Transfer_sRGB:
+            CasStoreRow(image.Format, pRow, x0, count, pR, pG, pB, [](float v) { return CasSrgbFromLinear(v); });
+            break;
+        case CAS_Transfer_PQ:
+            CasStoreRow(image.Format, pRow, x0, count, pR, pG, pB, [nitsScale](float v) { return CasPqFromLinear(v * nitsScale); });
+            break;
+        default:
+            CasStoreRow(image.Format, pRow, x0, count, pR, pG, pB, [](float v) { return v; });
+            break;
+        }
+    }
+
+    // Alpha passed through (CAS_Filter::SetAlphaPassThrough()) over the opaque alpha a store wrote, linear and without
+    // dither in every format.
+    static void CasStoreAlphaRow(const CAS_Image& image, uint32_t y, uint32_t x0, uint32_t count, const float* pA)
+    {
+        uint8_t* pRow = static_cast<uint8_t*>(image.pData) + static_cast<size_t>(y) * image.RowPitch;
+        switch (image.Format)
+        {
+        case CAS_Format_RGBA32F:
+        {
+            float* p = reinterpret_cast<float*>(pRow) + x0 * 4;
+            for (uint32_t i = 0; i < count; ++i, p += 4)
+            {
+                p[3] = pA[i];
+            }
+            break;
+        }
+        case CAS_Format_RGBA16F:
+        {
+            uint16_t* p = reinterpret_cast<uint16_t*>(pRow) + x0 * 4;
+            for (uint32_t i = 0; i < count; ++i, p += 4)
+            {
+                p[3] = static_cast<uint16_t>(AU1_AH1_AF1(pA[i]));
+            }
+            break;
+        }
+        case CAS_Format_R10G10B10A2:
+        {
+            uint32_t* p = reinterpret_cast<uint32_t*>(pRow) + x0;
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                p[i] = (p[i] & 0x3fffffffu) | (static_cast<uint32_t>(AMinF1(AMaxF1(pA[i], 0.0f), 1.0f) * 3.0f + 0.5f) << 30);
+            }
+            break;
+        }
+        case CAS_Format_R32F:
+        case CAS_Format_RG32F:
+        case CAS_Format_R8:
+        case CAS_Format_RG8:
+            break;
+        default:
+        {
+            uint8_t* p = pRow + x0 * 4;
+            for (uint32_t i = 0; i < count; ++i, p += 4)
+            {
+                p[3] = static_cast<uint8_t>(AMinF1(AMaxF1(pA[i], 0.0f), 1.0f) * 255.0f + 0.5f);
+            }
+            break;
+        }
+        }
+    }
+
+    //==============================================================================================================
+    // Overlay (CAS_Filter::SetOverlay())
+    //==============================================================================================================
+    // Premultiplied alpha leaves the result unchanged only where the overlay is all zero, whatever the format, so a rect
+    // is clear when its bytes are.
+    static bool CasOverlayClear(const CAS_Image& overlay, uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1)
+    {
+        const uint32_t pixelSize = CAS_Filter::GetFormatSize(overlay.Format);
+        const size_t bytes = static_cast<size_t>(x1 - x0) * pixelSize;
+        for (uint32_t y = y0; y < y1; ++y)
+        {
+            const uint8_t* p = static_cast<const uint8_t*>(overlay.pData) + static_cast<size_t>(y) * overlay.RowPitch + static_cast<size_t>(x0) * pixelSize;
+            uint64_t bits = 0;
+            size_t i = 0;
+            for (; i + 8 <= bytes; i += 8)
+            {
+                uint64_t word;
+                memcpy(&word, p + i, 8);
+                bits |= word;
+            }
+            for (; i < bytes; ++i)
+            {
+                bits |= p[i];
+            }
+            if (bits != 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Row of the overlay decoded to planar RGBA at pitch, nullptr for none.
+    struct CasOverlayRow
+    {
+        const float*        pData;
+        uint32_t            Pitch;
+    };
+
+    static CasOverlayRow CasDecodeOverlayRow(const CAS_Image* pOverlay, uint32_t y, uint32_t x0, uint32_t count, std::vector<float>& storage)
+    {
+        if (!pOverlay)
+        {
+            return { nullptr, 0 };
+        }
+        const uint32_t pitch = CasAlign8(count);
+        if (storage.size() < pitch * 4)
+        {
+            storage.resize(pitch * 4);
+        }
+        float* pRow = storage.data();
+        const uint8_t* pData = static_cast<const uint8_t*>(pOverlay->pData) + static_cast<size_t>(y) * pOverlay->RowPitch;
+        CasDecodeSpan(pOverlay->Format, pData, static_cast<int32_t>(x0), count, pRow, pRow + pitch, pRow + pitch * 2);
+        CasDecodeAlphaSpan(pOverlay->Format, pData, static_cast<int32_t>(x0), count, pRow + pitch * 3);
+        return { pRow, pitch };
+    }
+
+    // Writes a row of the view's result: into the output, or into every target from the same planar rows. The output
+    // transform runs on the rows in place first, then the overlay is composited over them. Alpha is 1 when pA is nullptr.
+    static void CasEncodeOutputRow(const CAS_Image& output, const CAS_Target* pTargets, uint32_t targetCount, const CAS_ColorTransform* pTransform,
+                                   const CasOverlayRow& overlay, uint32_t y, uint32_t x0, uint32_t count, float* pR, float* pG, float* pB, float* pA)
+    {
+        if (pTransform)
+        {
+            pTransform->Apply(pR, pG, pB, count);
+        }
+        if (overlay.pData)
+        {
+            const float* pOverlayR = overlay.pData;
+            const float* pOverlayG = pOverlayR + overlay.Pitch;
+            const float* pOverlayB = pOverlayG + overlay.Pitch;
+            const float* pOverlayA = pOverlayB + overlay.Pitch;
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                const float transmit = 1.0f - pOverlayA[i];
+                pR[i] = pR[i] * transmit + pOverlayR[i];
+                pG[i] = pG[i] * transmit + pOverlayG[i];
+                pB[i] = pB[i] * transmit + pOverlayB[i];
+            }
+            if (pA)
+            {
+                for (uint32_t i = 0; i < count; ++i)
+                {
+                    pA[i] = pA[i] * (1.0f - pOverlayA[i]) + pOverlayA[i];
+                }
+            }
+        }
+        if (targetCount == 0)
+        {
+            const CAS_Target target = { output, CAS_Transfer_Linear, 0.0f, CAS_Dither_None, 0.0f, 0 };
+            CasEncodeRow(target, y, x0, count, pR, pG, pB);
+            if (pA)
+            {
+                CasStoreAlphaRow(output, y, x0, count, pA);
+            }
+            return;
+        }
+        for (uint32_t target = 0; target < targetCount; ++target)
+        {
+            CasEncodeRow(pTargets[target], y, x0, count, pR, pG, pB);
+            if (pA)
+            {
+                CasStoreAlphaRow(pTargets[target].Image, y, x0, count, pA);
+            }
+        }
+    }
+
+    //==============================================================================================================
+    // Tier selection
+    //==============================================================================================================
+    static bool CasCpuHasAvx2()
+    {
+#if defined(_MSC_VER) && defined(_M_X64)
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7)
+        {
+            return false;
+        }
+        __cpuid(info, 1);
+        const bool fma = (info[2] & (1 << 12)) != 0;
+        const bool osxsave = (info[2] & (1 << 27)) != 0;
+        if (!fma || !osxsave || (_xgetbv(0) & 6) != 6)
+        {
+            return false;
+        }
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#elif defined(__GNUC__) && defined(__x86_64__)
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+        return false;
+#endif
+    }
+
+    std::string CAS_Filter::GetCpuName()
+    {
+        char brand[49] = {};
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+        int info[4];
+        __cpuid(info, 0x80000000);
+        if (static_cast<uint32_t>(info[0]) >= 0x80000004u)
+        {
+            for (int i = 0; i < 3; ++i)
+            {
+                __cpuid(info, 0x80000002 + i);
+                memcpy(brand + i * 16, info, 16);
+            }
+        }
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+        if (__get_cpuid_max(0x80000000u, nullptr) >= 0x80000004u)
+        {
+            for (uint32_t i = 0; i < 3; ++i)
+            {
+                uint32_t info[4];
+                __get_cpuid(0x80000002u + i, &info[0], &info[1], &info[2], &info[3]);
+                memcpy(brand + i * 16, info, 16);
+            }
+        }
+#endif
+        std::string name(brand);
+        size_t first = name.find_first_not_of(' ');
+        size_t last = name.find_last_not_of(' ');
+        return first == std::string::npos ? "Unknown CPU" : name.substr(first, last - first + 1);
+    }
+
+    const CAS_KernelTable* CAS_GetKernelTable(CAS_Tier tier)
+    {
+        switch (tier)
+        {
+        case CAS_Tier_Scalar:   return CAS_GetKernelTableScalar();
+        case CAS_Tier_SSE2:     return CAS_GetKernelTableSSE2();
+        case CAS_Tier_AVX2:     return CasCpuHasAvx2() ? CAS_GetKernelTableAVX2() : nullptr;
+        default:                return nullptr;
+        }
+    }
+
+    bool CAS_Filter::IsTierSupported(CAS_Tier tier)
+    {
+        return CAS_GetKernelTable(tier) != nullptr;
+    }
+
+    CAS_Tier CAS_Filter::GetBestTier()
+    {
+        for (int tier = CAS_Tier_Count - 1; tier > CAS_Tier_Scalar; --tier)
+        {
+            if (IsTierSupported(static_cast<CAS_Tier>(tier)))
+            {
+                return static_cast<CAS_Tier>(tier);
+            }
+        }
+        return CAS_Tier_Scalar;
+    }
+
+    const char* CAS_Filter::GetTierName(CAS_Tier tier)
+    {
+        static const char* s_names[] = { "Scalar", "SSE2", "AVX2" };
+        return tier < CAS_Tier_Count ? s_names[tier] : "Unknown";
+    }
+
+    std::string CAS_Filter::GetVariantName(uint32_t variant)
+    {
+        std::string name;
+        if (variant & CAS_Variant_BetterDiagonals)
+        {
+            name += "CAS_BETTER_DIAGONALS";
+        }
+        if (variant & CAS_Variant_Slow)
+        {
+            name += name.empty() ? "CAS_SLOW" : "|CAS_SLOW";
+        }
+        if (variant & CAS_Variant_GoSlower)
+        {
+            name += name.empty() ? "CAS_GO_SLOWER" : "|CAS_GO_SLOWER";
+        }
+        return name.empty() ? "Default" : name;
+    }
+
+    const char* CAS_Filter::GetPrecisionName(CAS_Precision precision)
+    {
+        static const char* s_names[] = { "FP32", "FP16", "Fixed16" };
+        return precision < CAS_Precision_Count ? s_names[precision] : "Unknown";
+    }
+
+    const char* CAS_Filter::GetTraversalName(CAS_Traversal traversal)
+    {
+        static const char* s_names[] = { "RowMajor", "ColumnMajor", "Morton" };
+        return traversal < CAS_Traversal_Count ? s_names[traversal] : "Unknown";
+    }
+
+    const char* CAS_Filter::GetReductionName(CAS_Reduction reduction)
+    {
+        static const char* s_names[] = { "None", "Box", "Tent" };
+        return reduction < CAS_Reduction_Count ? s_names[reduction] : "Unknown";
+    }
+
+    const char* CAS_Filter::GetTransferName(CAS_Transfer transfer)
+    {
+        static const char* s_names[] = { "Linear", "sRGB", "PQ" };
+        return transfer < CAS_Transfer_Count ? s_names[transfer] : "Unknown";
+    }
+
+    const char* CAS_Filter::GetDitherName(CAS_Dither dither)
+    {
+        static const char* s_names[] = { "None", "Ordered", "BlueNoise" };
+        return dither < CAS_Dither_Count ? s_names[dither] : "Unknown";
+    }
+
+    uint32_t CAS_Filter::GetFormatSize(CAS_Format format)
+    {
+        switch (format)
+        {
+        case CAS_Format_RGBA32F:    return 16;
+        case CAS_Format_RGBA16F:    return 8;
+        case CAS_Format_RG32F:      return 8;
+        case CAS_Format_RG8:        return 2;
+        case CAS_Format_R8:         return 1;
+        default:                    return 4;
+        }
+    }
+
+    uint32_t CAS_Filter::GetFormatChannels(CAS_Format format)
+    {
+        switch (format)
+        {
+        case CAS_Format_R32F:
+        case CAS_Format_R8:         return 1;
+        case CAS_Format_RG32F:
+        case CAS_Format_RG8:        return 2;
+        default:                    return 4;
+        }
+    }
+
+    void CAS_Filter::LoadPixel(const CAS_Image& image, uint32_t x, uint32_t y, float& r, float& g, float& b)
+    {
+        const uint8_t* pRow = static_cast<const uint8_t*>(image.pData) + static_cast<size_t>(y) * image.RowPitch;
+        CasDecodePixel(image.Format, pRow, static_cast<int32_t>(x), r, g, b);
+    }
+
+    //==============================================================================================================
+    // Filter
+    //==============================================================================================================
+    void CAS_Filter::OnCreate(uint32_t threadCount, CAS_Tier tier)
+    {
+        if (threadCount == 0)
+        {
+            threadCount = CAS_ThreadPool::GetHardwareThreadCount();
+        }
+        m_threadPool.OnCreate(threadCount);
+        m_scratch.resize(threadCount);
+
+        SetTier(tier);
+    }
+
+    void CAS_Filter::OnDestroy()
+    {
+        m_threadPool.OnDestroy();
+        m_scratch.clear();
+    }
+
+    void CAS_Filter::OnCreateWindowSizeDependentResources(uint32_t renderWidth, uint32_t renderHeight, uint32_t Width, uint32_t Height, CAS_State CASState)
+    {
+        m_renderWidth = renderWidth;
+        m_renderHeight = renderHeight;
+        m_width = Width;
+        m_height = Height;
+
+        UpdateSharpness(m_sharpenVal, CASState);
+    }
+
+    void CAS_Filter::OnDestroyWindowSizeDependentResources()
+    {
+        for (ThreadScratch& scratch : m_scratch)
+        {
+            scratch = ThreadScratch();
+        }
+    }
+
+    void CAS_Filter::UpdateSharpness(float NewSharpenVal, CAS_State CASState)
+    {
+        m_sharpenVal = NewSharpenVal;
+        m_sourceWidth = GetReducedSize(m_renderWidth);
+        m_sourceHeight = GetReducedSize(m_renderHeight);
+
+        AF1 outWidth = static_cast<AF1>((CASState == CAS_State_Upsample) ? m_width : m_sourceWidth);
+        AF1 outHeight = static_cast<AF1>((CASState == CAS_State_Upsample) ? m_height : m_sourceHeight);
+
+        CasSetup(m_consts.Const0, m_consts.Const1, m_sharpenVal, static_cast<AF1>(m_sourceWidth),
+                 static_cast<AF1>(m_sourceHeight), outWidth, outHeight);
+
+        // Beyond CAS_AREA_LIMIT plan the fewest passes within it, sizes in geometric progression. The passes before the
+        // last only scale (SetupScaleConstants()) and the last one sharpens once.
+        m_cascade.clear();
+        if (CASState != CAS_State_Upsample || m_sourceWidth == 0 || m_sourceHeight == 0 ||
+            CasSupportScaling(outWidth, outHeight, static_cast<AF1>(m_sourceWidth), static_cast<AF1>(m_sourceHeight)))
+        {
+            return;
+        }
+        const double ratioX = static_cast<double>(m_width) / m_sourceWidth;
+        const double ratioY = static_cast<double>(m_height) / m_sourceHeight;
+        uint32_t passCount = static_cast<uint32_t>(std::ceil(std::log(ratioX * ratioY) / std::log(CAS_AREA_LIMIT)));
+        for (bool fits = false; !fits; ++passCount)
+        {
+            fits = true;
+            m_cascade.resize(passCount);
+            uint32_t width = m_sourceWidth, height = m_sourceHeight;
+            for (uint32_t pass = 0; pass < passCount; ++pass)
+            {
+                const bool last = (pass + 1 == passCount);
+                const double t = static_cast<double>(pass + 1) / passCount;
+                CascadePass& cascadePass = m_cascade[pass];
+                cascadePass.Width = last ? m_width : static_cast<uint32_t>(m_sourceWidth * std::pow(ratioX, t) + 0.5);
+                cascadePass.Height = last ? m_height : static_cast<uint32_t>(m_sourceHeight * std::pow(ratioY, t) + 0.5);
+                fits = fits && CasSupportScaling(static_cast<AF1>(cascadePass.Width), static_cast<AF1>(cascadePass.Height), static_cast<AF1>(width), static_cast<AF1>(height));
+                if (last)
+                {
+                    SetupConstants(cascadePass.Consts, m_sharpenVal, width, height, cascadePass.Width, cascadePass.Height);
+                }
+                else
+                {
+                    SetupScaleConstants(cascadePass.Consts, width, height, cascadePass.Width, cascadePass.Height);
+                }
+                width = cascadePass.Width;
+                height = cascadePass.Height;
+            }
+        }
+    }
+
+    void CAS_Filter::SetTier(CAS_Tier tier)
+    {
+        if (tier >= CAS_Tier_Count || !IsTierSupported(tier))
+        {
+            tier = GetBestTier();
+        }
+        m_tier = tier;
+    }
+
+    void CAS_Filter::SetTileSize(uint32_t width, uint32_t height)
+    {
+        m_tileWidth = CasAlign8(std::max(width, 1u));
+        m_tileHeight = CasAlign8(std::max(height, 1u));
+    }
+
+    void CAS_Filter::SetReduction(CAS_Reduction reduction, uint32_t factor)
+    {
+        if (reduction >= CAS_Reduction_Count || factor < 2)
+        {
+            reduction = CAS_Reduction_None;
+        }
+        m_reduction = reduction;
+        m_reductionFactor = reduction == CAS_Reduction_None ? 1 : factor;
+        m_reductionWeights.clear();
+        if (reduction == CAS_Reduction_None)
+        {
+            m_reductionStart = 0;
+            return;
+        }
+
+        // Box: the factor texels of the source texel. Tent: a triangle over twice that many, centered on the same
+        // point, without the zero weight ends of odd factors.
+        const int32_t size = static_cast<int32_t>(factor);
+        const int32_t start = (reduction == CAS_Reduction_Box) ? 0 : -(size / 2);
+        const int32_t end = (reduction == CAS_Reduction_Box) ? size : size + size / 2;
+        float total = 0.0f;
+        for (int32_t tap = start; tap < end; ++tap)
+        {
+            const float distance = std::fabs(static_cast<float>(tap) + 0.5f - 0.5f * static_cast<float>(size));
+            const float weight = (reduction == CAS_Reduction_Box) ? 1.0f : 1.0f - distance / static_cast<float>(size);
+            m_reductionWeights.push_back(weight);
+            total += weight;
+        }
+        for (float& weight : m_reductionWeights)
+        {
+            weight /= total;
+        }
+        m_reductionStart = start;
+    }
+
+    void CAS_Filter::SetSharpnessMap(const float* pMap, uint32_t mapWidth, uint32_t mapHeight)
+    {
+        if (!pMap || mapWidth == 0 || mapHeight == 0)
+        {
+            m_sharpnessMap.clear();
+            m_sharpnessMapWidth = m_sharpnessMapHeight = 0;
+            return;
+        }
+        m_sharpnessMap.assign(pMap, pMap + static_cast<size_t>(mapWidth) * mapHeight);
+        m_sharpnessMapWidth = mapWidth;
+        m_sharpnessMapHeight = mapHeight;
+    }
+
+    void CAS_Filter::SetThreadCount(uint32_t threadCount)
+    {
+        if (threadCount == 0)
+        {
+            threadCount = CAS_ThreadPool::GetHardwareThreadCount();
+        }
+        if (threadCount != m_threadPool.GetThreadCount())
+        {
+            m_threadPool.OnDestroy();
+            m_threadPool.OnCreate(threadCount);
+            m_scratch.resize(threadCount);
+        }
+    }
+
+    void CAS_Filter::ApplyProfile(const CAS_Profile& profile)
+    {
+        SetTier(profile.Tier);
+        SetVariant(profile.Variant);
+        SetPrecision(profile.Precision);
+    }
+
+    bool CAS_Filter::LoadProfile(const char* pPath)
+    {
+        CAS_Profile profile;
+        if (!CAS_ProfileFile::Load(pPath, profile))
+        {
+            return false;
+        }
+        ApplyProfile(profile);
+        return true;
+    }
+
+    void CAS_Filter::Upscale(const CAS_Image& input, const CAS_Image& output, CAS_State casState)
+    {
+        if (casState == CAS_State_NoCas)
+        {
+            return;
+        }
+
+        // The output no longer matches the hashes of UpscaleChanged().
+        m_tileHashes.clear();
+
+        RunFrame(input, output, GetFullFrameView(input, output), casState == CAS_State_SharpenOnly);
+    }
+
+    void CAS_Filter::UpscaleTargets(const CAS_Image& input, const CAS_Target* pTargets, uint32_t targetCount, CAS_State casState)
+    {
+        if (casState == CAS_State_NoCas || targetCount == 0)
+        {
+            return;
+        }
+
+        m_tileHashes.clear();
+
+        FrameView view = GetFullFrameView(input, pTargets[0].Image);
+        view.pTargets = pTargets;
+        view.TargetCount = targetCount;
+        RunFrame(input, pTargets[0].Image, view, casState == CAS_State_SharpenOnly);
+    }
+
+    void CAS_Filter::RunFrame(const CAS_Image& input, const CAS_Image& output, const FrameView& frameView, bool sharpenOnly)
+    {
+        const uint32_t tileWidth = GetRunTileWidth();
+        FrameView view = frameView;
+        view.Measured = m_statisticsEnabled;
+        view.Contrast = (m_pContrastMap != nullptr) && view.Channels >= 3;
+        view.pOverlay = (m_pOverlay && m_pOverlay->Width >= view.Width && m_pOverlay->Height >= view.Height && view.Channels >= 3 &&
+                         GetFormatChannels(m_pOverlay->Format) == 4) ? m_pOverlay : nullptr;
+        if (view.Contrast)
+        {
+            m_contrastBlocks.resize(static_cast<size_t>((view.Width + 7) / 8) * ((view.Height + 7) / 8));
+        }
+
+        if (UseCascade(sharpenOnly) && !m_cascadeFused)
+        {
+            RunCascadeStored(input, output, view);
+        }
+        else if (UseCascade(sharpenOnly))
+        {
+            // A fused tile filters the borders it shares with its neighbours in every earlier pass once more, so the
+            // cascade runs on groups of tiles to keep that small while the intermediate regions still fit in L2.
+            const uint32_t groupWidth = tileWidth * s_cascadeGroup;
+            const uint32_t groupHeight = m_tileHeight * s_cascadeGroup;
+            const uint32_t groupsX = (view.Grid.Width + groupWidth - 1) / groupWidth;
+            const uint32_t groupsY = (view.Grid.Height + groupHeight - 1) / groupHeight;
+            TileStatistics* pStatistics = BeginStatistics(groupsX * groupsY);
+            m_threadPool.Run(groupsX * groupsY, [&](uint32_t item, uint32_t threadIndex)
+            {
+                const uint32_t x = view.Grid.X + (item % groupsX) * groupWidth;
+                const uint32_t y = view.Grid.Y + (item / groupsX) * groupHeight;
+                const CAS_Rect group = { x, y, std::min(groupWidth, view.Grid.X + view.Grid.Width - x), std::min(groupHeight, view.Grid.Y + view.Grid.Height - y) };
+                m_scratch[threadIndex].pStatistics = pStatistics ? pStatistics + item : nullptr;
+                ProcessCascadeTile(input, output, view, group, m_scratch[threadIndex]);
+            });
+            if (pStatistics)
+            {
+                EndStatistics();
+            }
+        }
+        else
+        {
+            const uint32_t tilesX = (view.Grid.Width + tileWidth - 1) / tileWidth;
+            const uint32_t tilesY = (view.Grid.Height + m_tileHeight - 1) / m_tileHeight;
+            UpdateTileOrder(tilesX, tilesY);
+            const uint32_t* pOrder = m_tileOrder.empty() ? nullptr : m_tileOrder.data();
+
+            TileStatistics* pStatistics = BeginStatistics(tilesX * tilesY);
+            m_threadPool.Run(tilesX * tilesY, [&](uint32_t item, uint32_t threadIndex)
+            {
+                const uint32_t tile = pOrder ? pOrder[item] : item;
+                m_scratch[threadIndex].pStatistics = pStatistics ? pStatistics + tile : nullptr;
+                ProcessFrameTile(input, output, view, sharpenOnly, tile, m_scratch[threadIndex]);
+            });
+            if (pStatistics)
+            {
+                EndStatistics();
+            }
+        }
+
+        if (view.Contrast)
+        {
+            EndContrastMap(view);
+        }
+    }
+
+    void CAS_Filter::ProcessFrameTile(const CAS_Image& input, const CAS_Image& output, const FrameView& view, bool sharpenOnly, uint32_t tileIndex, ThreadScratch& scratch)
+    {
+        const uint32_t tileWidth = GetRunTileWidth();
+        if (UseCascade(sharpenOnly))
+        {
+            const uint32_t tilesX = (view.Grid.Width + tileWidth - 1) / tileWidth;
+            const uint32_t x = view.Grid.X + (tileIndex % tilesX) * tileWidth;
+            const uint32_t y = view.Grid.Y + (tileIndex / tilesX) * m_tileHeight;
+            const CAS_Rect tile = { x, y, std::min(tileWidth, view.Grid.X + view.Grid.Width - x), std::min(m_tileHeight, view.Grid.Y + view.Grid.Height - y) };
+            ProcessCascadeTile(input, output, view, tile, scratch);
+        }
+        else
+        {
+            ProcessTile(input, output, view, sharpenOnly, tileIndex, scratch);
+        }
+    }
+
+    CAS_Filter::FrameView CAS_Filter::GetFullFrameView(const CAS_Image& input, const CAS_Image& output) const
+    {
+        FrameView view = {};
+        view.Width = output.Width;
+        view.Height = output.Height;
+        view.SourceWidth = GetReducedSize(input.Width);
+        view.SourceHeight = GetReducedSize(input.Height);
+        view.InputWidth = input.Width;
+        view.InputHeight = input.Height;
+        view.Reduced = m_reductionFactor > 1;
+        view.Region = { 0, 0, output.Width, output.Height };
+        view.Grid = view.Region;
+        view.pConsts = &m_consts;
+        view.Mapped = true;
+        view.pInputTransform = m_inputTransform;
+        view.pOutputTransform = m_outputTransform;
+        view.Alpha = m_alphaPassThrough;
+        SetViewChannels(view, input.Format);
+        return view;
+    }
+
+    void CAS_Filter::SetViewChannels(FrameView& view, CAS_Format inputFormat) const
+    {
+        const uint32_t formatChannels = GetFormatChannels(inputFormat);
+        view.Channels = formatChannels == 4 ? (m_sharpenAlpha ? 4 : 3) : formatChannels;
+        if (view.Channels < 3)
+        {
+            view.pInputTransform = nullptr;
+            view.pOutputTransform = nullptr;
+        }
+        // The block kernels filter RGB.
+        view.Mapped = view.Mapped && view.Channels == 3;
+        // A sharpened alpha replaces the passed through one.
+        view.Alpha = view.Alpha && view.Channels == 3;
+    }
+
+    void CAS_Filter::SetupConstants(CASConstants& consts, float sharpness, uint32_t sourceWidth, uint32_t sourceHeight, uint32_t width, uint32_t height)
+    {
+        CasSetup(consts.Const0, consts.Const1, sharpness, static_cast<AF1>(sourceWidth), static_cast<AF1>(sourceHeight),
+                 static_cast<AF1>(width), static_cast<AF1>(height));
+    }
+
+    void CAS_Filter::SetupScaleConstants(CASConstants& consts, uint32_t sourceWidth, uint32_t sourceHeight, uint32_t width, uint32_t height)
+    {
+        // Sharpness 0 still has a negative lobe (peak -1/8). With a peak of 0 the taps lose it and the pass only scales,
+        // the contrast thinned bilinear of f g j k.
+        SetupConstants(consts, 0.0f, sourceWidth, sourceHeight, width, height);
+        consts.Const1[0] = AU1_AF1(0.0f);
+        consts.Const1[1] = 0;
+    }
+
+    bool CAS_Filter::IsScalingSupported(uint32_t sourceWidth, uint32_t sourceHeight, uint32_t width, uint32_t height)
+    {
+        return CasSupportScaling(static_cast<AF1>(width), static_cast<AF1>(height), static_cast<AF1>(sourceWidth), static_cast<AF1>(sourceHeight));
+    }
+
+    CAS_Rect CAS_Filter::GetBlockGrid(const CAS_Rect& region, uint32_t frameWidth, uint32_t frameHeight)
+    {
+        const uint32_t x0 = std::min(region.X, frameWidth) & ~7u;
+        const uint32_t y0 = std::min(region.Y, frameHeight) & ~7u;
+        const uint32_t x1 = std::min(CasAlign8(std::min(region.X + region.Width, frameWidth)), frameWidth);
+        const uint32_t y1 = std::min(CasAlign8(std::min(region.Y + region.Height, frameHeight)), frameHeight);
+        return { x0, y0, x1 > x0 ? x1 - x0 : 0, y1 > y0 ? y1 - y0 : 0 };
+    }
+
+    CAS_Rect CAS_Filter::GetPassFootprint(const CAS_Rect& grid, const CASConstants& consts, bool sharpenOnly, uint32_t sourceWidth, uint32_t sourceHeight)
+    {
+        if (grid.Width == 0 || grid.Height == 0)
+        {
+            return { 0, 0, 0, 0 };
+        }
+
+        // The taps of the first and last pixel, 1 texel around the pixel when sharpening and the 4x4 around floor(pp) when
+        // scaling, with the same float math as ProcessTile().
+        int32_t x0 = static_cast<int32_t>(grid.X) - 1;
+        int32_t y0 = static_cast<int32_t>(grid.Y) - 1;
+        int32_t x1 = static_cast<int32_t>(grid.X + grid.Width) + 1;
+        int32_t y1 = static_cast<int32_t>(grid.Y + grid.Height) + 1;
+        if (!sharpenOnly)
+        {
+            const float scaleX = CasAsFloat(consts.Const0[0]);
+            const float scaleY = CasAsFloat(consts.Const0[1]);
+            const float offsetX = CasAsFloat(consts.Const0[2]);
+            const float offsetY = CasAsFloat(consts.Const0[3]);
+            x0 = static_cast<int32_t>(std::floor(static_cast<float>(grid.X) * scaleX + offsetX)) - 1;
+            y0 = static_cast<int32_t>(std::floor(static_cast<float>(grid.Y) * scaleY + offsetY)) - 1;
+            x1 = static_cast<int32_t>(std::floor(static_cast<float>(grid.X + grid.Width - 1) * scaleX + offsetX)) + 3;
+            y1 = static_cast<int32_t>(std::floor(static_cast<float>(grid.Y + grid.Height - 1) * scaleY + offsetY)) + 3;
+        }
+
+        // Taps outside the source are clamped to its edge, which is inside the clamped rectangle.
+        x0 = std::max(x0, 0);
+        y0 = std::max(y0, 0);
+        x1 = std::min(x1, static_cast<int32_t>(sourceWidth));
+        y1 = std::min(y1, static_cast<int32_t>(sourceHeight));
+        return { static_cast<uint32_t>(x0), static_cast<uint32_t>(y0), static_cast<uint32_t>(std::max(x1 - x0, 0)), static_cast<uint32_t>(std::max(y1 - y0, 0)) };
+    }
+
+    CAS_Rect CAS_Filter::GetFootprint(const CAS_Rect& grid, bool sharpenOnly, uint32_t inputWidth, uint32_t inputHeight) const
+    {
+        const uint32_t sourceWidth = GetReducedSize(inputWidth);
+        const uint32_t sourceHeight = GetReducedSize(inputHeight);
+        CAS_Rect footprint;
+        if (!UseCascade(sharpenOnly))
+        {
+            footprint = GetPassFootprint(grid, m_consts, sharpenOnly, sourceWidth, sourceHeight);
+        }
+        else
+        {
+            std::vector<CAS_Rect> rects;
+            GetCascadeFootprints(grid, rects);
+            footprint = rects[0];
+            footprint.Width = std::min(footprint.X + footprint.Width, sourceWidth) - std::min(footprint.X, sourceWidth);
+            footprint.Height = std::min(footprint.Y + footprint.Height, sourceHeight) - std::min(footprint.Y, sourceHeight);
+        }
+        if (m_reductionFactor == 1 || footprint.Width == 0 || footprint.Height == 0)
+        {
+            return footprint;
+        }
+
+        // The taps of the first and last source texel.
+        const int32_t factor = static_cast<int32_t>(m_reductionFactor);
+        const int32_t taps = static_cast<int32_t>(m_reductionWeights.size());
+        const int32_t x0 = std::max(static_cast<int32_t>(footprint.X) * factor + m_reductionStart, 0);
+        const int32_t y0 = std::max(static_cast<int32_t>(footprint.Y) * factor + m_reductionStart, 0);
+        const int32_t x1 = std::min(static_cast<int32_t>(footprint.X + footprint.Width - 1) * factor + m_reductionStart + taps, static_cast<int32_t>(inputWidth));
+        const int32_t y1 = std::min(static_cast<int32_t>(footprint.Y + footprint.Height - 1) * factor + m_reductionStart + taps, static_cast<int32_t>(inputHeight));
+        return { static_cast<uint32_t>(x0), static_cast<uint32_t>(y0), static_cast<uint32_t>(x1 - x0), static_cast<uint32_t>(y1 - y0) };
+    }
+
+    void CAS_Filter::UpscaleRegion(const CAS_Image& input, uint32_t inputX, uint32_t inputY, const CAS_Image& output, CAS_State casState, const CAS_Rect& region)
+    {
+        if (casState == CAS_State_NoCas)
+        {
+            return;
+        }
+
+        const bool sharpenOnly = (casState == CAS_State_SharpenOnly);
+        FrameView view = {};
+        view.Width = sharpenOnly ? m_sourceWidth : m_width;
+        view.Height = sharpenOnly ? m_sourceHeight : m_height;
+        view.SourceWidth = m_sourceWidth;
+        view.SourceHeight = m_sourceHeight;
+        view.InputWidth = m_renderWidth;
+        view.InputHeight = m_renderHeight;
+        view.Reduced = m_reductionFactor > 1;
+        view.InputX = inputX;
+        view.InputY = inputY;
+        view.Grid = GetBlockGrid(region, view.Width, view.Height);
+        view.pConsts = &m_consts;
+        view.Mapped = true;
+        view.pInputTransform = m_inputTransform;
+        view.pOutputTransform = m_outputTransform;
+        view.Alpha = m_alphaPassThrough;
+        SetViewChannels(view, input.Format);
+
+        // Clip to the frame and to the output image.
+        view.Region.X = std::min(region.X, view.Width);
+        view.Region.Y = std::min(region.Y, view.Height);
+        view.Region.Width = std::min(std::min(region.Width, view.Width - view.Region.X), output.Width);
+        view.Region.Height = std::min(std::min(region.Height, view.Height - view.Region.Y), output.Height);
+        if (view.Region.Width == 0 || view.Region.Height == 0)
+        {
+            return;
+        }
+
+        m_tileHashes.clear();
+
+        RunFrame(input, output, view, sharpenOnly);
+    }
+
+    CAS_Rect CAS_Filter::GetInputRegion(const CAS_Rect& region, CAS_State casState) const
+    {
+        const bool sharpenOnly = (casState != CAS_State_Upsample);
+        const CAS_Rect grid = GetBlockGrid(region, sharpenOnly ? m_sourceWidth : m_width, sharpenOnly ? m_sourceHeight : m_height);
+        return GetFootprint(grid, sharpenOnly, m_renderWidth, m_renderHeight);
+    }
+
+    // Interleaves the bits of x and y, x in the even bits.
+    static uint32_t CasMortonCode(uint32_t x, uint32_t y)
+    {
+        uint32_t code = 0;
+        for (uint32_t bit = 0; bit < 16; ++bit)
+        {
+            code |= ((x >> bit) & 1u) << (2 * bit);
+            code |= ((y >> bit) & 1u) << (2 * bit + 1);
+        }
+        return code;
+    }
+
+    void CAS_Filter::UpdateTileOrder(uint32_t tilesX, uint32_t tilesY)
+    {
+        if (m_traversal == CAS_Traversal_RowMajor)
+        {
+            m_tileOrder.clear();
+            return;
+        }
+        if (!m_tileOrder.empty() && m_tileOrderX == tilesX && m_tileOrderY == tilesY && m_tileOrderTraversal == m_traversal)
+        {
+            return;
+        }
+
+        m_tileOrderX = tilesX;
+        m_tileOrderY = tilesY;
+        m_tileOrderTraversal = m_traversal;
+        m_tileOrder.resize(tilesX * tilesY);
+        for (uint32_t i = 0; i < tilesX * tilesY; ++i)
+        {
+            m_tileOrder[i] = i;
+        }
+        if (m_traversal == CAS_Traversal_ColumnMajor)
+        {
+            for (uint32_t i = 0; i < tilesX * tilesY; ++i)
+            {
+                m_tileOrder[i] = (i % tilesY) * tilesX + i / tilesY;
+            }
+        }
+        else
+        {
+            // Grids that are not a power of two square just skip the codes that fall outside.
+            std::sort(m_tileOrder.begin(), m_tileOrder.end(), [tilesX](uint32_t a, uint32_t b)
+            {
+                return CasMortonCode(a % tilesX, a / tilesX) < CasMortonCode(b % tilesX, b / tilesX);
+            });
+        }
+    }
+
+    // Converts the source texels [x, x+width) x [y, y+height) into planar rows of the precision and returns their pitch.
+    // FP32 goes to planes, the 16-bit precisions decode a row at a time into row and narrow it into planes16.
+    // Decodes the window into channels planes, alpha is the fourth when it is passed through or sharpened. One and two
+    // channel windows still get three float planes for the rows of CasDecodeRow(), the 16-bit ones only keep theirs.
+    static uint32_t CasDecodeWindow(const CasSource& source, CAS_Precision precision, uint32_t channels, int32_t x, int32_t y, uint32_t width, uint32_t height,
+                                    std::vector<float>& planes, std::vector<uint16_t>& planes16, std::vector<float>& row, const void* pPlanes[4])
+    {
+        const bool alpha = (channels == 4);
+        const uint32_t pitch = CasAlign8(width) + 8;
+        const size_t plane = static_cast<size_t>(pitch) * height;
+        if (precision == CAS_Precision_FP32)
+        {
+            if (planes.size() < plane * std::max(channels, 3u))
+            {
+                planes.resize(plane * std::max(channels, 3u), 0.0f);
+            }
+            float* pR = planes.data();
+            float* pG = pR + plane;
+            float* pB = pG + plane;
+            float* pA = alpha ? pB + plane : nullptr;
+            for (uint32_t i = 0; i < height; ++i)
+            {
+                const size_t offset = static_cast<size_t>(i) * pitch;
+                CasDecodeRow(source, y + static_cast<int32_t>(i), x, width, pR + offset, pG + offset, pB + offset, pA ? pA + offset : nullptr);
+                if (source.pTransform)
+                {
+                    source.pTransform->Apply(pR + offset, pG + offset, pB + offset, width);
+                }
+            }
+            pPlanes[0] = pR; pPlanes[1] = pG; pPlanes[2] = pB; pPlanes[3] = pA;
+            for (uint32_t c = channels; c < 3; ++c)
+            {
+                pPlanes[c] = nullptr;
+            }
+            return pitch;
+        }
+
+        // One extra texel for the AVX2 16-bit gather.
+        if (row.size() < pitch * std::max(channels, 3u))
+        {
+            row.resize(pitch * std::max(channels, 3u), 0.0f);
+        }
+        if (planes16.size() < plane * channels + 1)
+        {
+            planes16.resize(plane * channels + 1, 0);
+        }
+        float* pRow = row.data();
+        uint16_t* pR = planes16.data();
+        for (uint32_t i = 0; i < height; ++i)
+        {
+            CasDecodeRow(source, y + static_cast<int32_t>(i), x, width, pRow, pRow + pitch, pRow + pitch * 2, alpha ? pRow + pitch * 3 : nullptr);
+            if (source.pTransform)
+            {
+                source.pTransform->Apply(pRow, pRow + pitch, pRow + pitch * 2, width);
+            }
+            for (uint32_t c = 0; c < channels; ++c)
+            {
+                const float* pIn = pRow + c * pitch;
+                uint16_t* pOut = pR + c * plane + static_cast<size_t>(i) * pitch;
+                if (precision == CAS_Precision_FP16)
+                {
+                    for (uint32_t j = 0; j < width; ++j)
+                    {
+                        pOut[j] = static_cast<uint16_t>(AU1_AH1_AF1(pIn[j]));
+                    }
+                }
+                else
+                {
+                    for (uint32_t j = 0; j < width; ++j)
+                    {
+                        pOut[j] = static_cast<uint16_t>(AMinF1(AMaxF1(pIn[j], 0.0f), 1.0f) * 65535.0f + 0.5f);
+                    }
+                }
+            }
+        }
+        for (uint32_t c = 0; c < 4; ++c)
+        {
+            pPlanes[c] = c < channels ? pR + plane * c : nullptr;
+        }
+        return pitch;
+    }
+
+    void CAS_Filter::DecodeSharedWindow(const CAS_Image& input, const FrameView& view, const CAS_Rect& rect, ThreadScratch& scratch) const
+    {
+        const CasReduction reduction = { static_cast<int32_t>(m_reductionFactor), m_reductionStart, static_cast<uint32_t>(m_reductionWeights.size()),
+            m_reductionWeights.data(), static_cast<int32_t>(view.InputWidth) - 1, static_cast<int32_t>(view.InputHeight) - 1, &scratch.Reduce };
+        const CasSource source = { &input, static_cast<int32_t>(view.InputX), static_cast<int32_t>(view.InputY),
+            static_cast<int32_t>(view.SourceWidth) - 1, static_cast<int32_t>(view.SourceHeight) - 1, view.Reduced ? &reduction : nullptr, view.pInputTransform };
+
+        SharedWindow& shared = scratch.Shared;
+        shared.X = static_cast<int32_t>(rect.X) - 2;
+        shared.Y = static_cast<int32_t>(rect.Y) - 2;
+        shared.Width = rect.Width + 4;
+        shared.Height = rect.Height + 4;
+        shared.Pitch = CasDecodeWindow(source, m_precision, view.Alpha ? 4 : view.Channels, shared.X, shared.Y, shared.Width, shared.Height, scratch.Window, scratch.Window16, scratch.Source, shared.pPlanes);
+        shared.Valid = true;
+    }
+
+    // Classes of the 8x8 output blocks, see CAS_Filter::SetClassification().
+    enum CasBlockClass
+    {
+        CasBlock_Textured,
+        CasBlock_Flat,
+        CasBlock_Saturated,
+        CasBlock_Skip,      // Sharpness map value 0.
+        CasBlock_Count,
+    };
+
+    void CAS_Filter::ProcessTile(const CAS_Image& input, const CAS_Image& output, const FrameView& view, bool sharpenOnly, uint32_t tileIndex, ThreadScratch& scratch)
+    {
+        const uint32_t tileWidth = GetRunTileWidth();
+        // Tile position in the frame.
+        const uint32_t tilesX = (view.Grid.Width + tileWidth - 1) / tileWidth;
+        const uint32_t dstX = view.Grid.X + (tileIndex % tilesX) * tileWidth;
+        const uint32_t dstY = view.Grid.Y + (tileIndex / tilesX) * m_tileHeight;
+        const uint32_t width = std::min(tileWidth, view.Grid.X + view.Grid.Width - dstX);
+        const uint32_t height = std::min(m_tileHeight, view.Grid.Y + view.Grid.Height - dstY);
+        const uint32_t paddedWidth = CasAlign8(width);
+
+        // Part of the tile that is written, in frame pixels, and where the output image has it.
+        const uint32_t writeX0 = std::max(dstX, view.Region.X);
+        const uint32_t writeY0 = std::max(dstY, view.Region.Y);
+        const uint32_t writeX1 = std::min(dstX + width, view.Region.X + view.Region.Width);
+        const uint32_t writeY1 = std::min(dstY + height, view.Region.Y + view.Region.Height);
+        if (writeX0 >= writeX1 || writeY0 >= writeY1)
+        {
+            return;
+        }
+        const uint32_t outputX = writeX0 - view.Region.X;
+        const uint32_t writeWidth = writeX1 - writeX0;
+        const CAS_Image* pOverlay = (view.pOverlay && !CasOverlayClear(*view.pOverlay, writeX0, writeY0, writeX1, writeY1)) ? view.pOverlay : nullptr;
+
+        const CasReduction reduction = { static_cast<int32_t>(m_reductionFactor), m_reductionStart, static_cast<uint32_t>(m_reductionWeights.size()),
+            m_reductionWeights.data(), static_cast<int32_t>(view.InputWidth) - 1, static_cast<int32_t>(view.InputHeight) - 1, &scratch.Reduce };
+        const CasSource source = { &input, static_cast<int32_t>(view.InputX), static_cast<int32_t>(view.InputY),
+            static_cast<int32_t>(view.SourceWidth) - 1, static_cast<int32_t>(view.SourceHeight) - 1, view.Reduced ? &reduction : nullptr, view.pInputTransform };
+
+        // Strength of every 8x8 block from the sharpness map, nearest map value of the block.
+        const uint32_t blocksX = (width + 7) / 8;
+        const uint32_t blocksY = (height + 7) / 8;
+        const bool mapped = view.Mapped && !m_sharpnessMap.empty();
+        bool uniformStrength = true;
+        if (mapped)
+        {
+            const uint32_t frameBlocksX = (view.Width + 7) / 8;
+            const uint32_t frameBlocksY = (view.Height + 7) / 8;
+            scratch.Strength.resize(blocksX * blocksY);
+            bool skipped = true;
+            for (uint32_t by = 0; by < blocksY; ++by)
+            {
+                const uint32_t mapY = (dstY / 8 + by) * m_sharpnessMapHeight / frameBlocksY;
+                for (uint32_t bx = 0; bx < blocksX; ++bx)
+                {
+                    const uint32_t mapX = (dstX / 8 + bx) * m_sharpnessMapWidth / frameBlocksX;
+                    const float strength = AMinF1(AMaxF1(m_sharpnessMap[mapY * m_sharpnessMapWidth + mapX], 0.0f), 1.0f);
+                    scratch.Strength[by * blocksX + bx] = strength;
+                    skipped = skipped && strength <= 0.0f;
+                    uniformStrength = uniformStrength && strength == scratch.Strength[0];
+                }
+            }
+
+            // Nothing to sharpen: convert the tile straight from input to output, no halo and no kernel. The 16-bit
+            // precisions take the regular path so the quantization matches partly skipped tiles, and so does the
+            // contrast map, which needs the halo.
+            if (skipped && sharpenOnly && m_precision == CAS_Precision_FP32 && !view.Contrast)
+            {
+                // 8-bit to 8-bit round trips exactly, so the pixels are copied with alpha set to 1 (or kept when it is
+                // passed through). Gathering statistics needs the float values, it takes the conversion below.
+                const bool covered = writeX0 >= view.InputX && writeY0 >= view.InputY &&
+                    writeX1 <= view.InputX + input.Width && writeY1 <= view.InputY + input.Height;
+                if (input.Format == CAS_Format_RGBA8 && output.Format == CAS_Format_RGBA8 && covered && !view.Reduced && view.TargetCount == 0 &&
+                    !view.pInputTransform && !view.pOutputTransform && !view.Measured && !pOverlay)
+                {
+                    for (uint32_t y = writeY0; y < writeY1; ++y)
+                    {
+                        const uint8_t* pIn = static_cast<const uint8_t*>(input.pData) + static_cast<size_t>(y - view.InputY) * input.RowPitch + (writeX0 - view.InputX) * 4;
+                        uint8_t* pOut = static_cast<uint8_t*>(output.pData) + static_cast<size_t>(y - view.Region.Y) * output.RowPitch + outputX * 4;
+                        memcpy(pOut, pIn, writeWidth * 4);
+                        for (uint32_t x = 0; x < writeWidth && !view.Alpha; ++x)
+                        {
+                            pOut[x * 4 + 3] = 255;
+                        }
+                    }
+                    return;
+                }
+                if (scratch.Output.size() < paddedWidth * 4)
+                {
+                    scratch.Output.resize(paddedWidth * 4, 0.0f);
+                }
+                float* pRow = scratch.Output.data();
+                float* pAlpha = view.Alpha ? pRow + paddedWidth * 3 : nullptr;
+                for (uint32_t y = writeY0; y < writeY1; ++y)
+                {
+                    CasDecodeRow(source, static_cast<int32_t>(y), static_cast<int32_t>(writeX0), writeWidth, pRow, pRow + paddedWidth, pRow + paddedWidth * 2, pAlpha);
+                    if (source.pTransform)
+                    {
+                        source.pTransform->Apply(pRow, pRow + paddedWidth, pRow + paddedWidth * 2, writeWidth);
+                    }
+                    for (uint32_t i = 0; i < paddedWidth * 3; ++i)
+                    {
+                        pRow[i] = AMinF1(AMaxF1(pRow[i], 0.0f), 1.0f);
+                    }
+                    const CasOverlayRow overlay = CasDecodeOverlayRow(pOverlay, y, writeX0, writeWidth, scratch.Overlay);
+                    CasEncodeOutputRow(output, view.pTargets, view.TargetCount, view.pOutputTransform, overlay, y - view.Region.Y, outputX, writeWidth,
+                                       pRow, pRow + paddedWidth, pRow + paddedWidth * 2, pAlpha);
+                    if (view.Measured)
+                    {
+                        MeasureRow(*scratch.pStatistics, pRow, pRow + paddedWidth, pRow + paddedWidth * 2, writeWidth);
+                    }
+                }
+                return;
+            }
+        }
+
+        // Source window, the footprint of the tile plus the filter halo.
+        int32_t srcX, srcY;
+        uint32_t srcWidth, srcHeight;
+        if (sharpenOnly)
+        {
+            srcX = static_cast<int32_t>(dstX) - 1;
+            srcY = static_cast<int32_t>(dstY) - 1;
+            srcWidth = width + 2;
+            srcHeight = height + 2;
+        }
+        else
+        {
+            // Same mapping as the shader: pp = ip * const0.xy + const0.zw, tap 'f' at floor(pp).
+            const float scaleX = CasAsFloat(view.pConsts->Const0[0]);
+            const float scaleY = CasAsFloat(view.pConsts->Const0[1]);
+            const float offsetX = CasAsFloat(view.pConsts->Const0[2]);
+            const float offsetY = CasAsFloat(view.pConsts->Const0[3]);
+
+            scratch.Index.resize(paddedWidth + height);
+            scratch.Frac.resize(paddedWidth + height);
+            int32_t* pColumn = scratch.Index.data();
+            int32_t* pRow = pColumn + paddedWidth;
+            float* pColumnFrac = scratch.Frac.data();
+            float* pRowFrac = pColumnFrac + paddedWidth;
+
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                float pp = static_cast<float>(dstX + x) * scaleX + offsetX;
+                float fp = std::floor(pp);
+                pColumn[x] = static_cast<int32_t>(fp);
+                pColumnFrac[x] = pp - fp;
+            }
+            for (uint32_t y = 0; y < height; ++y)
+            {
+                float pp = static_cast<float>(dstY + y) * scaleY + offsetY;
+                float fp = std::floor(pp);
+                pRow[y] = static_cast<int32_t>(fp);
+                pRowFrac[y] = pp - fp;
+            }
+
+            srcX = pColumn[0] - 1;
+            srcY = pRow[0] - 1;
+            srcWidth = static_cast<uint32_t>(pColumn[width - 1] + 2 - srcX + 1);
+            srcHeight = static_cast<uint32_t>(pRow[height - 1] + 2 - srcY + 1);
+
+            // Make the positions window relative, padding columns repeat the last one so full vectors stay in bounds.
+            for (uint32_t x = 0; x < paddedWidth; ++x)
+            {
+                pColumn[x] = (x < width) ? pColumn[x] - srcX : pColumn[width - 1];
+                pColumnFrac[x] = (x < width) ? pColumnFrac[x] : 0.0f;
+            }
+            for (uint32_t y = 0; y < height; ++y)
+            {
+                pRow[y] -= srcY;
+            }
+        }
+
+        // Convert the source window once into planar rows, or use the shared window of UpscaleMulti() when it covers it
+        // and has the planes.
+        const SharedWindow& shared = scratch.Shared;
+        const uint32_t planes = view.Alpha ? 4 : view.Channels;
+        uint32_t srcPitch;
+        const void* pSrc[4] = {};
+        if (shared.Valid && shared.pPlanes[planes - 1] && srcX >= shared.X && srcY >= shared.Y &&
+            srcX + static_cast<int32_t>(srcWidth) <= shared.X + static_cast<int32_t>(shared.Width) &&
+            srcY + static_cast<int32_t>(srcHeight) <= shared.Y + static_cast<int32_t>(shared.Height))
+        {
+            const size_t offset = (static_cast<size_t>(srcY - shared.Y) * shared.Pitch + static_cast<size_t>(srcX - shared.X)) *
+                (m_precision == CAS_Precision_FP32 ? sizeof(float) : sizeof(uint16_t));
+            srcPitch = shared.Pitch;
+            for (uint32_t c = 0; c < planes; ++c)
+            {
+                pSrc[c] = static_cast<const uint8_t*>(shared.pPlanes[c]) + offset;
+            }
+        }
+        else
+        {
+            srcPitch = CasDecodeWindow(source, m_precision, planes, srcX, srcY, srcWidth, srcHeight, scratch.Source, scratch.Source16, scratch.Source, pSrc);
+        }
+
+        const size_t dstPlane = static_cast<size_t>(paddedWidth) * height;
+        if (scratch.Output.size() < dstPlane * 4)
+        {
+            scratch.Output.resize(dstPlane * 4, 0.0f);
+        }
+
+        CAS_TileArgs args = {};
+        args.pSrc[0] = pSrc[0];
+        args.pSrc[1] = pSrc[1];
+        args.pSrc[2] = pSrc[2];
+        args.pSrc[3] = pSrc[3];
+        args.SrcPitch = srcPitch;
+        args.pDst[0] = scratch.Output.data();
+        args.pDst[1] = args.pDst[0] + dstPlane;
+        args.pDst[2] = args.pDst[1] + dstPlane;
+        args.pDst[3] = planes == 4 ? args.pDst[2] + dstPlane : nullptr;
+        args.DstPitch = paddedWidth;
+        args.Width = width;
+        args.Height = height;
+        args.Peak = CasAsFloat(view.pConsts->Const1[0]);
+        if (!sharpenOnly)
+        {
+            args.pColumn = scratch.Index.data();
+            args.pRow = args.pColumn + paddedWidth;
+            args.pColumnFrac = scratch.Frac.data();
+            args.pRowFrac = args.pColumnFrac + paddedWidth;
+        }
+
+        if (view.Contrast)
+        {
+            MeasureContrast(args, sharpenOnly, view, dstX, dstY, scratch);
+        }
+
+        const CAS_KernelTable* pKernels = CAS_GetKernelTable(m_tier);
+        CAS_KernelFn kernel = (sharpenOnly ? pKernels->SharpenOnly : pKernels->Upsample)[view.Channels - 1][m_precision][m_variant];
+
+        // Alpha is not sharpened, it takes the center texel or the bilinear blend of the same window and weights.
+        if (view.Alpha)
+        {
+            (sharpenOnly ? pKernels->SharpenAlpha : pKernels->UpsampleAlpha)[m_precision](args);
+        }
+
+        // Classify the 8x8 blocks of the tile. Tiles are multiples of 8, so the blocks are on one grid over the frame.
+        uint32_t classCount[CasBlock_Count] = {};
+        const bool classify = m_classify && view.Channels == 3;
+        if (classify || mapped)
+        {
+            const bool allChannels = (m_variant & CAS_Variant_Slow) != 0;
+            scratch.Classes.resize(blocksX * blocksY);
+            for (uint32_t by = 0; by < blocksY; ++by)
+            {
+                for (uint32_t bx = 0; bx < blocksX; ++bx)
+                {
+                    if (mapped && scratch.Strength[by * blocksX + bx] <= 0.0f)
+                    {
+                        scratch.Classes[by * blocksX + bx] = static_cast<uint8_t>(CasBlock_Skip);
+                        ++classCount[CasBlock_Skip];
+                        continue;
+                    }
+                    if (!classify)
+                    {
+                        scratch.Classes[by * blocksX + bx] = static_cast<uint8_t>(CasBlock_Textured);
+                        ++classCount[CasBlock_Textured];
+                        continue;
+                    }
+
+                    const uint32_t x0 = bx * 8, y0 = by * 8;
+                    const uint32_t x1 = std::min(x0 + 8, width), y1 = std::min(y0 + 8, height);
+                    int32_t srcX0, srcX1, srcY0, srcY1;
+                    if (sharpenOnly)
+                    {
+                        srcX0 = static_cast<int32_t>(x0); srcX1 = static_cast<int32_t>(x1) + 2;
+                        srcY0 = static_cast<int32_t>(y0); srcY1 = static_cast<int32_t>(y1) + 2;
+                    }
+                    else
+                    {
+                        srcX0 = args.pColumn[x0] - 1; srcX1 = args.pColumn[x1 - 1] + 3;
+                        srcY0 = args.pRow[y0] - 1; srcY1 = args.pRow[y1 - 1] + 3;
+                    }
+
+                    CAS_BlockStats stats;
+                    pKernels->BlockStats[m_precision](pSrc, srcPitch, srcX0, srcX1, srcY0, srcY1, m_flatThreshold, stats);
+                    const bool flat = stats.Range <= m_flatThreshold;
+                    const bool saturated = (allChannels ? stats.Unsaturated : stats.UnsaturatedG) <= 0.0f;
+                    const CasBlockClass blockClass = flat ? CasBlock_Flat : saturated ? CasBlock_Saturated : CasBlock_Textured;
+                    scratch.Classes[by * blocksX + bx] = static_cast<uint8_t>(blockClass);
+                    ++classCount[blockClass];
+                }
+            }
+        }
+
+        if (classCount[CasBlock_Flat] + classCount[CasBlock_Saturated] + classCount[CasBlock_Skip] == 0 && uniformStrength)
+        {
+            // The map scales the negative lobe, 1 is the sharpness given to UpdateSharpness().
+            args.Peak *= mapped ? scratch.Strength[0] : 1.0f;
+            kernel(args);
+        }
+        else
+        {
+            CAS_KernelFn classKernel[CasBlock_Count];
+            classKernel[CasBlock_Textured] = kernel;
+            classKernel[CasBlock_Flat] = sharpenOnly ? pKernels->SharpenFlat[m_precision][m_variant] : pKernels->UpsampleFlat[m_precision][m_variant];
+            classKernel[CasBlock_Saturated] = sharpenOnly ? pKernels->SharpenSaturated[m_precision][m_variant] : pKernels->UpsampleSaturated[m_precision][m_variant];
+            classKernel[CasBlock_Skip] = sharpenOnly ? pKernels->SharpenCopy[m_precision] : pKernels->UpsampleBilinear[m_precision];
+            const size_t texelSize = m_precision == CAS_Precision_FP32 ? sizeof(float) : sizeof(uint16_t);
+
+            // One class after the other, so each kernel runs over its own blocks back to back. Horizontal runs of
+            // blocks of a class (and map strength) are merged into a single call.
+            for (uint32_t blockClass = 0; blockClass < CasBlock_Count; ++blockClass)
+            {
+                for (uint32_t by = 0; by < blocksY && classCount[blockClass] != 0; ++by)
+                {
+                    const uint8_t* pClasses = scratch.Classes.data() + by * blocksX;
+                    const float* pStrength = mapped ? scratch.Strength.data() + by * blocksX : nullptr;
+                    for (uint32_t bx = 0; bx < blocksX; ++bx)
+                    {
+                        if (pClasses[bx] != blockClass)
+                        {
+                            continue;
+                        }
+                        // Without a threshold a flat block is a single color and so is its sharpened output, filter one
+                        // pixel and fill the block with it.
+                        const bool fill = sharpenOnly && blockClass == CasBlock_Flat && m_flatThreshold <= 0.0f;
+                        uint32_t runEnd = bx + 1;
+                        while (!fill && runEnd < blocksX && pClasses[runEnd] == blockClass && (!pStrength || pStrength[runEnd] == pStrength[bx]))
+                        {
+                            ++runEnd;
+                        }
+
+                        const uint32_t x0 = bx * 8, y0 = by * 8;
+                        CAS_TileArgs blockArgs = args;
+                        blockArgs.Width = std::min(runEnd * 8, width) - x0;
+                        blockArgs.Height = std::min(y0 + 8, height) - y0;
+                        blockArgs.Peak *= pStrength ? pStrength[bx] : 1.0f;
+                        for (uint32_t c = 0; c < 3; ++c)
+                        {
+                            blockArgs.pDst[c] = args.pDst[c] + y0 * paddedWidth + x0;
+                        }
+                        if (sharpenOnly)
+                        {
+                            for (uint32_t c = 0; c < 3; ++c)
+                            {
+                                blockArgs.pSrc[c] = static_cast<const uint8_t*>(args.pSrc[c]) + (static_cast<size_t>(y0) * srcPitch + x0) * texelSize;
+                            }
+                        }
+                        else
+                        {
+                            blockArgs.pColumn = args.pColumn + x0;
+                            blockArgs.pColumnFrac = args.pColumnFrac + x0;
+                            blockArgs.pRow = args.pRow + y0;
+                            blockArgs.pRowFrac = args.pRowFrac + y0;
+                        }
+                        if (fill)
+                        {
+                            const uint32_t fillWidth = blockArgs.Width, fillHeight = blockArgs.Height;
+                            blockArgs.Width = 1;
+                            blockArgs.Height = 1;
+                            classKernel[blockClass](blockArgs);
+                            for (uint32_t c = 0; c < 3; ++c)
+                            {
+                                const float value = blockArgs.pDst[c][0];
+                                for (uint32_t y = 0; y < fillHeight; ++y)
+                                {
+                                    std::fill(blockArgs.pDst[c] + y * paddedWidth, blockArgs.pDst[c] + y * paddedWidth + fillWidth, value);
+                                }
+                            }
+                        }
+                        else
+                        {
+                            classKernel[blockClass](blockArgs);
+                        }
+
+                        classCount[blockClass] -= runEnd - bx;
+                        bx = runEnd - 1;
+                    }
+                }
+            }
+        }
+
+        // A single channel is stored as gray to wider outputs, two leave blue at 0.
+        float* pDstG = view.Channels == 1 ? args.pDst[0] : args.pDst[1];
+        float* pDstB = view.Channels == 1 ? args.pDst[0] : args.pDst[2];
+        for (uint32_t y = writeY0; y < writeY1; ++y)
+        {
+            const size_t offset = static_cast<size_t>(y - dstY) * paddedWidth + (writeX0 - dstX);
+            if (view.Channels == 2)
+            {
+                std::fill(pDstB + offset, pDstB + offset + writeWidth, 0.0f);
+            }
+            const CasOverlayRow overlay = CasDecodeOverlayRow(pOverlay, y, writeX0, writeWidth, scratch.Overlay);
+            CasEncodeOutputRow(output, view.pTargets, view.TargetCount, view.pOutputTransform, overlay, y - view.Region.Y, outputX, writeWidth,
+                               args.pDst[0] + offset, pDstG + offset, pDstB + offset, args.pDst[3] ? args.pDst[3] + offset : nullptr);
+            if (view.Measured)
+            {
+                MeasureRow(*scratch.pStatistics, args.pDst[0] + offset, pDstG + offset, pDstB + offset, writeWidth);
+            }
+        }
+    }
+
+    //==============================================================================================================
+    // Resolutions
+    //==============================================================================================================
+    static const ResolutionInfo s_CommonResolutions[] =
+    {
+        { "480p", 640, 480 },
+        { "720p", 1280, 720 },
+        { "1080p", 1920, 1080 },
+        { "1440p", 2560, 1440 },
+    };
+
+    void CAS_Filter::GetCommonResolutions(std::vector<ResolutionInfo>& list)
+    {
+        list.assign(std::begin(s_CommonResolutions), std::end(s_CommonResolutions));
+    }
+
+    void CAS_Filter::GetSupportedResolutions(uint32_t displayWidth, uint32_t displayHeight, std::vector<ResolutionInfo>& supportedList)
+    {
+        // Check which of the fixed resolutions we support rendering to with CAS enabled
+        for (const ResolutionInfo& currResolution : s_CommonResolutions)
+        {
+            if (CasSupportScaling(static_cast<AF1>(displayWidth), static_cast<AF1>(displayHeight), static_cast<AF1>(currResolution.Width), static_cast<AF1>(currResolution.Height)) &&
+                currResolution.Width < displayWidth && currResolution.Height < displayHeight)
+            {
+                supportedList.push_back(currResolution);
+            }
+        }
+
+        // Also add the display res as a supported render resolution
+        ResolutionInfo displayResInfo = {};
+        displayResInfo.pName = "Display Res";
+        displayResInfo.Width = displayWidth;
+        displayResInfo.Height = displayHeight;
+        supportedList.push_back(displayResInfo);
+    }
+}
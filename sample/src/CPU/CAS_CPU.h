@@ -0,0 +1,556 @@
+//CAS Sample
+//
+// Copyright(c) 2019 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "CAS_ThreadPool.h"
+
+namespace CAS_SAMPLE_CPU
+{
+    enum CAS_State
+    {
+        CAS_State_NoCas,
+        CAS_State_Upsample,
+        CAS_State_SharpenOnly,
+    };
+
+    // Instruction set used by the filter kernels.
+    enum CAS_Tier
+    {
+        CAS_Tier_Scalar,
+        CAS_Tier_SSE2,
+        CAS_Tier_AVX2,
+        CAS_Tier_Count,
+    };
+
+    // The compile-time options of ffx_cas.h, as flags so every combination can be picked at runtime.
+    enum CAS_Variant
+    {
+        CAS_Variant_Default         = 0,
+        CAS_Variant_BetterDiagonals = 1 << 0, // CAS_BETTER_DIAGONALS
+        CAS_Variant_Slow            = 1 << 1, // CAS_SLOW
+        CAS_Variant_GoSlower        = 1 << 2, // CAS_GO_SLOWER
+        CAS_Variant_Count           = 1 << 3,
+    };
+
+    // Storage of the source window the kernels read, the filter math is FP32 for all of them. FP16 mirrors the input
+    // precision of the packed math shaders (CAS_SAMPLE_FP16) and Fixed16 stores UNORM16, both halve the window's cache
+    // footprint at the cost of quantizing the input.
+    enum CAS_Precision
+    {
+        CAS_Precision_FP32,
+        CAS_Precision_FP16,
+        CAS_Precision_Fixed16,
+        CAS_Precision_Count,
+    };
+
+    // Order the tiles of a frame are handed to the threads. Neighbouring tiles share their halo rows and columns, Morton
+    // (Z) order keeps them close in time so those source lines are more likely to still be in cache.
+    enum CAS_Traversal
+    {
+        CAS_Traversal_RowMajor,
+        CAS_Traversal_ColumnMajor,
+        CAS_Traversal_Morton,
+        CAS_Traversal_Count,
+    };
+
+    // Filter that shrinks the input by an integer factor before CAS, see CAS_Filter::SetReduction().
+    enum CAS_Reduction
+    {
+        CAS_Reduction_None,
+        CAS_Reduction_Box,
+        CAS_Reduction_Tent,
+        CAS_Reduction_Count,
+    };
+
+    // Interleaved pixel formats, alpha is ignored on load and written as 1 on store. The one and two channel formats are
+    // filtered as such (luma, grayscale, luma and alpha), see CAS_Filter::GetFormatChannels().
+    enum CAS_Format
+    {
+        CAS_Format_RGBA32F,
+        CAS_Format_RGBA16F,
+        CAS_Format_RGBA8,
+        CAS_Format_R10G10B10A2,         // UNORM packed in 32 bits, red in the low bits (the HDR10 swap chain format).
+        CAS_Format_R32F,
+        CAS_Format_RG32F,
+        CAS_Format_R8,
+        CAS_Format_RG8,
+        CAS_Format_Count,
+    };
+
+    // Transfer function applied to the linear filter result when it is stored.
+    enum CAS_Transfer
+    {
+        CAS_Transfer_Linear,
+        CAS_Transfer_sRGB,
+        CAS_Transfer_PQ,                // SMPTE ST 2084 for HDR10, see CAS_Target::MaxNits.
+        CAS_Transfer_Count,
+    };
+
+    struct ResolutionInfo
+    {
+        const char* pName;
+        uint32_t Width;
+        uint32_t Height;
+    };
+
+    struct CASConstants
+    {
+        uint32_t Const0[4];
+        uint32_t Const1[4];
+    };
+
+    struct CAS_Profile;
+    struct CAS_Schedule;
+    struct CAS_TileArgs;
+    class CAS_ColorTransform;
+
+    struct CAS_Image
+    {
+        void           *pData;
+        uint32_t        Width;
+        uint32_t        Height;
+        uint32_t        RowPitch;       // In bytes.
+        CAS_Format      Format;
+    };
+
+    struct CAS_Rect
+    {
+        uint32_t        X;
+        uint32_t        Y;
+        uint32_t        Width;
+        uint32_t        Height;
+    };
+
+    // One output of CAS_Filter::UpscaleMulti(), any size with its own sharpness.
+    struct CAS_Output
+    {
+        CAS_Image       Image;
+        float           Sharpness;
+    };
+
+    // Quantization of an RGBA8 or R10G10B10A2 target. Rounding to nearest bands on smooth gradients that the sharpening
+    // makes more visible, dithering rounds by a per pixel threshold instead: an 8x8 Bayer matrix or a 64x64 blue noise
+    // (void and cluster) pattern, which has no visible structure.
+    enum CAS_Dither
+    {
+        CAS_Dither_None,
+        CAS_Dither_Ordered,
+        CAS_Dither_BlueNoise,
+        CAS_Dither_Count,
+    };
+
+    // One encoding of the output of CAS_Filter::UpscaleTargets(), all targets are the output size.
+    struct CAS_Target
+    {
+        CAS_Image       Image;
+        CAS_Transfer    Transfer;
+        float           MaxNits;        // PQ: nits of the linear value 1, where the display clips (0 for 10000).
+        CAS_Dither      Dither;         // 8 and 10-bit targets.
+        float           Grain;          // Film grain added after CAS as ffx_cas.h suggests, 8 and 10-bit targets: monochrome
+                                        // noise of up to this fraction of full scale, in the encoded values.
+        uint32_t        Seed;           // Per frame, moves the dither pattern and the grain.
+    };
+
+    // Luminance of the pixels a call wrote, see CAS_Filter::SetStatistics(). Luminance is the Rec. 709 weighted sum of
+    // the linear result (after the output transform, before a target's transfer function).
+    struct CAS_Statistics
+    {
+        static const uint32_t BinCount = 64;
+
+        uint32_t        Histogram[BinCount];    // Equal bins of log2 luminance from MinLog2 to MaxLog2, the first and last
+        float           MinLog2;                // also count everything below and above.
+        float           MaxLog2;
+        float           Min;
+        float           Max;
+        float           Mean;
+        uint64_t        Count;
+    };
+
+    // One block of the contrast map, see CAS_Filter::SetContrastMap(). Both are means over the block's pixels of what
+    // CAS measures around them on green: the soft max - min of the 3x3 neighborhood, and the amplitude of the negative
+    // lobe before the sharpness scales it (sqrt(min(min, 1 - max) / max), 0 on edges and saturated texels, 1 on flat
+    // content). Scaling blends the 4 neighborhoods of a pixel bilinearly.
+    struct CAS_BlockContrast
+    {
+        float           Contrast;
+        float           Amplitude;
+    };
+
+    //
+    // CPU port of the CAS compute shader.
+    // The output is split into tiles which are spread over a thread pool. For every tile the source footprint (plus the
+    // filter halo, clamped at the image edges) is converted once into planar rows of the selected precision, the kernel
+    // for the selected tier and variant runs on those rows and the result is converted to the output format.
+    //
+    class CAS_Filter
+    {
+    public:
+        // threadCount 0 uses every hardware thread, tier CAS_Tier_Count picks the best one the CPU supports.
+        void OnCreate(uint32_t threadCount = 0, CAS_Tier tier = CAS_Tier_Count);
+        void OnDestroy();
+
+        void OnCreateWindowSizeDependentResources(uint32_t renderWidth, uint32_t renderHeight, uint32_t Width, uint32_t Height, CAS_State CASState);
+        void OnDestroyWindowSizeDependentResources();
+
+        // The input is render sized, the output is display sized for CAS_State_Upsample and render sized for CAS_State_SharpenOnly.
+        void Upscale(const CAS_Image& input, const CAS_Image& output, CAS_State casState);
+
+        // Upscale() into several encodings of the same output at once, for example an RGBA16F working buffer and an sRGB
+        // RGBA8 preview. Every tile is filtered once and written to all targets, without reading the output back to
+        // convert it.
+        void UpscaleTargets(const CAS_Image& input, const CAS_Target* pTargets, uint32_t targetCount, CAS_State casState);
+
+        // Incremental variants of Upscale() for frames that mostly repeat the previous one (see CAS_Incremental.cpp). The
+        // output must still hold the previous result, only tiles whose footprint (their input plus the filter halo)
+        // changed are filtered again. Both return the number of tiles filtered.
+        // Damage rectangles are in input pixels. The caller is responsible for the output being valid for the current
+        // settings, after a sharpness or kernel change use Upscale().
+        uint32_t UpscaleDamaged(const CAS_Image& input, const CAS_Image& output, CAS_State casState, const CAS_Rect* pDamage, uint32_t damageCount);
+        // Finds the changed tiles by hashing their footprints and comparing with the previous call. The first call, and
+        // any call after a setting, size, format or output buffer change, filters the whole frame.
+        uint32_t UpscaleChanged(const CAS_Image& input, const CAS_Image& output, CAS_State casState);
+
+        // Filters only region of the frame given to OnCreateWindowSizeDependentResources(), for frames split over
+        // machines or processes and stitched afterwards. The output image holds just the region. The input holds the
+        // input frame from texel (inputX, inputY) on and must cover GetInputRegion(), so a worker can be sent only its part
+        // of the input. The pixels are identical to the same pixels of Upscale() on the whole frame.
+        void UpscaleRegion(const CAS_Image& input, uint32_t inputX, uint32_t inputY, const CAS_Image& output, CAS_State casState, const CAS_Rect& region);
+        // Input texels UpscaleRegion() reads for an output region: its 8x8 blocks plus the filter halo, clamped to the frame.
+        CAS_Rect GetInputRegion(const CAS_Rect& region, CAS_State casState) const;
+
+        // Filters the frame into several outputs (a delivery ladder such as 4K, 1440p and 1080p) in one walk over the
+        // input, decoding every source tile once for all of them (see CAS_Multi.cpp). Every output gets the CasSetup()
+        // constants of its size and sharpness, one of the source size is sharpened, and matches Upscale() into it alone.
+        // Outputs beyond CAS_AREA_LIMIT need a cascade, which this does not run: they are left untouched, unless
+        // SetCascade(false) allows a single pass. Returns the number of outputs written.
+        uint32_t UpscaleMulti(const CAS_Image& input, const CAS_Output* pOutputs, uint32_t outputCount);
+        // Sharpened mip chain: level i is GetMipSize() of the source size (after any reduction). Level 0 is the source
+        // sharpened. Every further level is derived from the one before: the unsharpened previous level is halved by a
+        // pass that only scales (each texel a contrast weighted mean of its 2x2 footprint), and the result sharpened.
+        void BuildMipChain(const CAS_Image& input, const CAS_Image* pLevels, uint32_t levelCount, float sharpness);
+        static uint32_t GetMipSize(uint32_t size, uint32_t level) { return (size >> level) > 0 ? size >> level : 1; }
+
+        void UpdateSharpness(float sharpenControl, CAS_State CASState);
+
+        void SetTier(CAS_Tier tier);
+        void SetVariant(uint32_t variant) { m_variant = variant % CAS_Variant_Count; }
+        void SetPrecision(CAS_Precision precision) { m_precision = precision < CAS_Precision_Count ? precision : CAS_Precision_FP32; }
+        // Rounded up to multiples of 8 so the classification blocks stay on one grid over the whole frame.
+        void SetTileSize(uint32_t width, uint32_t height);
+        // Classify 8x8 blocks as flat, saturated or textured and only run the full filter on textured ones (on by default).
+        // Flat blocks have every channel constant to within flatThreshold over their source footprint and get a cheap
+        // copy, saturated blocks (texels all 0 or >= 1) have zero lobe weights. With the default threshold of 0 the output
+        // matches the full kernels in the Scalar and SSE2 tiers. In the AVX2 tier the multiply-adds contract into FMA
+        // differently, so whenever classification is on the output differs in the last bits (a few ulp) on flat and
+        // saturated blocks; CAS_Bench --no-classify reports it. A larger threshold trades accuracy for speed on nearly
+        // flat content.
+        void SetClassification(bool enable, float flatThreshold = 0.0f) { m_classify = enable; m_flatThreshold = flatThreshold; }
+        // Spatially varying sharpening, for foveated output, UI exclusion or subject weighting. The map covers the output
+        // with one value per 8x8 block at full size, a smaller map is sampled nearest. A value scales the negative lobe
+        // of the sharpness given to UpdateSharpness(), 1 is the full effect and 0 switches CAS off for the block: a copy
+        // when sharpening, bilinear when scaling, without the filter math. nullptr removes the map.
+        void SetSharpnessMap(const float* pMap, uint32_t mapWidth, uint32_t mapHeight);
+        // Up-sampling beyond CAS_AREA_LIMIT (720p or 540p to 4K) runs as a chain of CAS passes each within the limit, see
+        // CAS_Cascade.cpp. Fused (the default) filters the whole chain one output tile at a time with the intermediate
+        // regions in per thread scratch, unfused stores every intermediate image between passes. Only the last pass
+        // sharpens, the ones before it only scale (no negative lobe). Disabling it filters in one pass whatever the ratio.
+        void SetCascade(bool enable, bool fused = true) { m_cascadeEnabled = enable; m_cascadeFused = fused; }
+        // Reduces the input by factor in the same pass as CAS, for supersampling resolves (2x2 box) and thumbnails: the
+        // render size is the input and CAS filters it as if it were ceil(render size / factor), so the output is that
+        // size when sharpening. Box averages factor x factor texels, tent weights twice as many with a triangle for less
+        // aliasing. Call UpdateSharpness() or OnCreateWindowSizeDependentResources() after it. Widens the tiles to read
+        // the input in longer runs, without changing the tile size that was set (GetTileWidth()).
+        void SetReduction(CAS_Reduction reduction, uint32_t factor);
+        // Color transforms fused into the filter (see CAS_ColorChain.h), nullptr for none. The input transform runs on the
+        // decoded source texels before CAS (after the reduction, in the first pass of a cascade), the output transform on
+        // the filtered pixels before they are stored (before a target's transfer function, in the last pass). The filter
+        // keeps the pointers. UpscaleChanged() only notices a different transform, not new parameters of the same one.
+        // Output values outside [0, 1] are kept by the float formats and saturated by the UNORM ones.
+        void SetColorTransforms(const CAS_ColorTransform* pInput, const CAS_ColorTransform* pOutput) { m_inputTransform = pInput; m_outputTransform = pOutput; }
+        // Luminance histogram, min, max and mean of the output gathered while Upscale(), UpscaleTargets() and
+        // UpscaleRegion() store it, for auto-exposure and analytics without reading the frame back (see
+        // CAS_Statistics.cpp). The histogram covers log2 luminance from minLog2 to maxLog2, at least 1 apart.
+        void SetStatistics(bool enable, float minLog2 = -10.0f, float maxLog2 = 6.0f);
+        // Statistics of the last call that gathered them.
+        const CAS_Statistics& GetStatistics() const { return m_statistics; }
+        // Per block contrast of the output written by Upscale(), UpscaleTargets() and UpscaleRegion() from the source
+        // window they already read, for adaptive quantization in video encoders and sharpening metrics (see
+        // CAS_Contrast.cpp). The map has GetContrastMapWidth() x GetContrastMapHeight() blocks of the output frame,
+        // row-major, blockSize is 8 or 16. UpscaleRegion() writes the blocks its region touches, with 16x16 blocks a
+        // region off that grid leaves the straddled ones mixed with earlier calls. The filter keeps the pointer, nullptr
+        // removes the map.
+        void SetContrastMap(CAS_BlockContrast* pMap, uint32_t blockSize = 16);
+        uint32_t GetContrastMapWidth(uint32_t width) const { return (width + m_contrastBlockSize - 1) / m_contrastBlockSize; }
+        uint32_t GetContrastMapHeight(uint32_t height) const { return (height + m_contrastBlockSize - 1) / m_contrastBlockSize; }
+        // Premultiplied alpha overlay (UI) the size of the output frame, composited over the result of Upscale(),
+        // UpscaleTargets() and UpscaleRegion() before it is stored: rgb * (1 - a) + overlay, after the output transform
+        // and before a target's transfer function. Tiles where the overlay is all zero are not blended. The filter keeps
+        // the pointer, nullptr removes the overlay, and one smaller than the frame is ignored.
+        void SetOverlay(const CAS_Image* pOverlay) { m_pOverlay = pOverlay; }
+        // Writes the source alpha to the output instead of 1: the center texel's when sharpening, bilinear from the same
+        // taps and weights when scaling (reduced like the color with SetReduction()). Alpha is decoded with the source
+        // window and stored linear, without a transfer function or dither. Off by default.
+        void SetAlphaPassThrough(bool enable) { m_alphaPassThrough = enable; }
+        // Sharpens and scales the alpha of 4 channel inputs like the color, with its own lobe weights only under
+        // CAS_Variant_Slow. Takes precedence over SetAlphaPassThrough(). Off by default.
+        void SetSharpenAlpha(bool enable) { m_sharpenAlpha = enable; }
+        void SetTraversal(CAS_Traversal traversal) { m_traversal = traversal < CAS_Traversal_Count ? traversal : CAS_Traversal_RowMajor; }
+        // Recreates the thread pool, 0 uses every hardware thread. Not to be called while Upscale() runs.
+        void SetThreadCount(uint32_t threadCount);
+
+        // Applies the tier, variant and precision picked by CAS_Tune. A tier the CPU lacks falls back to the best one.
+        void ApplyProfile(const CAS_Profile& profile);
+        bool LoadProfile(const char* pPath);
+
+        // Tile size, thread count and traversal for this host (see CAS_Schedule.cpp). The sizes and state are the ones
+        // given to OnCreateWindowSizeDependentResources().
+        void ApplySchedule(const CAS_Schedule& schedule);
+        // Applies the cached schedule of this CPU model and resolution, false when there is none.
+        bool LoadSchedule(const char* pCachePath, CAS_State casState);
+        // Times the candidate settings on these images, applies the fastest and returns it. The output is valid afterwards.
+        CAS_Schedule TuneSchedule(const CAS_Image& input, const CAS_Image& output, CAS_State casState);
+        // First run helper: LoadSchedule(), or TuneSchedule() and add the result to the cache. Call it before Upscale().
+        void AutotuneSchedule(const char* pCachePath, const CAS_Image& input, const CAS_Image& output, CAS_State casState);
+
+        CAS_Tier GetTier() const { return m_tier; }
+        uint32_t GetVariant() const { return m_variant; }
+        CAS_Precision GetPrecision() const { return m_precision; }
+        CAS_Traversal GetTraversal() const { return m_traversal; }
+        uint32_t GetTileWidth() const { return m_tileWidth; }
+        uint32_t GetTileHeight() const { return m_tileHeight; }
+        uint32_t GetThreadCount() const { return m_threadPool.GetThreadCount(); }
+        CAS_Reduction GetReduction() const { return m_reduction; }
+        // Size CAS filters from, the render size after the reduction.
+        uint32_t GetSourceWidth() const { return m_sourceWidth; }
+        uint32_t GetSourceHeight() const { return m_sourceHeight; }
+        // Passes Upscale() runs in CAS_State_Upsample, more than 1 beyond CAS_AREA_LIMIT.
+        uint32_t GetCascadePassCount() const { return UseCascade(false) ? static_cast<uint32_t>(m_cascade.size()) : 1; }
+
+        static bool IsTierSupported(CAS_Tier tier);
+        static CAS_Tier GetBestTier();
+        static const char* GetTierName(CAS_Tier tier);
+        static std::string GetVariantName(uint32_t variant);
+        static const char* GetPrecisionName(CAS_Precision precision);
+        static const char* GetTraversalName(CAS_Traversal traversal);
+        static const char* GetReductionName(CAS_Reduction reduction);
+        static const char* GetTransferName(CAS_Transfer transfer);
+        static const char* GetDitherName(CAS_Dither dither);
+        // CPU brand string, the key of the schedule cache.
+        static std::string GetCpuName();
+        static uint32_t GetFormatSize(CAS_Format format);
+        // Channels a format stores, 1, 2 or 4. The filter runs on as many as the input has: one and two channel inputs
+        // take the kernels for that count, with the weights from the first channel, and stores to a wider output
+        // replicate a single channel to RGB or leave blue at 0. Classification, the sharpness map, the contrast map, the
+        // overlay and the color transforms need RGB and are skipped for them.
+        static uint32_t GetFormatChannels(CAS_Format format);
+
+        // Converts one texel of any supported format to float RGB, the same conversion the filter applies to its input.
+        static void LoadPixel(const CAS_Image& image, uint32_t x, uint32_t y, float& r, float& g, float& b);
+
+        static void GetCommonResolutions(std::vector<ResolutionInfo>& list);
+        static void GetSupportedResolutions(uint32_t displayWidth, uint32_t displayHeight, std::vector<ResolutionInfo>& supportedList);
+
+    private:
+        // Source window UpscaleMulti() decoded for all outputs of a source tile, ProcessTile() reads from it when it covers
+        // the tile's window.
+        struct SharedWindow
+        {
+            bool                        Valid;
+            int32_t                     X;
+            int32_t                     Y;
+            uint32_t                    Width;
+            uint32_t                    Height;
+            uint32_t                    Pitch;
+            const void                 *pPlanes[4];
+        };
+
+        // Statistics of one work item, merged in work item order so the mean does not depend on the threads.
+        struct TileStatistics
+        {
+            float                       Min;
+            float                       Max;
+            double                      Sum;
+            uint32_t                    Histogram[CAS_Statistics::BinCount];
+        };
+
+        struct ThreadScratch
+        {
+            std::vector<float>          Source;
+            std::vector<uint16_t>       Source16;
+            std::vector<float>          Output;
+            std::vector<int32_t>        Index;
+            std::vector<float>          Frac;
+            std::vector<uint8_t>        Classes;
+            std::vector<float>          Strength;
+            std::vector<float>          Cascade[2];         // Intermediate regions of a fused cascade, RGBA32F.
+            std::vector<CAS_Rect>       CascadeRects;
+            std::vector<float>          Reduce;             // Input row of a reduced source row.
+            std::vector<float>          Window;             // Storage of Shared.
+            std::vector<uint16_t>       Window16;
+            std::vector<float>          Contrast;           // Per pixel contrast and amplitude planes of the tile.
+            std::vector<float>          Overlay;            // Overlay row, planar RGBA.
+            SharedWindow                Shared = {};
+            TileStatistics             *pStatistics = nullptr; // Partial of the work item the thread runs.
+        };
+
+        // One pass of an up-sampling cascade, from the previous pass's size (the reduced render size for the first) to its own.
+        struct CascadePass
+        {
+            uint32_t                    Width;
+            uint32_t                    Height;
+            CASConstants                Consts;
+        };
+
+        // Where the images of a call sit in the frame. Upscale() covers the whole frame, UpscaleRegion() a window of it.
+        struct FrameView
+        {
+            uint32_t                    Width;              // Output frame, the tiles and 8x8 blocks are on its grid.
+            uint32_t                    Height;
+            uint32_t                    SourceWidth;        // Input frame, reads clamp to its edges.
+            uint32_t                    SourceHeight;
+            uint32_t                    InputWidth;         // Frame the input image is part of, larger than the source
+            uint32_t                    InputHeight;        // when reduced.
+            bool                        Reduced;            // Reduce the input, the first pass of a cascade only.
+            uint32_t                    InputX;             // Frame position of the first texel of the input image.
+            uint32_t                    InputY;
+            CAS_Rect                    Region;             // Output pixels written, the output image starts at its corner.
+            CAS_Rect                    Grid;               // Tiled area, the region widened to whole 8x8 blocks.
+            const CASConstants         *pConsts;
+            bool                        Mapped;             // Apply the sharpness map, the last pass of a cascade only.
+            const CAS_Target           *pTargets;           // Written instead of the output when there are, the last
+            uint32_t                    TargetCount;        // pass of a cascade only.
+            const CAS_ColorTransform   *pInputTransform;    // First pass only.
+            const CAS_ColorTransform   *pOutputTransform;   // Last pass only.
+            bool                        Measured;           // Gather statistics, last pass only.
+            bool                        Contrast;           // Write the contrast map, last pass only.
+            const CAS_Image            *pOverlay;           // Composited before the store, last pass only.
+            bool                        Alpha;              // Pass the source alpha through, every pass.
+            uint32_t                    Channels;           // Filtered planes, 1 to 4 (RGB and alpha), every pass.
+        };
+
+        void ProcessTile(const CAS_Image& input, const CAS_Image& output, const FrameView& view, bool sharpenOnly, uint32_t tileIndex, ThreadScratch& scratch);
+        // ProcessTile(), or the whole cascade for the tile.
+        void ProcessFrameTile(const CAS_Image& input, const CAS_Image& output, const FrameView& view, bool sharpenOnly, uint32_t tileIndex, ThreadScratch& scratch);
+        // The whole cascade for an 8x8 aligned rect of the last pass's grid, a single tile or a group of them.
+        void ProcessCascadeTile(const CAS_Image& input, const CAS_Image& output, const FrameView& view, const CAS_Rect& tile, ThreadScratch& scratch);
+        void RunFrame(const CAS_Image& input, const CAS_Image& output, const FrameView& view, bool sharpenOnly);
+        void RunCascadeStored(const CAS_Image& input, const CAS_Image& output, const FrameView& view);
+        // Decodes rect of the view's source, and 2 texels around it for the windows of tiles at the frame edge, into scratch.Shared.
+        void DecodeSharedWindow(const CAS_Image& input, const FrameView& view, const CAS_Rect& rect, ThreadScratch& scratch) const;
+        static void SetupConstants(CASConstants& consts, float sharpness, uint32_t sourceWidth, uint32_t sourceHeight, uint32_t width, uint32_t height);
+        // Constants of a pass that scales without sharpening, the intermediate passes of a cascade and the mip chain.
+        static void SetupScaleConstants(CASConstants& consts, uint32_t sourceWidth, uint32_t sourceHeight, uint32_t width, uint32_t height);
+        // Within CAS_AREA_LIMIT (CasSupportScaling()).
+        static bool IsScalingSupported(uint32_t sourceWidth, uint32_t sourceHeight, uint32_t width, uint32_t height);
+        FrameView GetFullFrameView(const CAS_Image& input, const CAS_Image& output) const;
+        // Channels of a view of input in that format, and the RGB only settings turned off when there are fewer.
+        void SetViewChannels(FrameView& view, CAS_Format inputFormat) const;
+        bool UseCascade(bool sharpenOnly) const { return !sharpenOnly && m_cascadeEnabled && m_cascade.size() > 1; }
+
+        // Input texels the 8x8 aligned grid reads, through the whole cascade and the reduction when there are, clamped to
+        // the input frame.
+        CAS_Rect GetFootprint(const CAS_Rect& grid, bool sharpenOnly, uint32_t inputWidth, uint32_t inputHeight) const;
+        uint32_t GetReducedSize(uint32_t size) const { return (size + m_reductionFactor - 1) / m_reductionFactor; }
+        // Tile width frames run with: the set one, widened while reducing so every tile reads its input rows in runs of at
+        // least 128 source texels (short runs, each on a new page, defeat the prefetchers). m_tileWidth is left as set.
+        uint32_t GetRunTileWidth() const { return m_reductionFactor > 1 ? std::max(m_tileWidth, (128 * m_reductionFactor + 7) & ~7u) : m_tileWidth; }
+        // Region of every cascade pass's input the grid of the last pass needs, rects[0] in the input.
+        void GetCascadeFootprints(const CAS_Rect& grid, std::vector<CAS_Rect>& rects) const;
+        static CAS_Rect GetPassFootprint(const CAS_Rect& grid, const CASConstants& consts, bool sharpenOnly, uint32_t sourceWidth, uint32_t sourceHeight);
+        // The region clipped to the frame and widened to whole 8x8 blocks.
+        static CAS_Rect GetBlockGrid(const CAS_Rect& region, uint32_t frameWidth, uint32_t frameHeight);
+        void UpdateTileOrder(uint32_t tilesX, uint32_t tilesY);
+        // Adds the luminance of a stored row to a partial.
+        void MeasureRow(TileStatistics& statistics, const float* pR, const float* pG, const float* pB, uint32_t count) const;
+        // Cleared partials for the work items of a run when gathering statistics, nullptr otherwise. EndStatistics()
+        // merges them into m_statistics after the run.
+        TileStatistics* BeginStatistics(uint32_t itemCount);
+        void EndStatistics();
+        // Sums the contrast of a tile's pixels into its 8x8 blocks of m_contrastBlocks.
+        void MeasureContrast(const CAS_TileArgs& args, bool sharpenOnly, const FrameView& view, uint32_t dstX, uint32_t dstY, ThreadScratch& scratch);
+        // Writes the mean of the blocks of the view's grid into the map.
+        void EndContrastMap(const FrameView& view);
+        uint32_t RunTiles(const CAS_Image& input, const CAS_Image& output, CAS_State casState, const uint8_t* pDirty);
+
+        CAS_ThreadPool                  m_threadPool;
+        std::vector<ThreadScratch>      m_scratch;
+
+        CAS_Tier                        m_tier = CAS_Tier_Scalar;
+        uint32_t                        m_variant = CAS_Variant_Default;
+        CAS_Precision                   m_precision = CAS_Precision_FP32;
+        uint32_t                        m_tileWidth = 64;
+        uint32_t                        m_tileHeight = 64;
+        CAS_Traversal                   m_traversal = CAS_Traversal_RowMajor;
+        bool                            m_classify = true;
+        float                           m_flatThreshold = 0.0f;
+        std::vector<float>              m_sharpnessMap;
+        uint32_t                        m_sharpnessMapWidth = 0;
+        uint32_t                        m_sharpnessMapHeight = 0;
+        std::vector<CascadePass>        m_cascade;
+        bool                            m_cascadeEnabled = true;
+        bool                            m_cascadeFused = true;
+        std::vector<float>              m_cascadeImages[2];
+        std::vector<float>              m_mipImages[2];     // Unsharpened levels of BuildMipChain(), ping-pong.
+        CAS_Reduction                   m_reduction = CAS_Reduction_None;
+        uint32_t                        m_reductionFactor = 1;
+        int32_t                         m_reductionStart = 0;   // First tap relative to source texel * factor.
+        std::vector<float>              m_reductionWeights;     // Per axis, the 2D weights are their products.
+        const CAS_ColorTransform       *m_inputTransform = nullptr;
+        const CAS_ColorTransform       *m_outputTransform = nullptr;
+        const CAS_Image                *m_pOverlay = nullptr;
+        bool                            m_alphaPassThrough = false;
+        bool                            m_sharpenAlpha = false;
+        bool                            m_statisticsEnabled = false;
+        CAS_Statistics                  m_statistics = {};
+        std::vector<TileStatistics>     m_tileStatistics;
+        CAS_BlockContrast              *m_pContrastMap = nullptr;
+        uint32_t                        m_contrastBlockSize = 16;
+        std::vector<CAS_BlockContrast>  m_contrastBlocks;       // Sums of every 8x8 block of the frame.
+        uint32_t                        m_histogramBase = 0;    // Float bits >> 16 of the first bucket.
+        std::vector<uint8_t>            m_histogramBuckets;     // Bin of the start of every bucket, 128 per octave.
+        float                           m_histogramEdges[CAS_Statistics::BinCount + 1] = {};
+
+        // Row-major tile index for every work item, empty for CAS_Traversal_RowMajor.
+        std::vector<uint32_t>           m_tileOrder;
+        uint32_t                        m_tileOrderX = 0;
+        uint32_t                        m_tileOrderY = 0;
+        CAS_Traversal                   m_tileOrderTraversal = CAS_Traversal_RowMajor;
+
+        // Incremental filtering: footprint hash of every tile from the previous UpscaleChanged(), empty when unknown.
+        std::vector<uint64_t>           m_tileHashes;
+        uint64_t                        m_tileHashSettings = 0;
+        std::vector<uint8_t>            m_tileDirty;
+        std::vector<uint32_t>           m_dirtyTiles;
+
+        float                           m_sharpenVal = 0.0f;
+        uint32_t                        m_renderWidth = 0;
+        uint32_t                        m_renderHeight = 0;
+        uint32_t                        m_sourceWidth = 0;
+        uint32_t                        m_sourceHeight = 0;
+        uint32_t                        m_width = 0;
+        uint32_t                        m_height = 0;
+
+        CASConstants                    m_consts = {};
+    };
+}
@@ -0,0 +1,182 @@
+//CAS Sample
+//
+// Copyright(c) 2019 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Up-sampling beyond CAS_AREA_LIMIT as a chain of CAS passes (planned in CAS_Filter::UpdateSharpness()).
+// Fused, every group of output tiles walks its footprint back through the chain: the last pass's 8x8 aligned group needs a
+// region of the previous pass's output, whose 8x8 aligned grid needs a region of the one before, down to the input.
+// The regions are then filtered forward in the thread's scratch (RGBA32F, or R32F and RG32F for one and two channels,
+// ping-pong) and only the last pass writes the output, so no intermediate image exists in full and the intermediate
+// traffic stays in cache. Neighbouring groups filter their few shared border texels twice. Unfused, every pass runs over
+// the frame into a stored intermediate.
+// Both run each pass with the constants of its whole frame and the 8x8 grid of that frame, so they give the same output.
+// The passes before the last have a peak of 0 and only scale, the last one applies the sharpness.
+
+#include "CAS_CPU.h"
+
+#include <algorithm>
+
+namespace CAS_SAMPLE_CPU
+{
+    void CAS_Filter::GetCascadeFootprints(const CAS_Rect& grid, std::vector<CAS_Rect>& rects) const
+    {
+        const uint32_t passCount = static_cast<uint32_t>(m_cascade.size());
+        rects.resize(passCount);
+        CAS_Rect need = grid;
+        for (uint32_t pass = passCount; pass-- > 0;)
+        {
+            const uint32_t sourceWidth = pass > 0 ? m_cascade[pass - 1].Width : m_sourceWidth;
+            const uint32_t sourceHeight = pass > 0 ? m_cascade[pass - 1].Height : m_sourceHeight;
+            const CAS_Rect passGrid = GetBlockGrid(need, m_cascade[pass].Width, m_cascade[pass].Height);
+            need = GetPassFootprint(passGrid, m_cascade[pass].Consts, false, sourceWidth, sourceHeight);
+            rects[pass] = need;
+        }
+    }
+
+    // Wraps intermediate storage as an RGBA32F image of the region, R32F or RG32F for one or two channels.
+    static CAS_Image CasCascadeImage(std::vector<float>& storage, const CAS_Rect& region, uint32_t channels)
+    {
+        const uint32_t texel = channels < 3 ? channels : 4;
+        const size_t size = static_cast<size_t>(region.Width) * region.Height * texel;
+        if (storage.size() < size)
+        {
+            storage.resize(size);
+        }
+        const CAS_Format format = channels == 1 ? CAS_Format_R32F : channels == 2 ? CAS_Format_RG32F : CAS_Format_RGBA32F;
+        CAS_Image image = { storage.data(), region.Width, region.Height, region.Width * texel * 4, format };
+        return image;
+    }
+
+    void CAS_Filter::ProcessCascadeTile(const CAS_Image& input, const CAS_Image& output, const FrameView& view, const CAS_Rect& tile, ThreadScratch& scratch)
+    {
+        const uint32_t tileWidth = GetRunTileWidth();
+        if (std::max(tile.X, view.Region.X) >= std::min(tile.X + tile.Width, view.Region.X + view.Region.Width) ||
+            std::max(tile.Y, view.Region.Y) >= std::min(tile.Y + tile.Height, view.Region.Y + view.Region.Height))
+        {
+            return;
+        }
+
+        std::vector<CAS_Rect>& rects = scratch.CascadeRects;
+        GetCascadeFootprints(tile, rects);
+
+        // Every pass fills the region of its output the next one reads, one tile at a time; the last one the output.
+        const uint32_t passCount = static_cast<uint32_t>(m_cascade.size());
+        CAS_Image source = input;
+        FrameView passView = {};
+        passView.InputX = view.InputX;
+        passView.InputY = view.InputY;
+        passView.SourceWidth = m_sourceWidth;
+        passView.SourceHeight = m_sourceHeight;
+        passView.InputWidth = view.InputWidth;
+        passView.InputHeight = view.InputHeight;
+        passView.Reduced = view.Reduced;
+        passView.pInputTransform = view.pInputTransform;
+        passView.Alpha = view.Alpha;
+        passView.Channels = view.Channels;
+        for (uint32_t pass = 0; pass < passCount; ++pass)
+        {
+            const bool last = (pass + 1 == passCount);
+            const CAS_Image target = last ? output : CasCascadeImage(scratch.Cascade[pass & 1], rects[pass + 1], view.Channels);
+            passView.Width = last ? view.Width : m_cascade[pass].Width;
+            passView.Height = last ? view.Height : m_cascade[pass].Height;
+            passView.Region = last ? view.Region : rects[pass + 1];
+            passView.Grid = last ? tile : GetBlockGrid(passView.Region, passView.Width, passView.Height);
+            passView.pConsts = &m_cascade[pass].Consts;
+            passView.Mapped = last && view.Mapped;
+            passView.pTargets = last ? view.pTargets : nullptr;
+            passView.TargetCount = last ? view.TargetCount : 0;
+            passView.pOutputTransform = last ? view.pOutputTransform : nullptr;
+            passView.Measured = last && view.Measured;
+            passView.Contrast = last && view.Contrast;
+            passView.pOverlay = last ? view.pOverlay : nullptr;
+
+            const uint32_t passTiles = ((passView.Grid.Width + tileWidth - 1) / tileWidth) * ((passView.Grid.Height + m_tileHeight - 1) / m_tileHeight);
+            for (uint32_t passTile = 0; passTile < passTiles; ++passTile)
+            {
+                ProcessTile(source, target, passView, false, passTile, scratch);
+            }
+
+            source = target;
+            passView.InputX = passView.Region.X;
+            passView.InputY = passView.Region.Y;
+            passView.SourceWidth = passView.InputWidth = passView.Width;
+            passView.SourceHeight = passView.InputHeight = passView.Height;
+            passView.Reduced = false;
+            passView.pInputTransform = nullptr;
+        }
+    }
+
+    void CAS_Filter::RunCascadeStored(const CAS_Image& input, const CAS_Image& output, const FrameView& view)
+    {
+        const uint32_t tileWidth = GetRunTileWidth();
+        std::vector<CAS_Rect> rects;
+        GetCascadeFootprints(view.Grid, rects);
+
+        const uint32_t passCount = static_cast<uint32_t>(m_cascade.size());
+        CAS_Image source = input;
+        FrameView passView = {};
+        passView.InputX = view.InputX;
+        passView.InputY = view.InputY;
+        passView.SourceWidth = m_sourceWidth;
+        passView.SourceHeight = m_sourceHeight;
+        passView.InputWidth = view.InputWidth;
+        passView.InputHeight = view.InputHeight;
+        passView.Reduced = view.Reduced;
+        passView.pInputTransform = view.pInputTransform;
+        passView.Alpha = view.Alpha;
+        passView.Channels = view.Channels;
+        for (uint32_t pass = 0; pass < passCount; ++pass)
+        {
+            const bool last = (pass + 1 == passCount);
+            const CAS_Image target = last ? output : CasCascadeImage(m_cascadeImages[pass & 1], rects[pass + 1], view.Channels);
+            passView.Width = last ? view.Width : m_cascade[pass].Width;
+            passView.Height = last ? view.Height : m_cascade[pass].Height;
+            passView.Region = last ? view.Region : rects[pass + 1];
+            passView.Grid = last ? view.Grid : GetBlockGrid(passView.Region, passView.Width, passView.Height);
+            passView.pConsts = &m_cascade[pass].Consts;
+            passView.Mapped = last && view.Mapped;
+            passView.pTargets = last ? view.pTargets : nullptr;
+            passView.TargetCount = last ? view.TargetCount : 0;
+            passView.pOutputTransform = last ? view.pOutputTransform : nullptr;
+            passView.Measured = last && view.Measured;
+            passView.Contrast = last && view.Contrast;
+            passView.pOverlay = last ? view.pOverlay : nullptr;
+
+            const uint32_t tilesX = (passView.Grid.Width + tileWidth - 1) / tileWidth;
+            const uint32_t tilesY = (passView.Grid.Height + m_tileHeight - 1) / m_tileHeight;
+            TileStatistics* pStatistics = passView.Measured ? BeginStatistics(tilesX * tilesY) : nullptr;
+            m_threadPool.Run(tilesX * tilesY, [&](uint32_t item, uint32_t threadIndex)
+            {
+                m_scratch[threadIndex].pStatistics = pStatistics ? pStatistics + item : nullptr;
+                ProcessTile(source, target, passView, false, item, m_scratch[threadIndex]);
+            });
+            if (pStatistics)
+            {
+                EndStatistics();
+            }
+
+            source = target;
+            passView.InputX = passView.Region.X;
+            passView.InputY = passView.Region.Y;
+            passView.SourceWidth = passView.InputWidth = passView.Width;
+            passView.SourceHeight = passView.InputHeight = passView.Height;
+            passView.Reduced = false;
+            passView.pInputTransform = nullptr;
+        }
+    }
+}
@@ -0,0 +1,203 @@
+//CAS Sample
+//
+// Copyright(c) 2019 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <tuple>
+#include <utility>
+
+namespace CAS_SAMPLE_CPU
+{
+    //
+    // Color steps fused into the filter's input decode and output encode (CAS_Filter::SetColorTransforms()) instead of
+    // running as passes of their own over the frame. ffx_cas.h notes that conversions in CasLoad() and CasInput() are
+    // paid 15 times per output pixel when sharpening and 36 times when scaling; on the CPU the input stages run once per
+    // source texel of a tile's window and the output stages once per output pixel, on the planar rows in cache.
+    //
+    // The engine calls a transform once per row. CAS_ColorChain builds one from stage functors at compile time, so the
+    // stages of a texel are inlined into one loop:
+    //
+    //     CAS_ColorChain<CAS_Exposure, CAS_ColorMatrix, CAS_Clamp> input(CAS_Exposure{ 2.0f }, CAS_ColorMatrix{ ... }, CAS_Clamp{ 0.0f, 1.0f });
+    //
+    // A stage is any type with operator()(float& r, float& g, float& b) const. For HDR input a tonemap stage first, for
+    // example CAS_MakeColorChain(CAS_Aces{ exposure }), makes the filter tonemap once per source texel and sharpen the
+    // result.
+    //
+    class CAS_ColorTransform
+    {
+    public:
+        virtual ~CAS_ColorTransform() {}
+
+        // Transforms count texels of planar rows in place.
+        virtual void Apply(float* pR, float* pG, float* pB, uint32_t count) const = 0;
+    };
+
+    struct CAS_Exposure
+    {
+        float Scale;
+
+        void operator()(float& r, float& g, float& b) const { r *= Scale; g *= Scale; b *= Scale; }
+    };
+
+    // Row-major 3x3 matrix applied to the column (r, g, b), e.g. a color space conversion or saturation.
+    struct CAS_ColorMatrix
+    {
+        float M[9];
+
+        void operator()(float& r, float& g, float& b) const
+        {
+            const float x = r, y = g, z = b;
+            r = M[0] * x + M[1] * y + M[2] * z;
+            g = M[3] * x + M[4] * y + M[5] * z;
+            b = M[6] * x + M[7] * y + M[8] * z;
+        }
+    };
+
+    // Power curve, negative values go to 0.
+    struct CAS_Gamma
+    {
+        float Exponent;
+
+        void operator()(float& r, float& g, float& b) const
+        {
+            r = r > 0.0f ? std::pow(r, Exponent) : 0.0f;
+            g = g > 0.0f ? std::pow(g, Exponent) : 0.0f;
+            b = b > 0.0f ? std::pow(b, Exponent) : 0.0f;
+        }
+    };
+
+    // Tonemap operators for linear HDR input, so CAS runs on display values like ffx_cas.h asks without a tonemapped copy
+    // of the frame. Both scale by the exposure first and map to [0, 1].
+    // Reinhard per channel, x / (1 + x), or with a white point x (1 + x / White^2) / (1 + x) which reaches 1 at White.
+    struct CAS_Reinhard
+    {
+        float Exposure;
+        float White;    // 0 for none.
+
+        void operator()(float& r, float& g, float& b) const
+        {
+            const float whiteScale = White > 0.0f ? 1.0f / (White * White) : 0.0f;
+            r = Map(r * Exposure, whiteScale);
+            g = Map(g * Exposure, whiteScale);
+            b = Map(b * Exposure, whiteScale);
+        }
+
+        static float Map(float x, float whiteScale)
+        {
+            x = x > 0.0f ? x : 0.0f;
+            const float y = x * (1.0f + x * whiteScale) / (1.0f + x);
+            return y < 1.0f ? y : 1.0f;
+        }
+    };
+
+    // The ACES filmic curve fitted by Krzysztof Narkowicz, per channel.
+    struct CAS_Aces
+    {
+        float Exposure;
+
+        void operator()(float& r, float& g, float& b) const
+        {
+            r = Map(r * Exposure);
+            g = Map(g * Exposure);
+            b = Map(b * Exposure);
+        }
+
+        static float Map(float x)
+        {
+            x = x > 0.0f ? x : 0.0f;
+            const float y = (x * (2.51f * x + 0.03f)) / (x * (2.43f * x + 0.59f) + 0.14f);
+            return y < 1.0f ? y : 1.0f;
+        }
+    };
+
+    // HDR10 output through scRGB (ffx_cas.h): CAS ran on linear Rec.2020 with 1 at maxNits, the output is converted to
+    // sRGB primaries with 1 at 80 nits. Negative values are left for out of gamut colors, store into RGBA16F (the UNORM
+    // formats saturate it to [0, 1]).
+    struct CAS_Rec2020ToScRgb
+    {
+        float MaxNits;
+
+        void operator()(float& r, float& g, float& b) const
+        {
+            // Rec.2020 to Rec.709 primaries, both with a D65 white point.
+            const float scale = MaxNits * (1.0f / 80.0f);
+            const float x = r * scale, y = g * scale, z = b * scale;
+            r =  1.6604910f * x - 0.5876411f * y - 0.0728499f * z;
+            g = -0.1245505f * x + 1.1328999f * y - 0.0083494f * z;
+            b = -0.0181508f * x - 0.1005789f * y + 1.1187297f * z;
+        }
+    };
+
+    // CAS expects its input in [0, 1], so an input chain that can leave that range ends with this. The UNORM stores
+    // saturate on their own, an output chain needs it only for a narrower range or a float target.
+    struct CAS_Clamp
+    {
+        float Min;
+        float Max;
+
+        void operator()(float& r, float& g, float& b) const
+        {
+            r = r < Min ? Min : (r > Max ? Max : r);
+            g = g < Min ? Min : (g > Max ? Max : g);
+            b = b < Min ? Min : (b > Max ? Max : b);
+        }
+    };
+
+    template <typename... Stages>
+    class CAS_ColorChain : public CAS_ColorTransform
+    {
+    public:
+        explicit CAS_ColorChain(const Stages&... stages) : m_stages(stages...) {}
+
+        void Apply(float* pR, float* pG, float* pB, uint32_t count) const override
+        {
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                float r = pR[i], g = pG[i], b = pB[i];
+                ApplyStages(r, g, b, std::index_sequence_for<Stages...>());
+                pR[i] = r;
+                pG[i] = g;
+                pB[i] = b;
+            }
+        }
+
+        // Stage parameters can change between frames, an incremental call then has to filter the whole frame again.
+        template <size_t Index>
+        typename std::tuple_element<Index, std::tuple<Stages...>>::type& GetStage() { return std::get<Index>(m_stages); }
+
+    private:
+        template <size_t... Indices>
+        void ApplyStages(float& r, float& g, float& b, std::index_sequence<Indices...>) const
+        {
+            // Runs the stages in order, the array only expands the pack.
+            const int order[] = { 0, (std::get<Indices>(m_stages)(r, g, b), 0)... };
+            (void)order;
+        }
+
+        std::tuple<Stages...>           m_stages;
+    };
+
+    template <typename... Stages>
+    CAS_ColorChain<Stages...> CAS_MakeColorChain(const Stages&... stages)
+    {
+        return CAS_ColorChain<Stages...>(stages...);
+    }
+}
@@ -0,0 +1,542 @@
+//CAS Sample
+//
+// Copyright(c) 2019 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Accuracy of the fast CPU kernels against the double precision reference (CAS_Reference).
+// For every tier, CAS_* variant, source precision, mode and sharpness the fast filter and the reference run on the same
+// test image, and the max and mean absolute error, PSNR over RGB in {0 to 1} and luminance SSIM are reported. --max-error and --min-psnr turn the
+// run into a regression check: the exit code is 1 when any case is worse. --equivalence checks the paths of the filter
+// that are documented to match a plain Upscale() instead, with the same exit code.
+
+#include "CAS_Bench.h"
+#include "CAS_ColorChain.h"
+#include "CAS_Quality.h"
+#include "CAS_Reference.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace CAS_SAMPLE_CPU;
+
+struct CompareCase
+{
+    const char* pName;
+    bool SharpenOnly;
+    uint32_t InputWidth;
+    uint32_t InputHeight;
+    uint32_t OutputWidth;
+    uint32_t OutputHeight;
+};
+
+static const CompareCase s_CompareCases[] =
+{
+    { "720p",            true,  1280,  720, 1280,  720 },
+    { "1280x720->1080p", false, 1280,  720, 1920, 1080 },
+    { "1920x1080->4K",   false, 1920, 1080, 3840, 2160 },
+};
+
+static const float s_Sharpness[] = { 0.0f, 1.0f };
+
+//
+// --equivalence: checks what the CAS_Filter documentation states about its paths against a plain Upscale() of the same
+// frame: incremental against full frames, a sharpness map of 1 against none, the fused cascade against the stored one,
+// one UpscaleMulti() or UpscaleTargets() against separate calls, an identity color chain against none, alpha
+// pass-through against none, and so on. Every check prints the largest channel difference and the tolerance, which is
+// 0 where the documentation says the pixels are identical.
+//
+struct EquivalenceImage
+{
+    std::vector<uint8_t> Storage;
+    CAS_Image Image = {};
+
+    EquivalenceImage(uint32_t width, uint32_t height, CAS_Format format = CAS_Format_RGBA32F) { FillTestImage(Storage, Image, width, height, format); }
+    float* GetTexel(uint32_t x, uint32_t y) { return reinterpret_cast<float*>(Storage.data() + static_cast<size_t>(y) * Image.RowPitch) + x * 4; }
+};
+
+static double MaxDifference(const CAS_Image& a, const CAS_Image& b)
+{
+    double diff = 0.0;
+    for (uint32_t y = 0; y < a.Height; ++y)
+    {
+        for (uint32_t x = 0; x < a.Width; ++x)
+        {
+            float pa[3], pb[3];
+            CAS_Filter::LoadPixel(a, x, y, pa[0], pa[1], pa[2]);
+            CAS_Filter::LoadPixel(b, x, y, pb[0], pb[1], pb[2]);
+            for (int c = 0; c < 3; ++c)
+            {
+                // NaN counts as the largest difference.
+                const double d = std::fabs(static_cast<double>(pa[c]) - pb[c]);
+                diff = (d == d) ? std::max(diff, d) : INFINITY;
+            }
+        }
+    }
+    return diff;
+}
+
+static bool ReportEquivalence(CAS_Tier tier, const char* pCheck, double diff, double tolerance)
+{
+    const bool bad = !(diff <= tolerance);
+    printf("%-7s %-52s %11.3g %11.3g%s\n", CAS_Filter::GetTierName(tier), pCheck, diff, tolerance, bad ? "  FAIL" : "");
+    return bad;
+}
+
+// Filter set up for one frame size, with a sharpness that leaves the negative lobe on.
+static void SetupEquivalenceFilter(CAS_Filter& filter, CAS_Tier tier, uint32_t inputWidth, uint32_t inputHeight, uint32_t width, uint32_t height, CAS_State casState)
+{
+    filter.OnCreate(0, tier);
+    filter.OnCreateWindowSizeDependentResources(inputWidth, inputHeight, width, height, casState);
+    filter.UpdateSharpness(0.5f, casState);
+}
+
+static bool RunEquivalence(CAS_Tier tier)
+{
+    const uint32_t inputWidth = 640, inputHeight = 360, width = 960, height = 540;
+    EquivalenceImage input(inputWidth, inputHeight);
+    bool failed = false;
+
+    for (CAS_State casState : { CAS_State_SharpenOnly, CAS_State_Upsample })
+    {
+        const bool sharpenOnly = casState == CAS_State_SharpenOnly;
+        const uint32_t outputWidth = sharpenOnly ? inputWidth : width, outputHeight = sharpenOnly ? inputHeight : height;
+        const std::string mode = sharpenOnly ? "sharpen " : "upsample ";
+        CAS_Filter filter;
+        SetupEquivalenceFilter(filter, tier, inputWidth, inputHeight, outputWidth, outputHeight, casState);
+        EquivalenceImage expected(outputWidth, outputHeight), output(outputWidth, outputHeight);
+        filter.Upscale(input.Image, expected.Image, casState);
+
+        // Incremental: a changed rectangle, given as damage and found by hashing, against the full frame.
+        EquivalenceImage changed(inputWidth, inputHeight), changedExpected(outputWidth, outputHeight);
+        const CAS_Rect damage = { 100, 50, 37, 61 };
+        for (uint32_t y = damage.Y; y < damage.Y + damage.Height; ++y)
+        {
+            for (uint32_t x = damage.X; x < damage.X + damage.Width; ++x)
+            {
+                float* pTexel = changed.GetTexel(x, y);
+                for (int c = 0; c < 3; ++c)
+                {
+                    pTexel[c] = 1.0f - pTexel[c];
+                }
+            }
+        }
+        filter.Upscale(changed.Image, changedExpected.Image, casState);
+        filter.Upscale(input.Image, output.Image, casState);
+        filter.UpscaleDamaged(changed.Image, output.Image, casState, &damage, 1);
+        failed |= ReportEquivalence(tier, (mode + "UpscaleDamaged vs Upscale").c_str(), MaxDifference(output.Image, changedExpected.Image), 0.0);
+        filter.UpscaleChanged(input.Image, output.Image, casState);
+        filter.UpscaleChanged(changed.Image, output.Image, casState);
+        failed |= ReportEquivalence(tier, (mode + "UpscaleChanged vs Upscale").c_str(), MaxDifference(output.Image, changedExpected.Image), 0.0);
+
+        // Regions stitched into the frame.
+        for (uint32_t quarter = 0; quarter < 4; ++quarter)
+        {
+            const CAS_Rect region = { (quarter & 1) * (outputWidth / 2), (quarter >> 1) * (outputHeight / 2), outputWidth / 2, outputHeight / 2 };
+            const CAS_Rect inputRegion = filter.GetInputRegion(region, casState);
+            CAS_Image regionInput = input.Image, regionOutput = output.Image;
+            regionInput.pData = input.GetTexel(inputRegion.X, inputRegion.Y);
+            regionInput.Width = inputRegion.Width;
+            regionInput.Height = inputRegion.Height;
+            regionOutput.pData = output.GetTexel(region.X, region.Y);
+            regionOutput.Width = region.Width;
+            regionOutput.Height = region.Height;
+            filter.UpscaleRegion(regionInput, inputRegion.X, inputRegion.Y, regionOutput, casState, region);
+        }
+        failed |= ReportEquivalence(tier, (mode + "UpscaleRegion stitched vs Upscale").c_str(), MaxDifference(output.Image, expected.Image), 0.0);
+
+        // A sharpness map of 1 is the sharpness given to UpdateSharpness(), 0 a copy when sharpening.
+        const std::vector<float> ones((outputWidth + 7) / 8 * ((outputHeight + 7) / 8), 1.0f), zeros(ones.size(), 0.0f);
+        filter.SetSharpnessMap(ones.data(), (outputWidth + 7) / 8, (outputHeight + 7) / 8);
+        filter.Upscale(input.Image, output.Image, casState);
+        failed |= ReportEquivalence(tier, (mode + "sharpness map of 1 vs none").c_str(), MaxDifference(output.Image, expected.Image), 0.0);
+        if (sharpenOnly)
+        {
+            filter.SetSharpnessMap(zeros.data(), (outputWidth + 7) / 8, (outputHeight + 7) / 8);
+            filter.Upscale(input.Image, output.Image, casState);
+            failed |= ReportEquivalence(tier, "sharpen sharpness map of 0 vs input", MaxDifference(output.Image, input.Image), 0.0);
+        }
+        filter.SetSharpnessMap(nullptr, 0, 0);
+
+        // Color transforms that change nothing.
+        const auto identity = CAS_MakeColorChain(CAS_Exposure{ 1.0f });
+        filter.SetColorTransforms(&identity, &identity);
+        filter.Upscale(input.Image, output.Image, casState);
+        failed |= ReportEquivalence(tier, (mode + "identity color chain vs none").c_str(), MaxDifference(output.Image, expected.Image), 0.0);
+        filter.SetColorTransforms(nullptr, nullptr);
+
+        // Statistics, the contrast map and an empty overlay leave the pixels as they are.
+        std::vector<CAS_BlockContrast> contrast(filter.GetContrastMapWidth(outputWidth) * filter.GetContrastMapHeight(outputHeight));
+        filter.SetStatistics(true);
+        filter.SetContrastMap(contrast.data());
+        EquivalenceImage overlay(outputWidth, outputHeight);
+        std::fill(overlay.Storage.begin(), overlay.Storage.end(), static_cast<uint8_t>(0));
+        filter.SetOverlay(&overlay.Image);
+        filter.Upscale(input.Image, output.Image, casState);
+        failed |= ReportEquivalence(tier, (mode + "statistics, contrast, empty overlay vs none").c_str(), MaxDifference(output.Image, expected.Image), 0.0);
+        filter.SetContrastMap(nullptr);
+
+        // The statistics are those of the pixels written, the mean summed in another order.
+        const CAS_Statistics& statistics = filter.GetStatistics();
+        double sum = 0.0, minimum = INFINITY, maximum = -INFINITY;
+        for (uint32_t y = 0; y < outputHeight; ++y)
+        {
+            for (uint32_t x = 0; x < outputWidth; ++x)
+            {
+                const float* pTexel = expected.GetTexel(x, y);
+                const float luma = 0.2126f * pTexel[0] + 0.7152f * pTexel[1] + 0.0722f * pTexel[2];
+                sum += luma;
+                minimum = std::min(minimum, static_cast<double>(luma));
+                maximum = std::max(maximum, static_cast<double>(luma));
+            }
+        }
+        const double statisticsDiff = std::max({ std::fabs(sum / (static_cast<double>(outputWidth) * outputHeight) - statistics.Mean), std::fabs(minimum - statistics.Min),
+                                                 std::fabs(maximum - statistics.Max), std::fabs(static_cast<double>(outputWidth) * outputHeight - statistics.Count) });
+        failed |= ReportEquivalence(tier, (mode + "statistics vs output luminance").c_str(), statisticsDiff, 1e-6);
+        filter.SetStatistics(false);
+
+        // A half transparent overlay: rgb * (1 - a) + overlay.
+        for (uint32_t y = 0; y < outputHeight; ++y)
+        {
+            for (uint32_t x = 0; x < outputWidth; ++x)
+            {
+                float* pTexel = overlay.GetTexel(x, y);
+                pTexel[0] = pTexel[1] = pTexel[2] = (x / 16 + y / 16) % 2 ? 0.25f : 0.0f;
+                pTexel[3] = (x / 16 + y / 16) % 2 ? 0.5f : 0.0f;
+            }
+        }
+        EquivalenceImage composited(outputWidth, outputHeight);
+        for (uint32_t y = 0; y < outputHeight; ++y)
+        {
+            for (uint32_t x = 0; x < outputWidth; ++x)
+            {
+                for (int c = 0; c < 3; ++c)
+                {
+                    composited.GetTexel(x, y)[c] = expected.GetTexel(x, y)[c] * (1.0f - overlay.GetTexel(x, y)[3]) + overlay.GetTexel(x, y)[c];
+                }
+            }
+        }
+        filter.Upscale(input.Image, output.Image, casState);
+        failed |= ReportEquivalence(tier, (mode + "overlay vs composited output").c_str(), MaxDifference(output.Image, composited.Image), 1e-6);
+        filter.SetOverlay(nullptr);
+
+        // Alpha pass-through keeps the color, and when sharpening writes the source alpha.
+        EquivalenceImage alphaInput(inputWidth, inputHeight);
+        for (uint32_t y = 0; y < inputHeight; ++y)
+        {
+            for (uint32_t x = 0; x < inputWidth; ++x)
+            {
+                alphaInput.GetTexel(x, y)[3] = static_cast<float>((x * 7 + y * 3) % 64) / 63.0f;
+            }
+        }
+        filter.SetAlphaPassThrough(true);
+        filter.Upscale(alphaInput.Image, output.Image, casState);
+        failed |= ReportEquivalence(tier, (mode + "alpha pass-through color vs none").c_str(), MaxDifference(output.Image, expected.Image), 0.0);
+        if (sharpenOnly)
+        {
+            double alphaDiff = 0.0;
+            for (uint32_t y = 0; y < inputHeight; ++y)
+            {
+                for (uint32_t x = 0; x < inputWidth; ++x)
+                {
+                    alphaDiff = std::max(alphaDiff, static_cast<double>(std::fabs(output.GetTexel(x, y)[3] - alphaInput.GetTexel(x, y)[3])));
+                }
+            }
+            failed |= ReportEquivalence(tier, "sharpen alpha pass-through alpha vs input", alphaDiff, 0.0);
+        }
+        filter.SetAlphaPassThrough(false);
+
+        // Every target of UpscaleTargets() against Upscale() into that format, and dither within one step of rounding.
+        EquivalenceImage target16(outputWidth, outputHeight, CAS_Format_RGBA16F), target8(outputWidth, outputHeight, CAS_Format_RGBA8);
+        EquivalenceImage target10(outputWidth, outputHeight, CAS_Format_R10G10B10A2), dithered(outputWidth, outputHeight, CAS_Format_RGBA8);
+        const CAS_Target targets[] =
+        {
+            { target16.Image, CAS_Transfer_Linear, 0.0f, CAS_Dither_None, 0.0f, 0 },
+            { target8.Image, CAS_Transfer_Linear, 0.0f, CAS_Dither_None, 0.0f, 0 },
+            { target10.Image, CAS_Transfer_Linear, 0.0f, CAS_Dither_None, 0.0f, 0 },
+            { dithered.Image, CAS_Transfer_Linear, 0.0f, CAS_Dither_BlueNoise, 0.0f, 7 },
+        };
+        filter.UpscaleTargets(input.Image, targets, 4, casState);
+        for (uint32_t i = 0; i < 3; ++i)
+        {
+            EquivalenceImage separate(outputWidth, outputHeight, targets[i].Image.Format);
+            filter.Upscale(input.Image, separate.Image, casState);
+            const std::string check = mode + "UpscaleTargets " + (i == 0 ? "RGBA16F" : i == 1 ? "RGBA8" : "R10G10B10A2") + " vs Upscale";
+            failed |= ReportEquivalence(tier, check.c_str(), MaxDifference(targets[i].Image, separate.Image), 0.0);
+        }
+        failed |= ReportEquivalence(tier, (mode + "blue noise dither vs rounded RGBA8").c_str(), MaxDifference(dithered.Image, target8.Image), 1.0 / 255.0 + 1e-6);
+
+        filter.OnDestroyWindowSizeDependentResources();
+        filter.OnDestroy();
+    }
+
+    // UpscaleMulti() against a filter set up for each output alone.
+    {
+        EquivalenceImage multi0(width, height), multi1(inputWidth, inputHeight), multi2(800, 450);
+        const CAS_Output outputs[] = { { multi0.Image, 0.5f }, { multi1.Image, 1.0f }, { multi2.Image, 0.0f } };
+        CAS_Filter filter;
+        SetupEquivalenceFilter(filter, tier, inputWidth, inputHeight, width, height, CAS_State_Upsample);
+        filter.UpscaleMulti(input.Image, outputs, 3);
+        filter.OnDestroyWindowSizeDependentResources();
+        filter.OnDestroy();
+        for (const CAS_Output& multiOutput : outputs)
+        {
+            const CAS_Image& image = multiOutput.Image;
+            const CAS_State casState = (image.Width == inputWidth && image.Height == inputHeight) ? CAS_State_SharpenOnly : CAS_State_Upsample;
+            EquivalenceImage separate(image.Width, image.Height);
+            filter.OnCreate(0, tier);
+            filter.OnCreateWindowSizeDependentResources(inputWidth, inputHeight, image.Width, image.Height, casState);
+            filter.UpdateSharpness(multiOutput.Sharpness, casState);
+            filter.Upscale(input.Image, separate.Image, casState);
+            filter.OnDestroyWindowSizeDependentResources();
+            filter.OnDestroy();
+            const std::string check = "UpscaleMulti " + std::to_string(image.Width) + "x" + std::to_string(image.Height) + " vs Upscale";
+            failed |= ReportEquivalence(tier, check.c_str(), MaxDifference(image, separate.Image), 0.0);
+        }
+    }
+
+    // Beyond CAS_AREA_LIMIT: the fused cascade against the stored one.
+    {
+        const uint32_t cascadeWidth = 4 * inputWidth, cascadeHeight = 4 * inputHeight;
+        EquivalenceImage fused(cascadeWidth, cascadeHeight), stored(cascadeWidth, cascadeHeight);
+        CAS_Filter filter;
+        SetupEquivalenceFilter(filter, tier, inputWidth, inputHeight, cascadeWidth, cascadeHeight, CAS_State_Upsample);
+        filter.SetCascade(true, true);
+        filter.Upscale(input.Image, fused.Image, CAS_State_Upsample);
+        filter.SetCascade(true, false);
+        filter.Upscale(input.Image, stored.Image, CAS_State_Upsample);
+        failed |= ReportEquivalence(tier, "cascade fused vs stored", MaxDifference(fused.Image, stored.Image), 0.0);
+        filter.OnDestroyWindowSizeDependentResources();
+        filter.OnDestroy();
+    }
+
+    // A 2x2 box reduction against sharpening the input averaged beforehand, the sums in another order.
+    {
+        EquivalenceImage large(2 * inputWidth, 2 * inputHeight), averaged(inputWidth, inputHeight), reduced(inputWidth, inputHeight), separate(inputWidth, inputHeight);
+        for (uint32_t y = 0; y < inputHeight; ++y)
+        {
+            for (uint32_t x = 0; x < inputWidth; ++x)
+            {
+                for (int c = 0; c < 3; ++c)
+                {
+                    averaged.GetTexel(x, y)[c] = 0.25f * (large.GetTexel(2 * x, 2 * y)[c] + large.GetTexel(2 * x + 1, 2 * y)[c] +
+                                                          large.GetTexel(2 * x, 2 * y + 1)[c] + large.GetTexel(2 * x + 1, 2 * y + 1)[c]);
+                }
+            }
+        }
+        CAS_Filter filter;
+        filter.OnCreate(0, tier);
+        filter.SetReduction(CAS_Reduction_Box, 2);
+        filter.OnCreateWindowSizeDependentResources(2 * inputWidth, 2 * inputHeight, inputWidth, inputHeight, CAS_State_SharpenOnly);
+        filter.UpdateSharpness(0.5f, CAS_State_SharpenOnly);
+        filter.Upscale(large.Image, reduced.Image, CAS_State_SharpenOnly);
+        filter.SetReduction(CAS_Reduction_None, 1);
+        filter.OnCreateWindowSizeDependentResources(inputWidth, inputHeight, inputWidth, inputHeight, CAS_State_SharpenOnly);
+        filter.UpdateSharpness(0.5f, CAS_State_SharpenOnly);
+        filter.Upscale(averaged.Image, separate.Image, CAS_State_SharpenOnly);
+        failed |= ReportEquivalence(tier, "box reduction vs averaged input", MaxDifference(reduced.Image, separate.Image), 1e-5);
+        filter.OnDestroyWindowSizeDependentResources();
+        filter.OnDestroy();
+    }
+    return failed;
+}
+
+static void PrintUsage()
+{
+    printf("Usage: CAS_Compare [options]\n"
+           "  --tier <scalar|sse2|avx2|all>     Kernel tiers to check (default all supported)\n"
+           "  --variant <0-7|all>               CAS_Variant flags to check (default all)\n"
+           "  --precision <fp32|fp16|fixed16|all> Source window precision to check (default fp32)\n"
+           "  --format <rgba32f|rgba16f|rgba8>  Input and output format (default rgba32f, isolates the kernel error)\n"
+           "  --max-error <e>                   Fail if any max absolute error is above e\n"
+           "  --min-psnr <db>                   Fail if any PSNR is below db\n"
+           "  --equivalence                     Check the documented equivalences of the filter paths instead (incremental,\n"
+           "                                    region, sharpness map, color chain, targets, multi, cascade, reduction, ...)\n");
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<CAS_Tier> tiers;
+    std::vector<uint32_t> variants;
+    std::vector<CAS_Precision> precisions;
+    CAS_Format format = CAS_Format_RGBA32F;
+    double maxAllowedError = INFINITY;
+    double minAllowedPsnr = 0.0;
+    bool equivalence = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        const char* pArg = argv[i];
+        if (strcmp(pArg, "--equivalence") == 0)
+        {
+            equivalence = true;
+            continue;
+        }
+        const char* pValue = (i + 1 < argc) ? argv[++i] : nullptr;
+        if (!pValue)
+        {
+            PrintUsage();
+            return 1;
+        }
+        if (strcmp(pArg, "--tier") == 0)
+        {
+            for (int tier = 0; tier < CAS_Tier_Count; ++tier)
+            {
+                std::string name = CAS_Filter::GetTierName(static_cast<CAS_Tier>(tier));
+                std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+                if (name == pValue || strcmp(pValue, "all") == 0)
+                {
+                    tiers.push_back(static_cast<CAS_Tier>(tier));
+                }
+            }
+        }
+        else if (strcmp(pArg, "--variant") == 0)
+        {
+            for (uint32_t variant = 0; variant < CAS_Variant_Count; ++variant)
+            {
+                if (strcmp(pValue, "all") == 0 || static_cast<uint32_t>(atoi(pValue)) == variant)
+                {
+                    variants.push_back(variant);
+                }
+            }
+        }
+        else if (strcmp(pArg, "--precision") == 0)
+        {
+            for (int precision = 0; precision < CAS_Precision_Count; ++precision)
+            {
+                std::string name = CAS_Filter::GetPrecisionName(static_cast<CAS_Precision>(precision));
+                std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+                if (name == pValue || strcmp(pValue, "all") == 0)
+                {
+                    precisions.push_back(static_cast<CAS_Precision>(precision));
+                }
+            }
+        }
+        else if (strcmp(pArg, "--format") == 0)
+        {
+            format = strcmp(pValue, "rgba16f") == 0 ? CAS_Format_RGBA16F : strcmp(pValue, "rgba8") == 0 ? CAS_Format_RGBA8 : CAS_Format_RGBA32F;
+        }
+        else if (strcmp(pArg, "--max-error") == 0)
+        {
+            maxAllowedError = atof(pValue);
+        }
+        else if (strcmp(pArg, "--min-psnr") == 0)
+        {
+            minAllowedPsnr = atof(pValue);
+        }
+        else
+        {
+            PrintUsage();
+            return 1;
+        }
+    }
+    if (tiers.empty())
+    {
+        tiers = { CAS_Tier_Scalar, CAS_Tier_SSE2, CAS_Tier_AVX2 };
+    }
+    if (precisions.empty())
+    {
+        precisions.push_back(CAS_Precision_FP32);
+    }
+    if (variants.empty())
+    {
+        for (uint32_t variant = 0; variant < CAS_Variant_Count; ++variant)
+        {
+            variants.push_back(variant);
+        }
+    }
+
+    if (equivalence)
+    {
+        printf("%-7s %-52s %11s %11s\n", "Tier", "Check", "max diff", "tolerance");
+        bool failed = false;
+        for (CAS_Tier tier : tiers)
+        {
+            failed |= CAS_Filter::IsTierSupported(tier) && RunEquivalence(tier);
+        }
+        return failed ? 1 : 0;
+    }
+
+    printf("%-7s %-44s %-9s %-16s %9s %11s %11s %9s %9s\n", "Tier", "Variant", "Precision", "Case", "sharpness", "max error", "mean error", "PSNR(dB)", "SSIM");
+
+    bool failed = false;
+    for (const CompareCase& compareCase : s_CompareCases)
+    {
+        std::vector<uint8_t> inputStorage, outputStorage;
+        CAS_Image input = {}, output = {};
+        FillTestImage(inputStorage, input, compareCase.InputWidth, compareCase.InputHeight, format);
+        FillTestImage(outputStorage, output, compareCase.OutputWidth, compareCase.OutputHeight, format);
+
+        // An all black block, where CAS_GO_SLOWER computes 0 * rcp(0).
+        const uint32_t pixelSize = CAS_Filter::GetFormatSize(format);
+        for (uint32_t y = 64; y < 128; ++y)
+        {
+            memset(static_cast<uint8_t*>(input.pData) + y * input.RowPitch + 64 * pixelSize, 0, 64 * pixelSize);
+        }
+        const CAS_State casState = compareCase.SharpenOnly ? CAS_State_SharpenOnly : CAS_State_Upsample;
+
+        for (float sharpness : s_Sharpness)
+        {
+            // The reference only depends on the algorithm flags, GO_SLOWER is what it already is.
+            CAS_ReferenceImage references[CAS_Variant_Count];
+            for (uint32_t variant : variants)
+            {
+                const uint32_t algorithm = variant & (CAS_Variant_BetterDiagonals | CAS_Variant_Slow);
+                if (references[algorithm].Data.empty())
+                {
+                    CAS_Reference::Filter(input, compareCase.OutputWidth, compareCase.OutputHeight, compareCase.SharpenOnly, sharpness, algorithm, references[algorithm]);
+                }
+            }
+
+            for (CAS_Tier tier : tiers)
+            {
+                if (!CAS_Filter::IsTierSupported(tier))
+                {
+                    continue;
+                }
+
+                CAS_Filter filter;
+                filter.OnCreate(0, tier);
+                filter.OnCreateWindowSizeDependentResources(compareCase.InputWidth, compareCase.InputHeight, compareCase.OutputWidth, compareCase.OutputHeight, casState);
+                filter.UpdateSharpness(sharpness, casState);
+                for (uint32_t variant : variants)
+                {
+                    for (CAS_Precision precision : precisions)
+                    {
+                        filter.SetVariant(variant);
+                        filter.SetPrecision(precision);
+                        filter.Upscale(input, output, casState);
+
+                        const uint32_t algorithm = variant & (CAS_Variant_BetterDiagonals | CAS_Variant_Slow);
+                        CAS_QualityStats error;
+                        CAS_Quality::Measure(output, references[algorithm], error);
+                        const bool bad = error.MaxError > maxAllowedError || error.Psnr < minAllowedPsnr;
+                        failed = failed || bad;
+                        printf("%-7s %-44s %-9s %-16s %9.2f %11.3g %11.3g %9.2f %9.6f%s\n", CAS_Filter::GetTierName(tier), CAS_Filter::GetVariantName(variant).c_str(),
+                               CAS_Filter::GetPrecisionName(precision), compareCase.pName, sharpness, error.MaxError, error.MeanError, error.Psnr, error.Ssim, bad ? "  FAIL" : "");
+                    }
+                }
+                filter.OnDestroyWindowSizeDependentResources();
+                filter.OnDestroy();
+            }
+        }
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,141 @@
+//CAS Sample
+//
+// Copyright(c) 2019 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Per block contrast map of the output. The contrast kernels (see CAS_Kernels.h) take the soft min and max of green
+// from the same source window the tile's filter reads, so the frame is not read again. When scaling, they run once per
+// source texel and the result is blended with the filter's bilinear weights. Every tile sums its pixels into the 8x8
+// blocks of the frame it covers, which no other tile touches, and the map's 8x8 or 16x16 blocks are the means of those
+// sums once the whole frame is done.
+
+#include "CAS_CPU.h"
+#include "CAS_Kernels.h"
+
+#include <algorithm>
+
+namespace CAS_SAMPLE_CPU
+{
+    void CAS_Filter::SetContrastMap(CAS_BlockContrast* pMap, uint32_t blockSize)
+    {
+        m_pContrastMap = pMap;
+        m_contrastBlockSize = (blockSize <= 8) ? 8 : 16;
+    }
+
+    void CAS_Filter::MeasureContrast(const CAS_TileArgs& args, bool sharpenOnly, const FrameView& view, uint32_t dstX, uint32_t dstY, ThreadScratch& scratch)
+    {
+        const CAS_KernelTable* pKernels = CAS_GetKernelTable(m_tier);
+        const CAS_KernelFn contrast = pKernels->Contrast[m_precision][(m_variant & CAS_Variant_BetterDiagonals) ? 1 : 0];
+        const size_t plane = static_cast<size_t>(args.DstPitch) * args.Height;
+        CAS_TileArgs contrastArgs = args;
+        if (sharpenOnly)
+        {
+            if (scratch.Contrast.size() < plane * 2)
+            {
+                scratch.Contrast.resize(plane * 2);
+            }
+            contrastArgs.pDst[0] = scratch.Contrast.data();
+            contrastArgs.pDst[1] = contrastArgs.pDst[0] + plane;
+            contrastArgs.pDst[2] = nullptr;
+            contrast(contrastArgs);
+        }
+        else
+        {
+            // Source texels are fewer than the pixels, and each is the tap of several: take the contrast of the ones
+            // the tile's taps read (window texels 1 to the last 'k'), in window coordinates, then blend it per pixel.
+            const uint32_t texelWidth = static_cast<uint32_t>(args.pColumn[args.Width - 1]) + 1;
+            const uint32_t texelHeight = static_cast<uint32_t>(args.pRow[args.Height - 1]) + 1;
+            const size_t texelPlane = static_cast<size_t>(args.SrcPitch) * (texelHeight + 2);
+            if (scratch.Contrast.size() < texelPlane * 2 + plane * 2)
+            {
+                scratch.Contrast.resize(texelPlane * 2 + plane * 2);
+            }
+            float* pTexels = scratch.Contrast.data();
+            CAS_TileArgs texelArgs = args;
+            texelArgs.pDst[0] = pTexels + args.SrcPitch + 1;
+            texelArgs.pDst[1] = pTexels + texelPlane + args.SrcPitch + 1;
+            texelArgs.pDst[2] = nullptr;
+            texelArgs.DstPitch = args.SrcPitch;
+            texelArgs.Width = texelWidth;
+            texelArgs.Height = texelHeight;
+            contrast(texelArgs);
+
+            contrastArgs.pSrc[0] = pTexels;
+            contrastArgs.pSrc[1] = pTexels + texelPlane;
+            contrastArgs.pSrc[2] = nullptr;
+            contrastArgs.pDst[0] = pTexels + texelPlane * 2;
+            contrastArgs.pDst[1] = contrastArgs.pDst[0] + plane;
+            contrastArgs.pDst[2] = nullptr;
+            pKernels->ContrastBlend(contrastArgs);
+        }
+
+        // The tile is on the 8x8 grid and inside the frame.
+        const uint32_t frameBlocksX = (view.Width + 7) / 8;
+        for (uint32_t by = 0; by < args.Height; by += 8)
+        {
+            CAS_BlockContrast* pBlock = &m_contrastBlocks[static_cast<size_t>((dstY + by) / 8) * frameBlocksX + dstX / 8];
+            for (uint32_t bx = 0; bx < args.Width; bx += 8, ++pBlock)
+            {
+                float contrast = 0.0f;
+                float amplitude = 0.0f;
+                for (uint32_t y = by; y < std::min(by + 8, args.Height); ++y)
+                {
+                    const float* pContrast = contrastArgs.pDst[0] + static_cast<size_t>(y) * args.DstPitch;
+                    const float* pAmplitude = contrastArgs.pDst[1] + static_cast<size_t>(y) * args.DstPitch;
+                    for (uint32_t x = bx; x < std::min(bx + 8, args.Width); ++x)
+                    {
+                        contrast += pContrast[x];
+                        amplitude += pAmplitude[x];
+                    }
+                }
+                pBlock->Contrast = contrast;
+                pBlock->Amplitude = amplitude;
+            }
+        }
+    }
+
+    void CAS_Filter::EndContrastMap(const FrameView& view)
+    {
+        // Map blocks the grid touches, each the mean of its 8x8 blocks weighted by their pixels in the frame.
+        const uint32_t size = m_contrastBlockSize;
+        const uint32_t frameBlocksX = (view.Width + 7) / 8;
+        const uint32_t mapWidth = GetContrastMapWidth(view.Width);
+        for (uint32_t mapY = view.Grid.Y / size; mapY * size < view.Grid.Y + view.Grid.Height; ++mapY)
+        {
+            for (uint32_t mapX = view.Grid.X / size; mapX * size < view.Grid.X + view.Grid.Width; ++mapX)
+            {
+                const uint32_t x1 = std::min((mapX + 1) * size, view.Width);
+                const uint32_t y1 = std::min((mapY + 1) * size, view.Height);
+                float contrast = 0.0f;
+                float amplitude = 0.0f;
+                for (uint32_t y = mapY * size; y < y1; y += 8)
+                {
+                    for (uint32_t x = mapX * size; x < x1; x += 8)
+                    {
+                        const CAS_BlockContrast& block = m_contrastBlocks[static_cast<size_t>(y / 8) * frameBlocksX + x / 8];
+                        contrast += block.Contrast;
+                        amplitude += block.Amplitude;
+                    }
+                }
+                const float rcpPixels = 1.0f / static_cast<float>((x1 - mapX * size) * (y1 - mapY * size));
+                CAS_BlockContrast& entry = m_pContrastMap[static_cast<size_t>(mapY) * mapWidth + mapX];
+                entry.Contrast = contrast * rcpPixels;
+                entry.Amplitude = amplitude * rcpPixels;
+            }
+        }
+    }
+}
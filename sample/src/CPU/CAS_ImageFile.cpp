@@ -0,0 +1,146 @@
+//CAS Sample
+//
+// Copyright(c) 2019 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <utility>
+
+#include "CAS_ImageFile.h"
+
+namespace CAS_SAMPLE_CPU
+{
+    // Next whitespace separated header token, skipping '#' comments.
+    static bool CasReadToken(std::istream& stream, std::string& token)
+    {
+        token.clear();
+        int c = stream.get();
+        while (c != EOF)
+        {
+            if (c == '#')
+            {
+                while (c != EOF && c != '\n')
+                {
+                    c = stream.get();
+                }
+            }
+            else if (!isspace(c))
+            {
+                break;
+            }
+            c = stream.get();
+        }
+        while (c != EOF && !isspace(c))
+        {
+            token += static_cast<char>(c);
+            c = stream.get();
+        }
+        // The single whitespace after the last token is consumed, the binary data follows.
+        return !token.empty();
+    }
+
+    static float CasSrgbToLinear(float c)
+    {
+        return c <= 0.04045f ? c * (1.0f / 12.92f) : std::pow((c + 0.055f) * (1.0f / 1.055f), 2.4f);
+    }
+
+    bool CAS_ImageFile::Load(const char* pPath, std::vector<uint8_t>& storage, CAS_Image& image, std::string& error)
+    {
+        std::ifstream file(pPath, std::ios::binary);
+        if (!file)
+        {
+            error = std::string("cannot open ") + pPath;
+            return false;
+        }
+
+        std::string magic, widthToken, heightToken, rangeToken;
+        if (!CasReadToken(file, magic) || !CasReadToken(file, widthToken) || !CasReadToken(file, heightToken) || !CasReadToken(file, rangeToken))
+        {
+            error = std::string("truncated header in ") + pPath;
+            return false;
+        }
+        const bool ppm = (magic == "P6");
+        if (!ppm && magic != "PF")
+        {
+            error = std::string("only binary PPM (P6) and color PFM (PF) are supported: ") + pPath;
+            return false;
+        }
+        const long width = atol(widthToken.c_str());
+        const long height = atol(heightToken.c_str());
+        const double range = atof(rangeToken.c_str());
+        if (width <= 0 || height <= 0 || range == 0.0 || (ppm && (range < 1.0 || range > 65535.0)))
+        {
+            error = std::string("invalid header in ") + pPath;
+            return false;
+        }
+
+        image.Width = static_cast<uint32_t>(width);
+        image.Height = static_cast<uint32_t>(height);
+        image.RowPitch = image.Width * CAS_Filter::GetFormatSize(CAS_Format_RGBA32F);
+        image.Format = CAS_Format_RGBA32F;
+        storage.assign(static_cast<size_t>(image.RowPitch) * image.Height, 0);
+        image.pData = storage.data();
+
+        const size_t channelSize = ppm ? (range > 255.0 ? 2 : 1) : 4;
+        std::vector<uint8_t> row(static_cast<size_t>(width) * 3 * channelSize);
+        for (uint32_t y = 0; y < image.Height; ++y)
+        {
+            if (!file.read(reinterpret_cast<char*>(row.data()), row.size()))
+            {
+                error = std::string("truncated pixel data in ") + pPath;
+                return false;
+            }
+
+            // PFM rows go bottom to top.
+            const uint32_t dstY = ppm ? y : image.Height - 1 - y;
+            float* pOut = reinterpret_cast<float*>(storage.data() + static_cast<size_t>(dstY) * image.RowPitch);
+            for (uint32_t i = 0; i < image.Width * 3; ++i)
+            {
+                const uint8_t* p = &row[i * channelSize];
+                float value;
+                if (!ppm)
+                {
+                    // A negative scale means little endian.
+                    uint8_t bytes[4] = { p[0], p[1], p[2], p[3] };
+                    const uint16_t probe = 1;
+                    const bool hostLittle = *reinterpret_cast<const uint8_t*>(&probe) == 1;
+                    if (hostLittle != (range < 0.0))
+                    {
+                        std::swap(bytes[0], bytes[3]);
+                        std::swap(bytes[1], bytes[2]);
+                    }
+                    memcpy(&value, bytes, 4);
+                }
+                else
+                {
+                    const uint32_t code = channelSize == 2 ? (p[0] << 8 | p[1]) : p[0];
+                    value = CasSrgbToLinear(static_cast<float>(code / range));
+                }
+                pOut[(i / 3) * 4 + i % 3] = value;
+            }
+            for (uint32_t x = 0; x < image.Width; ++x)
+            {
+                pOut[x * 4 + 3] = 1.0f;
+            }
+        }
+        return true;
+    }
+}
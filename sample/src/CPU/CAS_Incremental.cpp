@@ -0,0 +1,211 @@
+//CAS Sample
+//
+// Copyright(c) 2019 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Incremental filtering for frames that mostly repeat the previous one (desktop capture, remote display, static video).
+// A tile is filtered again when its source footprint, the tile's input pixels plus the filter halo, changed: either it
+// overlaps a damage rectangle from the caller or its hash differs from the one of the previous frame. Every other tile
+// keeps what the output already holds.
+
+#include "CAS_CPU.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace CAS_SAMPLE_CPU
+{
+    static inline uint64_t CasRotl64(uint64_t x, uint32_t r) { return (x << r) | (x >> (64 - r)); }
+
+    static const uint64_t s_HashPrime1 = 0x9e3779b185ebca87ull;
+    static const uint64_t s_HashPrime2 = 0xc2b2ae3d27d4eb4full;
+
+    static inline uint64_t CasHashRound(uint64_t acc, uint64_t word)
+    {
+        return CasRotl64(acc + word * s_HashPrime2, 31) * s_HashPrime1;
+    }
+
+    // 64-bit hash of a block of rows, 4 independent lanes of 8 byte words so it runs near memory speed.
+    static uint64_t CasHashRows(const uint8_t* pData, size_t pitch, size_t rowBytes, uint32_t rows, uint64_t seed)
+    {
+        uint64_t lane[4] = { seed + s_HashPrime1, seed + s_HashPrime2, seed, seed - s_HashPrime1 };
+        for (uint32_t y = 0; y < rows; ++y)
+        {
+            const uint8_t* pRow = pData + y * pitch;
+            size_t i = 0;
+            for (; i + 32 <= rowBytes; i += 32)
+            {
+                uint64_t words[4];
+                memcpy(words, pRow + i, sizeof(words));
+                lane[0] = CasHashRound(lane[0], words[0]);
+                lane[1] = CasHashRound(lane[1], words[1]);
+                lane[2] = CasHashRound(lane[2], words[2]);
+                lane[3] = CasHashRound(lane[3], words[3]);
+            }
+            for (; i + 8 <= rowBytes; i += 8)
+            {
+                uint64_t word;
+                memcpy(&word, pRow + i, sizeof(word));
+                lane[0] = CasHashRound(lane[0], word);
+            }
+            // Rows are whole texels, so at most one 4 byte word is left.
+            if (i < rowBytes)
+            {
+                uint32_t word;
+                memcpy(&word, pRow + i, sizeof(word));
+                lane[1] = CasHashRound(lane[1], word);
+            }
+        }
+
+        uint64_t hash = CasRotl64(lane[0], 1) + CasRotl64(lane[1], 7) + CasRotl64(lane[2], 12) + CasRotl64(lane[3], 18);
+        hash ^= hash >> 33;
+        hash *= s_HashPrime2;
+        hash ^= hash >> 29;
+        return hash;
+    }
+
+    static bool CasRectsOverlap(const CAS_Rect& a, const CAS_Rect& b)
+    {
+        return a.X < b.X + b.Width && b.X < a.X + a.Width && a.Y < b.Y + b.Height && b.Y < a.Y + a.Height;
+    }
+
+    uint32_t CAS_Filter::RunTiles(const CAS_Image& input, const CAS_Image& output, CAS_State casState, const uint8_t* pDirty)
+    {
+        const uint32_t tileWidth = GetRunTileWidth();
+        const bool sharpenOnly = (casState == CAS_State_SharpenOnly);
+        const FrameView view = GetFullFrameView(input, output);
+        const uint32_t tilesX = (output.Width + tileWidth - 1) / tileWidth;
+        const uint32_t tilesY = (output.Height + m_tileHeight - 1) / m_tileHeight;
+
+        // Dirty tiles in traversal order.
+        UpdateTileOrder(tilesX, tilesY);
+        m_dirtyTiles.clear();
+        for (uint32_t item = 0; item < tilesX * tilesY; ++item)
+        {
+            const uint32_t tile = m_tileOrder.empty() ? item : m_tileOrder[item];
+            if (pDirty[tile])
+            {
+                m_dirtyTiles.push_back(tile);
+            }
+        }
+
+        m_threadPool.Run(static_cast<uint32_t>(m_dirtyTiles.size()), [&](uint32_t item, uint32_t threadIndex)
+        {
+            ProcessFrameTile(input, output, view, sharpenOnly, m_dirtyTiles[item], m_scratch[threadIndex]);
+        });
+        return static_cast<uint32_t>(m_dirtyTiles.size());
+    }
+
+    uint32_t CAS_Filter::UpscaleDamaged(const CAS_Image& input, const CAS_Image& output, CAS_State casState, const CAS_Rect* pDamage, uint32_t damageCount)
+    {
+        const uint32_t tileWidth = GetRunTileWidth();
+        if (casState == CAS_State_NoCas)
+        {
+            return 0;
+        }
+
+        // The output no longer matches the hashes of UpscaleChanged().
+        m_tileHashes.clear();
+
+        const bool sharpenOnly = (casState == CAS_State_SharpenOnly);
+        const uint32_t tilesX = (output.Width + tileWidth - 1) / tileWidth;
+        const uint32_t tilesY = (output.Height + m_tileHeight - 1) / m_tileHeight;
+        m_tileDirty.assign(tilesX * tilesY, 0);
+        for (uint32_t tile = 0; tile < tilesX * tilesY; ++tile)
+        {
+            const uint32_t dstX = (tile % tilesX) * tileWidth;
+            const uint32_t dstY = (tile / tilesX) * m_tileHeight;
+            const CAS_Rect tileRect = { dstX, dstY, std::min(tileWidth, output.Width - dstX), std::min(m_tileHeight, output.Height - dstY) };
+            const CAS_Rect footprint = GetFootprint(tileRect, sharpenOnly, input.Width, input.Height);
+            for (uint32_t i = 0; i < damageCount && !m_tileDirty[tile]; ++i)
+            {
+                m_tileDirty[tile] = CasRectsOverlap(footprint, pDamage[i]) ? 1 : 0;
+            }
+        }
+        return RunTiles(input, output, casState, m_tileDirty.data());
+    }
+
+    uint32_t CAS_Filter::UpscaleChanged(const CAS_Image& input, const CAS_Image& output, CAS_State casState)
+    {
+        const uint32_t tileWidth = GetRunTileWidth();
+        if (casState == CAS_State_NoCas)
+        {
+            return 0;
+        }
+
+        const bool sharpenOnly = (casState == CAS_State_SharpenOnly);
+        const uint32_t tilesX = (output.Width + tileWidth - 1) / tileWidth;
+        const uint32_t tilesY = (output.Height + m_tileHeight - 1) / m_tileHeight;
+        const uint32_t tileCount = tilesX * tilesY;
+
+        // Anything that changes the result of an unchanged footprint starts over with the whole frame.
+        struct
+        {
+            CASConstants    Consts;
+            uint32_t        Kernel[9];
+            float           FlatThreshold;
+            uint64_t        SharpnessMap[2];
+            uint32_t        Input[3];
+            uint32_t        Output[3];
+            const void     *pOutput;
+            const void     *pTransforms[2];
+        } settings;
+        memset(&settings, 0, sizeof(settings));
+        settings.Consts = m_consts;
+        settings.Kernel[0] = m_tier;
+        settings.Kernel[1] = m_variant;
+        settings.Kernel[2] = m_precision;
+        settings.Kernel[3] = m_classify ? 1 : 0;
+        settings.Kernel[4] = casState;
+        settings.Kernel[5] = tileWidth * 65536 + m_tileHeight;
+        settings.Kernel[6] = GetCascadePassCount();
+        settings.Kernel[7] = m_reduction * 65536 + m_reductionFactor;
+        settings.Kernel[8] = (m_alphaPassThrough ? 1 : 0) | (m_sharpenAlpha ? 2 : 0);
+        settings.FlatThreshold = m_flatThreshold;
+        settings.SharpnessMap[0] = m_sharpnessMapWidth * 65536ull + m_sharpnessMapHeight;
+        settings.SharpnessMap[1] = CasHashRows(reinterpret_cast<const uint8_t*>(m_sharpnessMap.data()), 0, m_sharpnessMap.size() * sizeof(float), 1, 0);
+        settings.Input[0] = input.Width;
+        settings.Input[1] = input.Height;
+        settings.Input[2] = input.Format;
+        settings.Output[0] = output.Width;
+        settings.Output[1] = output.Height;
+        settings.Output[2] = output.Format;
+        settings.pOutput = output.pData;
+        settings.pTransforms[0] = m_inputTransform;
+        settings.pTransforms[1] = m_outputTransform;
+        const uint64_t settingsHash = CasHashRows(reinterpret_cast<const uint8_t*>(&settings), 0, sizeof(settings), 1, 0);
+        const bool reset = m_tileHashes.size() != tileCount || m_tileHashSettings != settingsHash;
+        m_tileHashSettings = settingsHash;
+        m_tileHashes.resize(tileCount, 0);
+        m_tileDirty.resize(tileCount);
+
+        const uint32_t pixelSize = GetFormatSize(input.Format);
+        m_threadPool.Run(tileCount, [&](uint32_t tile, uint32_t)
+        {
+            const uint32_t dstX = (tile % tilesX) * tileWidth;
+            const uint32_t dstY = (tile / tilesX) * m_tileHeight;
+            const CAS_Rect tileRect = { dstX, dstY, std::min(tileWidth, output.Width - dstX), std::min(m_tileHeight, output.Height - dstY) };
+            const CAS_Rect footprint = GetFootprint(tileRect, sharpenOnly, input.Width, input.Height);
+            const uint8_t* pData = static_cast<const uint8_t*>(input.pData) + static_cast<size_t>(footprint.Y) * input.RowPitch + footprint.X * pixelSize;
+            const uint64_t hash = CasHashRows(pData, input.RowPitch, footprint.Width * pixelSize, footprint.Height, 0);
+            m_tileDirty[tile] = (reset || hash != m_tileHashes[tile]) ? 1 : 0;
+            m_tileHashes[tile] = hash;
+        });
+        return RunTiles(input, output, casState, m_tileDirty.data());
+    }
+}
@@ -0,0 +1,1126 @@
+//CAS Sample
+//
+// Copyright(c) 2019 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "CAS_CPU.h"
+
+//
+// The CasFilter() math of ffx_cas.h written once against a "lane" type so every tier (scalar, SSE2, AVX2) shares it.
+// A lane type V holds V::Width floats and provides:
+//   V::Load(p), V::Set(f), V::Gather(p, pIndex), v.Store(p), operators + - *,
+//   Min(), Max(), Sat(), Rcp(), Sqrt(), PrxLoRcp(), PrxMedRcp(), PrxLoSqrt() matching the ffx_a.h functions,
+//   V::LoadHalf(p), V::GatherHalf(p, pIndex), V::LoadUnorm16(p), V::GatherUnorm16(p, pIndex) widening 16-bit source
+//   texels to float (half conversion only needs to handle finite values).
+// Each tier translation unit defines its lane type, includes this file and instantiates CAS_MakeKernelTable<V>().
+//
+namespace CAS_SAMPLE_CPU
+{
+    // One tile of work. Source and output are planar R, G, B rows padded to a multiple of 8 texels, and A when alpha is
+    // passed through.
+    struct CAS_TileArgs
+    {
+        const void     *pSrc[4];        // Source window, already converted to linear {0 to 1}, stored as CAS_Precision.
+        uint32_t        SrcPitch;       // Texels per source window row.
+        float          *pDst[4];
+        uint32_t        DstPitch;       // Floats per output row.
+        uint32_t        Width;          // Output tile size in pixels.
+        uint32_t        Height;
+        float           Peak;           // Negative lobe from CasSetup(), const1.x.
+        // Sharpen only: output pixel (x,y) is centered on source window texel (x+1,y+1).
+        // Scaling: source window column/row of tap 'f' and bilinear fraction for each output column/row.
+        const int32_t  *pColumn;
+        const float    *pColumnFrac;
+        const int32_t  *pRow;
+        const float    *pRowFrac;
+    };
+
+    typedef void (*CAS_KernelFn)(const CAS_TileArgs& args);
+
+    // The main kernels filter 1 to 4 planes, the others R, G, B.
+    const uint32_t CasMaxChannels = 4;
+
+    // Runs a dense multiply-add loop and returns the number of float operations done, used to measure peak throughput.
+    typedef uint64_t (*CAS_PeakFn)(uint32_t iterations);
+
+    // Statistics of the source window texels [x0,x1) x [y0,y1), used to classify 8x8 output blocks.
+    struct CAS_BlockStats
+    {
+        float           Range;          // Largest max - min of a channel.
+        float           UnsaturatedG;   // Largest max(min(v, 1 - v), -v) of green, <= 0 when every texel is 0 or >= 1.
+        float           Unsaturated;    // Same over all channels, for CAS_SLOW.
+    };
+
+    // Returns early with the statistics of a few green probe texels when those already rule out a flat and a saturated
+    // block.
+    typedef void (*CAS_BlockStatsFn)(const void* const pSrc[3], uint32_t pitch, int32_t x0, int32_t x1, int32_t y0, int32_t y1, float flatThreshold, CAS_BlockStats& stats);
+
+    struct CAS_KernelTable
+    {
+        // Indexed by the channel count - 1 (CAS_Filter::FrameView::Channels), planes past the count are not touched.
+        CAS_KernelFn    SharpenOnly[CasMaxChannels][CAS_Precision_Count][CAS_Variant_Count];
+        CAS_KernelFn    Upsample[CasMaxChannels][CAS_Precision_Count][CAS_Variant_Count];
+        // Specialized kernels for classified 8x8 blocks, see CAS_Filter::ProcessTile().
+        CAS_KernelFn    SharpenFlat[CAS_Precision_Count][CAS_Variant_Count];
+        CAS_KernelFn    SharpenSaturated[CAS_Precision_Count][CAS_Variant_Count];
+        CAS_KernelFn    UpsampleFlat[CAS_Precision_Count][CAS_Variant_Count];
+        CAS_KernelFn    UpsampleSaturated[CAS_Precision_Count][CAS_Variant_Count];
+        // No CAS at all, for blocks a sharpness map switches off.
+        CAS_KernelFn    SharpenCopy[CAS_Precision_Count];
+        CAS_KernelFn    UpsampleBilinear[CAS_Precision_Count];
+        // Alpha pass-through, pSrc[3] into pDst[3].
+        CAS_KernelFn    SharpenAlpha[CAS_Precision_Count];
+        CAS_KernelFn    UpsampleAlpha[CAS_Precision_Count];
+        // Contrast map: per pixel contrast and lobe amplitude into pDst[0] and pDst[1] as sharpening sees them, indexed
+        // by CAS_BETTER_DIAGONALS, and the bilinear blend of those of the source texels when scaling.
+        CAS_KernelFn    Contrast[CAS_Precision_Count][2];
+        CAS_KernelFn    ContrastBlend;
+        CAS_BlockStatsFn BlockStats[CAS_Precision_Count];
+        CAS_PeakFn      Peak;
+    };
+
+    // Defined in the per tier translation units, return nullptr when the tier was not compiled in.
+    const CAS_KernelTable* CAS_GetKernelTableScalar();
+    const CAS_KernelTable* CAS_GetKernelTableSSE2();
+    const CAS_KernelTable* CAS_GetKernelTableAVX2();
+
+    // Table for a tier, nullptr when it was not compiled in or the CPU lacks the instructions.
+    const CAS_KernelTable* CAS_GetKernelTable(CAS_Tier tier);
+
+    // Half bits with the sign cleared and shifted left by 13 are a float with the exponent bias of a half, scaling by
+    // 2^(127-15) rebiases it. Exact for normals and denormals, which is all a {0 to 1} source window holds.
+    const float CasHalfRebias = 5.192296858534828e33f;
+
+    // Source window storage for each CAS_Precision, taps are widened to float as they are loaded.
+    struct CasSourceFP32
+    {
+        typedef float Type;
+        static float ToFloat(float v) { return v; }
+        template<typename V> static V Load(const float* p) { return V::Load(p); }
+        template<typename V> static V Gather(const float* p, const int32_t* pIndex) { return V::Gather(p, pIndex); }
+    };
+
+    struct CasSourceFP16
+    {
+        typedef uint16_t Type;
+        static float ToFloat(uint16_t h)
+        {
+            uint32_t magnitude = static_cast<uint32_t>(h & 0x7fffu) << 13, sign = static_cast<uint32_t>(h & 0x8000u) << 16;
+            float f;
+            memcpy(&f, &magnitude, sizeof(f));
+            f *= CasHalfRebias;
+            memcpy(&magnitude, &f, sizeof(f));
+            magnitude |= sign;
+            memcpy(&f, &magnitude, sizeof(f));
+            return f;
+        }
+        template<typename V> static V Load(const uint16_t* p) { return V::LoadHalf(p); }
+        template<typename V> static V Gather(const uint16_t* p, const int32_t* pIndex) { return V::GatherHalf(p, pIndex); }
+    };
+
+    struct CasSourceFixed16
+    {
+        typedef uint16_t Type;
+        static float ToFloat(uint16_t u) { return u * (1.0f / 65535.0f); }
+        template<typename V> static V Load(const uint16_t* p) { return V::LoadUnorm16(p); }
+        template<typename V> static V Gather(const uint16_t* p, const int32_t* pIndex) { return V::GatherUnorm16(p, pIndex); }
+    };
+
+    template<typename V>
+    struct CasTap
+    {
+        V r, g, b;
+    };
+
+    template<typename S>
+    inline const typename S::Type* CasSourcePlane(const CAS_TileArgs& args, int c)
+    {
+        return static_cast<const typename S::Type*>(args.pSrc[c]);
+    }
+
+    template<typename V, typename S>
+    inline CasTap<V> CasLoadTap(const CAS_TileArgs& args, uint32_t offset)
+    {
+        CasTap<V> tap = { S::template Load<V>(CasSourcePlane<S>(args, 0) + offset),
+                          S::template Load<V>(CasSourcePlane<S>(args, 1) + offset),
+                          S::template Load<V>(CasSourcePlane<S>(args, 2) + offset) };
+        return tap;
+    }
+
+    template<typename V, typename S>
+    inline CasTap<V> CasGatherTap(const CAS_TileArgs& args, int32_t offset, const int32_t* pColumn)
+    {
+        CasTap<V> tap = { S::template Gather<V>(CasSourcePlane<S>(args, 0) + offset, pColumn),
+                          S::template Gather<V>(CasSourcePlane<S>(args, 1) + offset, pColumn),
+                          S::template Gather<V>(CasSourcePlane<S>(args, 2) + offset, pColumn) };
+        return tap;
+    }
+
+    template<typename V>
+    inline V CasMin3(V x, V y, V z) { return Min(x, Min(y, z)); }
+
+    template<typename V>
+    inline V CasMax3(V x, V y, V z) { return Max(x, Max(y, z)); }
+
+    template<typename V, bool GoSlower>
+    inline V CasRcpLo(V x) { return GoSlower ? Rcp(x) : PrxLoRcp(x); }
+
+    template<typename V, bool GoSlower>
+    inline V CasRcpMed(V x) { return GoSlower ? Rcp(x) : PrxMedRcp(x); }
+
+    // Soft min and max of one channel.
+    //  a b c             b
+    //  d e f * 0.5  +  d e f * 0.5
+    //  g h i             h
+    // These are 2.0x bigger with CAS_BETTER_DIAGONALS (factored out the extra multiply), else just the 5-tap circle.
+    template<typename V, bool BetterDiagonals>
+    inline void CasSoftMinMax(V& mn, V& mx, V a, V b, V c, V d, V e, V f, V g, V h, V i)
+    {
+        mn = CasMin3(CasMin3(d, e, f), b, h);
+        mx = CasMax3(CasMax3(d, e, f), b, h);
+        if (BetterDiagonals)
+        {
+            mn = mn + CasMin3(CasMin3(mn, a, c), g, i);
+            mx = mx + CasMax3(CasMax3(mx, a, c), g, i);
+        }
+    }
+
+    // Smooth minimum distance to signal limit divided by smooth max, shaped and scaled into the negative lobe weight.
+    template<typename V, bool BetterDiagonals, bool GoSlower>
+    inline V CasLobeWeight(V mn, V mx, V peak)
+    {
+        V amp = Sat(Min(mn, V::Set(BetterDiagonals ? 2.0f : 1.0f) - mx) * CasRcpLo<V, GoSlower>(mx));
+        amp = GoSlower ? Sqrt(amp) : PrxLoSqrt(amp);
+        return amp * peak;
+    }
+
+    //==============================================================================================================
+    // No scaling algorithm uses minimal 3x3 pixel neighborhood.
+    //==============================================================================================================
+    template<typename V, typename S, bool BetterDiagonals, bool Slow, bool GoSlower>
+    void CasSharpenOnlyTile(const CAS_TileArgs& args)
+    {
+        const V peak = V::Set(args.Peak);
+        const V one = V::Set(1.0f);
+        const V four = V::Set(4.0f);
+        for (uint32_t y = 0; y < args.Height; ++y)
+        {
+            const uint32_t row0 = y * args.SrcPitch;
+            const uint32_t row1 = row0 + args.SrcPitch;
+            const uint32_t row2 = row1 + args.SrcPitch;
+            float* pOutR = args.pDst[0] + y * args.DstPitch;
+            float* pOutG = args.pDst[1] + y * args.DstPitch;
+            float* pOutB = args.pDst[2] + y * args.DstPitch;
+            for (uint32_t x = 0; x < args.Width; x += V::Width)
+            {
+                // a b c
+                // d e f
+                // g h i
+                CasTap<V> a = CasLoadTap<V, S>(args, row0 + x);
+                CasTap<V> b = CasLoadTap<V, S>(args, row0 + x + 1);
+                CasTap<V> c = CasLoadTap<V, S>(args, row0 + x + 2);
+                CasTap<V> d = CasLoadTap<V, S>(args, row1 + x);
+                CasTap<V> e = CasLoadTap<V, S>(args, row1 + x + 1);
+                CasTap<V> f = CasLoadTap<V, S>(args, row1 + x + 2);
+                CasTap<V> g = CasLoadTap<V, S>(args, row2 + x);
+                CasTap<V> h = CasLoadTap<V, S>(args, row2 + x + 1);
+                CasTap<V> i = CasLoadTap<V, S>(args, row2 + x + 2);
+
+                // Filter shape.
+                //  0 w 0
+                //  w 1 w
+                //  0 w 0
+                V mnG, mxG;
+                CasSoftMinMax<V, BetterDiagonals>(mnG, mxG, a.g, b.g, c.g, d.g, e.g, f.g, g.g, h.g, i.g);
+                V wG = CasLobeWeight<V, BetterDiagonals, GoSlower>(mnG, mxG, peak);
+                V rcpWeightG = CasRcpMed<V, GoSlower>(one + four * wG);
+
+                // Using green coef only unless CAS_SLOW.
+                V wR = wG, wB = wG;
+                V rcpWeightR = rcpWeightG, rcpWeightB = rcpWeightG;
+                if (Slow)
+                {
+                    V mnR, mxR, mnB, mxB;
+                    CasSoftMinMax<V, BetterDiagonals>(mnR, mxR, a.r, b.r, c.r, d.r, e.r, f.r, g.r, h.r, i.r);
+                    CasSoftMinMax<V, BetterDiagonals>(mnB, mxB, a.b, b.b, c.b, d.b, e.b, f.b, g.b, h.b, i.b);
+                    wR = CasLobeWeight<V, BetterDiagonals, GoSlower>(mnR, mxR, peak);
+                    wB = CasLobeWeight<V, BetterDiagonals, GoSlower>(mnB, mxB, peak);
+                    rcpWeightR = CasRcpMed<V, GoSlower>(one + four * wR);
+                    rcpWeightB = CasRcpMed<V, GoSlower>(one + four * wB);
+                }
+
+                Sat((b.r * wR + d.r * wR + f.r * wR + h.r * wR + e.r) * rcpWeightR).Store(pOutR + x);
+                Sat((b.g * wG + d.g * wG + f.g * wG + h.g * wG + e.g) * rcpWeightG).Store(pOutG + x);
+                Sat((b.b * wB + d.b * wB + f.b * wB + h.b * wB + e.b) * rcpWeightB).Store(pOutB + x);
+            }
+        }
+    }
+
+    //==============================================================================================================
+    // Scaling algorithm adaptively interpolates between nearest 4 results of the non-scaling algorithm.
+    //==============================================================================================================
+    template<typename V>
+    struct CasUpsampleWeights
+    {
+        V qbe, qch, qf, qg, qj, qk, qin, qlo, rcpW;
+    };
+
+    // Final weighting.
+    //    b c
+    //  e f g h
+    //  i j k l
+    //    n o
+    template<typename V, bool GoSlower>
+    inline CasUpsampleWeights<V> CasUpsampleWeigh(V wf, V wg, V wj, V wk, V s, V t, V u, V v)
+    {
+        CasUpsampleWeights<V> q;
+        q.qbe = wf * s;
+        q.qch = wg * t;
+        q.qf = wg * t + wj * u + s;
+        q.qg = wf * s + wk * v + t;
+        q.qj = wf * s + wk * v + u;
+        q.qk = wg * t + wj * u + v;
+        q.qin = wj * u;
+        q.qlo = wk * v;
+        const V two = V::Set(2.0f);
+        q.rcpW = CasRcpMed<V, GoSlower>(two * q.qbe + two * q.qch + two * q.qin + two * q.qlo + q.qf + q.qg + q.qj + q.qk);
+        return q;
+    }
+
+    template<typename V>
+    inline V CasUpsampleChannel(const CasUpsampleWeights<V>& q, V b, V c, V e, V f, V g, V h, V i, V j, V k, V l, V n, V o)
+    {
+        return Sat((b * q.qbe + e * q.qbe + c * q.qch + h * q.qch + i * q.qin + n * q.qin + l * q.qlo + o * q.qlo + f * q.qf + g * q.qg + j * q.qj + k * q.qk) * q.rcpW);
+    }
+
+    template<typename V, typename S, bool BetterDiagonals, bool Slow, bool GoSlower>
+    void CasUpsampleTile(const CAS_TileArgs& args)
+    {
+        const V peak = V::Set(args.Peak);
+        const V one = V::Set(1.0f);
+        const V thinB = V::Set(1.0f / 32.0f);
+        const int32_t pitch = static_cast<int32_t>(args.SrcPitch);
+        for (uint32_t y = 0; y < args.Height; ++y)
+        {
+            // Rows of taps a, e, i, m relative to the window, 'f' is on row1.
+            const int32_t row0 = (args.pRow[y] - 1) * pitch;
+            const int32_t row1 = row0 + pitch;
+            const int32_t row2 = row1 + pitch;
+            const int32_t row3 = row2 + pitch;
+            const V ppy = V::Set(args.pRowFrac[y]);
+            float* pOutR = args.pDst[0] + y * args.DstPitch;
+            float* pOutG = args.pDst[1] + y * args.DstPitch;
+            float* pOutB = args.pDst[2] + y * args.DstPitch;
+            for (uint32_t x = 0; x < args.Width; x += V::Width)
+            {
+                //  a b c d
+                //  e f g h
+                //  i j k l
+                //  m n o p
+                const int32_t* pColumn = args.pColumn + x;
+                CasTap<V> a = CasGatherTap<V, S>(args, row0 - 1, pColumn);
+                CasTap<V> b = CasGatherTap<V, S>(args, row0 + 0, pColumn);
+                CasTap<V> c = CasGatherTap<V, S>(args, row0 + 1, pColumn);
+                CasTap<V> d = CasGatherTap<V, S>(args, row0 + 2, pColumn);
+                CasTap<V> e = CasGatherTap<V, S>(args, row1 - 1, pColumn);
+                CasTap<V> f = CasGatherTap<V, S>(args, row1 + 0, pColumn);
+                CasTap<V> g = CasGatherTap<V, S>(args, row1 + 1, pColumn);
+                CasTap<V> h = CasGatherTap<V, S>(args, row1 + 2, pColumn);
+                CasTap<V> i = CasGatherTap<V, S>(args, row2 - 1, pColumn);
+                CasTap<V> j = CasGatherTap<V, S>(args, row2 + 0, pColumn);
+                CasTap<V> k = CasGatherTap<V, S>(args, row2 + 1, pColumn);
+                CasTap<V> l = CasGatherTap<V, S>(args, row2 + 2, pColumn);
+                CasTap<V> m = CasGatherTap<V, S>(args, row3 - 1, pColumn);
+                CasTap<V> n = CasGatherTap<V, S>(args, row3 + 0, pColumn);
+                CasTap<V> o = CasGatherTap<V, S>(args, row3 + 1, pColumn);
+                CasTap<V> p = CasGatherTap<V, S>(args, row3 + 2, pColumn);
+
+                // Soft min and max for the no-scaling results at [F], [G], [J] and [K].
+                V mnfG, mxfG, mngG, mxgG, mnjG, mxjG, mnkG, mxkG;
+                CasSoftMinMax<V, BetterDiagonals>(mnfG, mxfG, a.g, b.g, c.g, e.g, f.g, g.g, i.g, j.g, k.g);
+                CasSoftMinMax<V, BetterDiagonals>(mngG, mxgG, b.g, c.g, d.g, f.g, g.g, h.g, j.g, k.g, l.g);
+                CasSoftMinMax<V, BetterDiagonals>(mnjG, mxjG, e.g, f.g, g.g, i.g, j.g, k.g, m.g, n.g, o.g);
+                CasSoftMinMax<V, BetterDiagonals>(mnkG, mxkG, f.g, g.g, h.g, j.g, k.g, l.g, n.g, o.g, p.g);
+
+                // Blend between 4 results.
+                //  s t
+                //  u v
+                const V ppx = V::Load(args.pColumnFrac + x);
+                V s = (one - ppx) * (one - ppy);
+                V t = ppx * (one - ppy);
+                V u = (one - ppx) * ppy;
+                V v = ppx * ppy;
+
+                // Thin edges to hide bilinear interpolation (helps diagonals).
+                s = s * CasRcpLo<V, GoSlower>(thinB + (mxfG - mnfG));
+                t = t * CasRcpLo<V, GoSlower>(thinB + (mxgG - mngG));
+                u = u * CasRcpLo<V, GoSlower>(thinB + (mxjG - mnjG));
+                v = v * CasRcpLo<V, GoSlower>(thinB + (mxkG - mnkG));
+
+                CasUpsampleWeights<V> qG = CasUpsampleWeigh<V, GoSlower>(
+                    CasLobeWeight<V, BetterDiagonals, GoSlower>(mnfG, mxfG, peak),
+                    CasLobeWeight<V, BetterDiagonals, GoSlower>(mngG, mxgG, peak),
+                    CasLobeWeight<V, BetterDiagonals, GoSlower>(mnjG, mxjG, peak),
+                    CasLobeWeight<V, BetterDiagonals, GoSlower>(mnkG, mxkG, peak),
+                    s, t, u, v);
+
+                // Using green coef only unless CAS_SLOW.
+                CasUpsampleWeights<V> qR = qG, qB = qG;
+                if (Slow)
+                {
+                    V mnfR, mxfR, mngR, mxgR, mnjR, mxjR, mnkR, mxkR;
+                    CasSoftMinMax<V, BetterDiagonals>(mnfR, mxfR, a.r, b.r, c.r, e.r, f.r, g.r, i.r, j.r, k.r);
+                    CasSoftMinMax<V, BetterDiagonals>(mngR, mxgR, b.r, c.r, d.r, f.r, g.r, h.r, j.r, k.r, l.r);
+                    CasSoftMinMax<V, BetterDiagonals>(mnjR, mxjR, e.r, f.r, g.r, i.r, j.r, k.r, m.r, n.r, o.r);
+                    CasSoftMinMax<V, BetterDiagonals>(mnkR, mxkR, f.r, g.r, h.r, j.r, k.r, l.r, n.r, o.r, p.r);
+                    qR = CasUpsampleWeigh<V, GoSlower>(
+                        CasLobeWeight<V, BetterDiagonals, GoSlower>(mnfR, mxfR, peak),
+                        CasLobeWeight<V, BetterDiagonals, GoSlower>(mngR, mxgR, peak),
+                        CasLobeWeight<V, BetterDiagonals, GoSlower>(mnjR, mxjR, peak),
+                        CasLobeWeight<V, BetterDiagonals, GoSlower>(mnkR, mxkR, peak),
+                        s, t, u, v);
+
+                    V mnfB, mxfB, mngB, mxgB, mnjB, mxjB, mnkB, mxkB;
+                    CasSoftMinMax<V, BetterDiagonals>(mnfB, mxfB, a.b, b.b, c.b, e.b, f.b, g.b, i.b, j.b, k.b);
+                    CasSoftMinMax<V, BetterDiagonals>(mngB, mxgB, b.b, c.b, d.b, f.b, g.b, h.b, j.b, k.b, l.b);
+                    CasSoftMinMax<V, BetterDiagonals>(mnjB, mxjB, e.b, f.b, g.b, i.b, j.b, k.b, m.b, n.b, o.b);
+                    CasSoftMinMax<V, BetterDiagonals>(mnkB, mxkB, f.b, g.b, h.b, j.b, k.b, l.b, n.b, o.b, p.b);
+                    qB = CasUpsampleWeigh<V, GoSlower>(
+                        CasLobeWeight<V, BetterDiagonals, GoSlower>(mnfB, mxfB, peak),
+                        CasLobeWeight<V, BetterDiagonals, GoSlower>(mngB, mxgB, peak),
+                        CasLobeWeight<V, BetterDiagonals, GoSlower>(mnjB, mxjB, peak),
+                        CasLobeWeight<V, BetterDiagonals, GoSlower>(mnkB, mxkB, peak),
+                        s, t, u, v);
+                }
+
+                CasUpsampleChannel(qR, b.r, c.r, e.r, f.r, g.r, h.r, i.r, j.r, k.r, l.r, n.r, o.r).Store(pOutR + x);
+                CasUpsampleChannel(qG, b.g, c.g, e.g, f.g, g.g, h.g, i.g, j.g, k.g, l.g, n.g, o.g).Store(pOutG + x);
+                CasUpsampleChannel(qB, b.b, c.b, e.b, f.b, g.b, h.b, i.b, j.b, k.b, l.b, n.b, o.b).Store(pOutB + x);
+            }
+        }
+    }
+
+    //==============================================================================================================
+    // One to four channels, the RGB kernels above with a loop over the planes. Three channels take those, which keep the
+    // taps of all channels in flight at once and measured faster when scaling.
+    //==============================================================================================================
+    // Channel whose lobe weights every channel uses unless CAS_SLOW: green, or the first of one and two channel images
+    // (luma, grayscale, luma and alpha). Kernels filter it first, CasChannelOrder() is the channel filtered i-th.
+    template<uint32_t Channels>
+    inline uint32_t CasWeightChannel() { return Channels >= 3 ? 1 : 0; }
+
+    template<uint32_t Channels>
+    inline uint32_t CasChannelOrder(uint32_t i)
+    {
+        const uint32_t weighted = CasWeightChannel<Channels>();
+        return i == 0 ? weighted : (i <= weighted ? i - 1 : i);
+    }
+
+    template<typename V, typename S, uint32_t Channels, bool BetterDiagonals, bool Slow, bool GoSlower>
+    void CasSharpenOnlyChannelsTile(const CAS_TileArgs& args)
+    {
+        const V peak = V::Set(args.Peak);
+        const V one = V::Set(1.0f);
+        const V four = V::Set(4.0f);
+        for (uint32_t y = 0; y < args.Height; ++y)
+        {
+            const uint32_t row0 = y * args.SrcPitch;
+            const uint32_t row1 = row0 + args.SrcPitch;
+            const uint32_t row2 = row1 + args.SrcPitch;
+            const uint32_t out = y * args.DstPitch;
+            for (uint32_t x = 0; x < args.Width; x += V::Width)
+            {
+                V w, rcpWeight;
+                for (uint32_t i = 0; i < Channels; ++i)
+                {
+                    // a b c
+                    // d e f
+                    // g h i
+                    const uint32_t channel = CasChannelOrder<Channels>(i);
+                    const typename S::Type* p = CasSourcePlane<S>(args, channel) + x;
+                    V b = S::template Load<V>(p + row0 + 1);
+                    V d = S::template Load<V>(p + row1);
+                    V e = S::template Load<V>(p + row1 + 1);
+                    V f = S::template Load<V>(p + row1 + 2);
+                    V h = S::template Load<V>(p + row2 + 1);
+
+                    // Using the weighted channel's coef only unless CAS_SLOW.
+                    if (i == 0 || Slow)
+                    {
+                        // Filter shape.
+                        //  0 w 0
+                        //  w 1 w
+                        //  0 w 0
+                        V mn, mx;
+                        CasSoftMinMax<V, BetterDiagonals>(mn, mx, S::template Load<V>(p + row0), b, S::template Load<V>(p + row0 + 2), d, e, f,
+                                                          S::template Load<V>(p + row2), h, S::template Load<V>(p + row2 + 2));
+                        w = CasLobeWeight<V, BetterDiagonals, GoSlower>(mn, mx, peak);
+                        rcpWeight = CasRcpMed<V, GoSlower>(one + four * w);
+                    }
+
+                    Sat((b * w + d * w + f * w + h * w + e) * rcpWeight).Store(args.pDst[channel] + out + x);
+                }
+            }
+        }
+    }
+
+    template<typename V, typename S, uint32_t Channels, bool BetterDiagonals, bool Slow, bool GoSlower>
+    void CasUpsampleChannelsTile(const CAS_TileArgs& args)
+    {
+        const V peak = V::Set(args.Peak);
+        const V one = V::Set(1.0f);
+        const V thinB = V::Set(1.0f / 32.0f);
+        const int32_t pitch = static_cast<int32_t>(args.SrcPitch);
+        for (uint32_t y = 0; y < args.Height; ++y)
+        {
+            // Rows of taps a, e, i, m relative to the window, 'f' is on row1.
+            const int32_t row0 = (args.pRow[y] - 1) * pitch;
+            const int32_t row1 = row0 + pitch;
+            const int32_t row2 = row1 + pitch;
+            const int32_t row3 = row2 + pitch;
+            const V ppy = V::Set(args.pRowFrac[y]);
+            const uint32_t out = y * args.DstPitch;
+            for (uint32_t x = 0; x < args.Width; x += V::Width)
+            {
+                const int32_t* pColumn = args.pColumn + x;
+
+                // Blend between 4 results.
+                //  s t
+                //  u v
+                const V ppx = V::Load(args.pColumnFrac + x);
+                V s = (one - ppx) * (one - ppy);
+                V t = ppx * (one - ppy);
+                V u = (one - ppx) * ppy;
+                V v = ppx * ppy;
+
+                CasUpsampleWeights<V> q;
+                for (uint32_t ch = 0; ch < Channels; ++ch)
+                {
+                    //  a b c d
+                    //  e f g h
+                    //  i j k l
+                    //  m n o p
+                    const uint32_t channel = CasChannelOrder<Channels>(ch);
+                    const typename S::Type* p = CasSourcePlane<S>(args, channel);
+                    V b = S::template Gather<V>(p + row0 + 0, pColumn);
+                    V c = S::template Gather<V>(p + row0 + 1, pColumn);
+                    V e = S::template Gather<V>(p + row1 - 1, pColumn);
+                    V f = S::template Gather<V>(p + row1 + 0, pColumn);
+                    V g = S::template Gather<V>(p + row1 + 1, pColumn);
+                    V h = S::template Gather<V>(p + row1 + 2, pColumn);
+                    V i = S::template Gather<V>(p + row2 - 1, pColumn);
+                    V j = S::template Gather<V>(p + row2 + 0, pColumn);
+                    V k = S::template Gather<V>(p + row2 + 1, pColumn);
+                    V l = S::template Gather<V>(p + row2 + 2, pColumn);
+                    V n = S::template Gather<V>(p + row3 + 0, pColumn);
+                    V o = S::template Gather<V>(p + row3 + 1, pColumn);
+
+                    // Using the weighted channel's coef only unless CAS_SLOW, the thinning is always its own.
+                    if (ch == 0 || Slow)
+                    {
+                        V a = S::template Gather<V>(p + row0 - 1, pColumn);
+                        V d = S::template Gather<V>(p + row0 + 2, pColumn);
+                        V m = S::template Gather<V>(p + row3 - 1, pColumn);
+                        V pp = S::template Gather<V>(p + row3 + 2, pColumn);
+
+                        // Soft min and max for the no-scaling results at [F], [G], [J] and [K].
+                        V mnf, mxf, mng, mxg, mnj, mxj, mnk, mxk;
+                        CasSoftMinMax<V, BetterDiagonals>(mnf, mxf, a, b, c, e, f, g, i, j, k);
+                        CasSoftMinMax<V, BetterDiagonals>(mng, mxg, b, c, d, f, g, h, j, k, l);
+                        CasSoftMinMax<V, BetterDiagonals>(mnj, mxj, e, f, g, i, j, k, m, n, o);
+                        CasSoftMinMax<V, BetterDiagonals>(mnk, mxk, f, g, h, j, k, l, n, o, pp);
+
+                        // Thin edges to hide bilinear interpolation (helps diagonals).
+                        if (ch == 0)
+                        {
+                            s = s * CasRcpLo<V, GoSlower>(thinB + (mxf - mnf));
+                            t = t * CasRcpLo<V, GoSlower>(thinB + (mxg - mng));
+                            u = u * CasRcpLo<V, GoSlower>(thinB + (mxj - mnj));
+                            v = v * CasRcpLo<V, GoSlower>(thinB + (mxk - mnk));
+                        }
+
+                        q = CasUpsampleWeigh<V, GoSlower>(
+                            CasLobeWeight<V, BetterDiagonals, GoSlower>(mnf, mxf, peak),
+                            CasLobeWeight<V, BetterDiagonals, GoSlower>(mng, mxg, peak),
+                            CasLobeWeight<V, BetterDiagonals, GoSlower>(mnj, mxj, peak),
+                            CasLobeWeight<V, BetterDiagonals, GoSlower>(mnk, mxk, peak),
+                            s, t, u, v);
+                    }
+
+                    CasUpsampleChannel(q, b, c, e, f, g, h, i, j, k, l, n, o).Store(args.pDst[channel] + out + x);
+                }
+            }
+        }
+    }
+
+    //==============================================================================================================
+    // Specialized kernels for the block classes of CAS_Filter::ProcessTile().
+    // Flat blocks are constant over their whole source footprint (to within the flat threshold), so every tap of a
+    // neighborhood is replaced by its center (f g j k when scaling), which skips most loads and the soft min/max. The
+    // weights and reciprocals are the same as in the full kernels, with a threshold of 0 the result is bit identical in
+    // the Scalar and SSE2 tiers. The AVX2 tier is built with FMA, which contracts the multiply-adds of the two kernels
+    // differently, so its output differs in the last bits whenever classification is on (CAS_Bench --no-classify).
+    // Saturated blocks have every source texel at 0 or at or above 1 (green only, every channel with CAS_SLOW), so
+    // every neighborhood has min <= 0 or max >= 1 and the lobe weight is 0 (or below 1e-19 after APrxLoSqrtF1()).
+    //==============================================================================================================
+    template<typename V, bool BetterDiagonals, bool GoSlower>
+    inline V CasFlatLobeWeight(V center, V peak)
+    {
+        V mn, mx;
+        CasSoftMinMax<V, BetterDiagonals>(mn, mx, center, center, center, center, center, center, center, center, center);
+        return CasLobeWeight<V, BetterDiagonals, GoSlower>(mn, mx, peak);
+    }
+
+    template<typename V, typename S, bool BetterDiagonals, bool Slow, bool GoSlower>
+    void CasSharpenFlatTile(const CAS_TileArgs& args)
+    {
+        const V peak = V::Set(args.Peak);
+        const V one = V::Set(1.0f);
+        const V four = V::Set(4.0f);
+        for (uint32_t y = 0; y < args.Height; ++y)
+        {
+            const uint32_t row1 = (y + 1) * args.SrcPitch + 1;
+            float* pOutR = args.pDst[0] + y * args.DstPitch;
+            float* pOutG = args.pDst[1] + y * args.DstPitch;
+            float* pOutB = args.pDst[2] + y * args.DstPitch;
+            for (uint32_t x = 0; x < args.Width; x += V::Width)
+            {
+                CasTap<V> e = CasLoadTap<V, S>(args, row1 + x);
+                V wG = CasFlatLobeWeight<V, BetterDiagonals, GoSlower>(e.g, peak);
+                V wR = Slow ? CasFlatLobeWeight<V, BetterDiagonals, GoSlower>(e.r, peak) : wG;
+                V wB = Slow ? CasFlatLobeWeight<V, BetterDiagonals, GoSlower>(e.b, peak) : wG;
+                Sat((e.r * wR + e.r * wR + e.r * wR + e.r * wR + e.r) * CasRcpMed<V, GoSlower>(one + four * wR)).Store(pOutR + x);
+                Sat((e.g * wG + e.g * wG + e.g * wG + e.g * wG + e.g) * CasRcpMed<V, GoSlower>(one + four * wG)).Store(pOutG + x);
+                Sat((e.b * wB + e.b * wB + e.b * wB + e.b * wB + e.b) * CasRcpMed<V, GoSlower>(one + four * wB)).Store(pOutB + x);
+            }
+        }
+    }
+
+    // Zero lobe weight leaves the center texel.
+    template<typename V, typename S, bool GoSlower>
+    void CasSharpenSaturatedTile(const CAS_TileArgs& args)
+    {
+        const V rcpWeight = CasRcpMed<V, GoSlower>(V::Set(1.0f));
+        for (uint32_t y = 0; y < args.Height; ++y)
+        {
+            const uint32_t row1 = (y + 1) * args.SrcPitch + 1;
+            float* pOutR = args.pDst[0] + y * args.DstPitch;
+            float* pOutG = args.pDst[1] + y * args.DstPitch;
+            float* pOutB = args.pDst[2] + y * args.DstPitch;
+            for (uint32_t x = 0; x < args.Width; x += V::Width)
+            {
+                CasTap<V> e = CasLoadTap<V, S>(args, row1 + x);
+                Sat(e.r * rcpWeight).Store(pOutR + x);
+                Sat(e.g * rcpWeight).Store(pOutG + x);
+                Sat(e.b * rcpWeight).Store(pOutB + x);
+            }
+        }
+    }
+
+    // The outer taps take the value of the nearest of f g j k, and each of the 4 neighborhoods is flat around its center.
+    template<typename V, typename S, bool BetterDiagonals, bool Slow, bool GoSlower>
+    void CasUpsampleFlatTile(const CAS_TileArgs& args)
+    {
+        const V peak = V::Set(args.Peak);
+        const V one = V::Set(1.0f);
+        const V thin = CasRcpLo<V, GoSlower>(V::Set(1.0f / 32.0f));
+        const int32_t pitch = static_cast<int32_t>(args.SrcPitch);
+        for (uint32_t y = 0; y < args.Height; ++y)
+        {
+            const int32_t row1 = args.pRow[y] * pitch;
+            const int32_t row2 = row1 + pitch;
+            const V ppy = V::Set(args.pRowFrac[y]);
+            float* pOutR = args.pDst[0] + y * args.DstPitch;
+            float* pOutG = args.pDst[1] + y * args.DstPitch;
+            float* pOutB = args.pDst[2] + y * args.DstPitch;
+            for (uint32_t x = 0; x < args.Width; x += V::Width)
+            {
+                const int32_t* pColumn = args.pColumn + x;
+                CasTap<V> f = CasGatherTap<V, S>(args, row1 + 0, pColumn);
+                CasTap<V> g = CasGatherTap<V, S>(args, row1 + 1, pColumn);
+                CasTap<V> j = CasGatherTap<V, S>(args, row2 + 0, pColumn);
+                CasTap<V> k = CasGatherTap<V, S>(args, row2 + 1, pColumn);
+
+                const V ppx = V::Load(args.pColumnFrac + x);
+                V s = (one - ppx) * (one - ppy) * thin;
+                V t = ppx * (one - ppy) * thin;
+                V u = (one - ppx) * ppy * thin;
+                V v = ppx * ppy * thin;
+
+                CasUpsampleWeights<V> qG = CasUpsampleWeigh<V, GoSlower>(
+                    CasFlatLobeWeight<V, BetterDiagonals, GoSlower>(f.g, peak),
+                    CasFlatLobeWeight<V, BetterDiagonals, GoSlower>(g.g, peak),
+                    CasFlatLobeWeight<V, BetterDiagonals, GoSlower>(j.g, peak),
+                    CasFlatLobeWeight<V, BetterDiagonals, GoSlower>(k.g, peak),
+                    s, t, u, v);
+                CasUpsampleWeights<V> qR = qG, qB = qG;
+                if (Slow)
+                {
+                    qR = CasUpsampleWeigh<V, GoSlower>(
+                        CasFlatLobeWeight<V, BetterDiagonals, GoSlower>(f.r, peak),
+                        CasFlatLobeWeight<V, BetterDiagonals, GoSlower>(g.r, peak),
+                        CasFlatLobeWeight<V, BetterDiagonals, GoSlower>(j.r, peak),
+                        CasFlatLobeWeight<V, BetterDiagonals, GoSlower>(k.r, peak),
+                        s, t, u, v);
+                    qB = CasUpsampleWeigh<V, GoSlower>(
+                        CasFlatLobeWeight<V, BetterDiagonals, GoSlower>(f.b, peak),
+                        CasFlatLobeWeight<V, BetterDiagonals, GoSlower>(g.b, peak),
+                        CasFlatLobeWeight<V, BetterDiagonals, GoSlower>(j.b, peak),
+                        CasFlatLobeWeight<V, BetterDiagonals, GoSlower>(k.b, peak),
+                        s, t, u, v);
+                }
+
+                CasUpsampleChannel(qR, f.r, g.r, f.r, f.r, g.r, g.r, j.r, j.r, k.r, k.r, j.r, k.r).Store(pOutR + x);
+                CasUpsampleChannel(qG, f.g, g.g, f.g, f.g, g.g, g.g, j.g, j.g, k.g, k.g, j.g, k.g).Store(pOutG + x);
+                CasUpsampleChannel(qB, f.b, g.b, f.b, f.b, g.b, g.b, j.b, j.b, k.b, k.b, j.b, k.b).Store(pOutB + x);
+            }
+        }
+    }
+
+    // Zero lobe weights reduce the final weighting to the edge thinned blend of f g j k. Only green is needed for the
+    // thinning, the other 12 taps are not loaded for red and blue.
+    template<typename V, typename S, bool BetterDiagonals, bool GoSlower>
+    void CasUpsampleSaturatedTile(const CAS_TileArgs& args)
+    {
+        const V one = V::Set(1.0f);
+        const V thinB = V::Set(1.0f / 32.0f);
+        const int32_t pitch = static_cast<int32_t>(args.SrcPitch);
+        for (uint32_t y = 0; y < args.Height; ++y)
+        {
+            const int32_t row0 = (args.pRow[y] - 1) * pitch;
+            const int32_t row1 = row0 + pitch;
+            const int32_t row2 = row1 + pitch;
+            const int32_t row3 = row2 + pitch;
+            const V ppy = V::Set(args.pRowFrac[y]);
+            float* pOutR = args.pDst[0] + y * args.DstPitch;
+            float* pOutG = args.pDst[1] + y * args.DstPitch;
+            float* pOutB = args.pDst[2] + y * args.DstPitch;
+            for (uint32_t x = 0; x < args.Width; x += V::Width)
+            {
+                const int32_t* pColumn = args.pColumn + x;
+                const typename S::Type* pG = CasSourcePlane<S>(args, 1);
+                V a = S::template Gather<V>(pG + row0 - 1, pColumn), b = S::template Gather<V>(pG + row0, pColumn);
+                V c = S::template Gather<V>(pG + row0 + 1, pColumn), d = S::template Gather<V>(pG + row0 + 2, pColumn);
+                V e = S::template Gather<V>(pG + row1 - 1, pColumn), h = S::template Gather<V>(pG + row1 + 2, pColumn);
+                V i = S::template Gather<V>(pG + row2 - 1, pColumn), l = S::template Gather<V>(pG + row2 + 2, pColumn);
+                V m = S::template Gather<V>(pG + row3 - 1, pColumn), n = S::template Gather<V>(pG + row3, pColumn);
+                V o = S::template Gather<V>(pG + row3 + 1, pColumn), p = S::template Gather<V>(pG + row3 + 2, pColumn);
+                CasTap<V> f = CasGatherTap<V, S>(args, row1 + 0, pColumn);
+                CasTap<V> g = CasGatherTap<V, S>(args, row1 + 1, pColumn);
+                CasTap<V> j = CasGatherTap<V, S>(args, row2 + 0, pColumn);
+                CasTap<V> k = CasGatherTap<V, S>(args, row2 + 1, pColumn);
+
+                V mnf, mxf, mng, mxg, mnj, mxj, mnk, mxk;
+                CasSoftMinMax<V, BetterDiagonals>(mnf, mxf, a, b, c, e, f.g, g.g, i, j.g, k.g);
+                CasSoftMinMax<V, BetterDiagonals>(mng, mxg, b, c, d, f.g, g.g, h, j.g, k.g, l);
+                CasSoftMinMax<V, BetterDiagonals>(mnj, mxj, e, f.g, g.g, i, j.g, k.g, m, n, o);
+                CasSoftMinMax<V, BetterDiagonals>(mnk, mxk, f.g, g.g, h, j.g, k.g, l, n, o, p);
+
+                const V ppx = V::Load(args.pColumnFrac + x);
+                V s = (one - ppx) * (one - ppy) * CasRcpLo<V, GoSlower>(thinB + (mxf - mnf));
+                V t = ppx * (one - ppy) * CasRcpLo<V, GoSlower>(thinB + (mxg - mng));
+                V u = (one - ppx) * ppy * CasRcpLo<V, GoSlower>(thinB + (mxj - mnj));
+                V v = ppx * ppy * CasRcpLo<V, GoSlower>(thinB + (mxk - mnk));
+                V rcpW = CasRcpMed<V, GoSlower>(s + t + u + v);
+                Sat((f.r * s + g.r * t + j.r * u + k.r * v) * rcpW).Store(pOutR + x);
+                Sat((f.g * s + g.g * t + j.g * u + k.g * v) * rcpW).Store(pOutG + x);
+                Sat((f.b * s + g.b * t + j.b * u + k.b * v) * rcpW).Store(pOutB + x);
+            }
+        }
+    }
+
+    //==============================================================================================================
+    // CAS switched off: the saturated source texel, or the bilinear blend of f g j k when scaling.
+    //==============================================================================================================
+    template<typename V, typename S>
+    void CasSharpenCopyTile(const CAS_TileArgs& args)
+    {
+        for (uint32_t y = 0; y < args.Height; ++y)
+        {
+            const uint32_t row1 = (y + 1) * args.SrcPitch + 1;
+            float* pOutR = args.pDst[0] + y * args.DstPitch;
+            float* pOutG = args.pDst[1] + y * args.DstPitch;
+            float* pOutB = args.pDst[2] + y * args.DstPitch;
+            for (uint32_t x = 0; x < args.Width; x += V::Width)
+            {
+                CasTap<V> e = CasLoadTap<V, S>(args, row1 + x);
+                Sat(e.r).Store(pOutR + x);
+                Sat(e.g).Store(pOutG + x);
+                Sat(e.b).Store(pOutB + x);
+            }
+        }
+    }
+
+    template<typename V, typename S>
+    void CasUpsampleBilinearTile(const CAS_TileArgs& args)
+    {
+        const V one = V::Set(1.0f);
+        const int32_t pitch = static_cast<int32_t>(args.SrcPitch);
+        for (uint32_t y = 0; y < args.Height; ++y)
+        {
+            const int32_t row1 = args.pRow[y] * pitch;
+            const int32_t row2 = row1 + pitch;
+            const V ppy = V::Set(args.pRowFrac[y]);
+            float* pOutR = args.pDst[0] + y * args.DstPitch;
+            float* pOutG = args.pDst[1] + y * args.DstPitch;
+            float* pOutB = args.pDst[2] + y * args.DstPitch;
+            for (uint32_t x = 0; x < args.Width; x += V::Width)
+            {
+                const int32_t* pColumn = args.pColumn + x;
+                CasTap<V> f = CasGatherTap<V, S>(args, row1 + 0, pColumn);
+                CasTap<V> g = CasGatherTap<V, S>(args, row1 + 1, pColumn);
+                CasTap<V> j = CasGatherTap<V, S>(args, row2 + 0, pColumn);
+                CasTap<V> k = CasGatherTap<V, S>(args, row2 + 1, pColumn);
+                const V ppx = V::Load(args.pColumnFrac + x);
+                V s = (one - ppx) * (one - ppy);
+                V t = ppx * (one - ppy);
+                V u = (one - ppx) * ppy;
+                V v = ppx * ppy;
+                Sat(f.r * s + g.r * t + j.r * u + k.r * v).Store(pOutR + x);
+                Sat(f.g * s + g.g * t + j.g * u + k.g * v).Store(pOutG + x);
+                Sat(f.b * s + g.b * t + j.b * u + k.b * v).Store(pOutB + x);
+            }
+        }
+    }
+
+    //==============================================================================================================
+    // Alpha, see CAS_Filter::SetAlphaPassThrough(). Not sharpened: the center texel, or the plain bilinear blend of
+    // f g j k when scaling, the weights before CAS thins them.
+    //==============================================================================================================
+    template<typename V, typename S>
+    void CasSharpenAlphaTile(const CAS_TileArgs& args)
+    {
+        const typename S::Type* pA = CasSourcePlane<S>(args, 3);
+        for (uint32_t y = 0; y < args.Height; ++y)
+        {
+            const typename S::Type* pRow1 = pA + (y + 1) * args.SrcPitch + 1;
+            float* pOutA = args.pDst[3] + y * args.DstPitch;
+            for (uint32_t x = 0; x < args.Width; x += V::Width)
+            {
+                Sat(S::template Load<V>(pRow1 + x)).Store(pOutA + x);
+            }
+        }
+    }
+
+    template<typename V, typename S>
+    void CasUpsampleAlphaTile(const CAS_TileArgs& args)
+    {
+        const V one = V::Set(1.0f);
+        const typename S::Type* pA = CasSourcePlane<S>(args, 3);
+        const int32_t pitch = static_cast<int32_t>(args.SrcPitch);
+        for (uint32_t y = 0; y < args.Height; ++y)
+        {
+            const int32_t row1 = args.pRow[y] * pitch;
+            const int32_t row2 = row1 + pitch;
+            const V ppy = V::Set(args.pRowFrac[y]);
+            float* pOutA = args.pDst[3] + y * args.DstPitch;
+            for (uint32_t x = 0; x < args.Width; x += V::Width)
+            {
+                const int32_t* pColumn = args.pColumn + x;
+                const V ppx = V::Load(args.pColumnFrac + x);
+                V s = (one - ppx) * (one - ppy);
+                V t = ppx * (one - ppy);
+                V u = (one - ppx) * ppy;
+                V v = ppx * ppy;
+                Sat(S::template Gather<V>(pA + row1, pColumn) * s + S::template Gather<V>(pA + row1 + 1, pColumn) * t +
+                    S::template Gather<V>(pA + row2, pColumn) * u + S::template Gather<V>(pA + row2 + 1, pColumn) * v).Store(pOutA + x);
+            }
+        }
+    }
+
+    //==============================================================================================================
+    // Contrast map, see CAS_Filter::SetContrastMap(). Per pixel soft max - min of green into pDst[0] and the amplitude
+    // of the negative lobe (before the sharpness) into pDst[1], with the reciprocal and square root approximations of
+    // the default variant so every variant gives the same map.
+    //==============================================================================================================
+    template<typename V, bool BetterDiagonals>
+    inline void CasContrast(V& contrast, V& amplitude, V mn, V mx)
+    {
+        contrast = (mx - mn) * V::Set(BetterDiagonals ? 0.5f : 1.0f);
+        amplitude = CasLobeWeight<V, BetterDiagonals, false>(mn, mx, V::Set(1.0f));
+    }
+
+    template<typename V, typename S, bool BetterDiagonals>
+    void CasContrastTile(const CAS_TileArgs& args)
+    {
+        const typename S::Type* pG = CasSourcePlane<S>(args, 1);
+        for (uint32_t y = 0; y < args.Height; ++y)
+        {
+            const typename S::Type* pRow0 = pG + y * args.SrcPitch;
+            const typename S::Type* pRow1 = pRow0 + args.SrcPitch;
+            const typename S::Type* pRow2 = pRow1 + args.SrcPitch;
+            float* pContrast = args.pDst[0] + y * args.DstPitch;
+            float* pAmplitude = args.pDst[1] + y * args.DstPitch;
+            for (uint32_t x = 0; x < args.Width; x += V::Width)
+            {
+                V mn, mx, contrast, amplitude;
+                CasSoftMinMax<V, BetterDiagonals>(mn, mx,
+                    S::template Load<V>(pRow0 + x), S::template Load<V>(pRow0 + x + 1), S::template Load<V>(pRow0 + x + 2),
+                    S::template Load<V>(pRow1 + x), S::template Load<V>(pRow1 + x + 1), S::template Load<V>(pRow1 + x + 2),
+                    S::template Load<V>(pRow2 + x), S::template Load<V>(pRow2 + x + 1), S::template Load<V>(pRow2 + x + 2));
+                CasContrast<V, BetterDiagonals>(contrast, amplitude, mn, mx);
+                contrast.Store(pContrast + x);
+                amplitude.Store(pAmplitude + x);
+            }
+        }
+    }
+
+    // Scaling: bilinear blend of the contrast and amplitude of the 4 source texels, computed once per texel of the
+    // window into the FP32 planes pSrc[0] and pSrc[1].
+    template<typename V>
+    void CasContrastBlendTile(const CAS_TileArgs& args)
+    {
+        const V one = V::Set(1.0f);
+        const int32_t pitch = static_cast<int32_t>(args.SrcPitch);
+        const float* pContrastIn = static_cast<const float*>(args.pSrc[0]);
+        const float* pAmplitudeIn = static_cast<const float*>(args.pSrc[1]);
+        for (uint32_t y = 0; y < args.Height; ++y)
+        {
+            const int32_t row1 = args.pRow[y] * pitch;
+            const int32_t row2 = row1 + pitch;
+            const V ppy = V::Set(args.pRowFrac[y]);
+            float* pContrast = args.pDst[0] + y * args.DstPitch;
+            float* pAmplitude = args.pDst[1] + y * args.DstPitch;
+            for (uint32_t x = 0; x < args.Width; x += V::Width)
+            {
+                const int32_t* pColumn = args.pColumn + x;
+                const V ppx = V::Load(args.pColumnFrac + x);
+                V s = (one - ppx) * (one - ppy);
+                V t = ppx * (one - ppy);
+                V u = (one - ppx) * ppy;
+                V v = ppx * ppy;
+                (V::Gather(pContrastIn + row1, pColumn) * s + V::Gather(pContrastIn + row1 + 1, pColumn) * t +
+                 V::Gather(pContrastIn + row2, pColumn) * u + V::Gather(pContrastIn + row2 + 1, pColumn) * v).Store(pContrast + x);
+                (V::Gather(pAmplitudeIn + row1, pColumn) * s + V::Gather(pAmplitudeIn + row1 + 1, pColumn) * t +
+                 V::Gather(pAmplitudeIn + row2, pColumn) * u + V::Gather(pAmplitudeIn + row2 + 1, pColumn) * v).Store(pAmplitude + x);
+            }
+        }
+    }
+
+    //==============================================================================================================
+    // Block statistics. Rows are covered by whole vectors, the last one ending at x1 overlaps the previous one.
+    //==============================================================================================================
+    template<typename V>
+    inline V CasUnsaturated(V v, V one) { return Max(Min(v, one - v), V::Set(0.0f) - v); }
+
+    template<typename V, typename S>
+    void CasBlockStatsTile(const void* const pSrc[3], uint32_t pitch, int32_t x0, int32_t x1, int32_t y0, int32_t y1, float flatThreshold, CAS_BlockStats& stats)
+    {
+        const int32_t stride = static_cast<int32_t>(pitch);
+        const typename S::Type* pPlane[3];
+        for (uint32_t c = 0; c < 3; ++c)
+        {
+            pPlane[c] = static_cast<const typename S::Type*>(pSrc[c]);
+        }
+
+        // Probe green at the corners and the center, on textured content that is all it takes.
+        {
+            const int32_t probe[5] = { y0 * stride + x0, y0 * stride + x1 - 1, ((y0 + y1) / 2) * stride + (x0 + x1) / 2, (y1 - 1) * stride + x0, (y1 - 1) * stride + x1 - 1 };
+            float mn = S::ToFloat(pPlane[1][probe[0]]), mx = mn, unsaturated = std::max(std::min(mn, 1.0f - mn), -mn);
+            for (uint32_t i = 1; i < 5; ++i)
+            {
+                const float v = S::ToFloat(pPlane[1][probe[i]]);
+                mn = std::min(mn, v);
+                mx = std::max(mx, v);
+                unsaturated = std::max(unsaturated, std::max(std::min(v, 1.0f - v), -v));
+            }
+            if (mx - mn > flatThreshold && unsaturated > 0.0f)
+            {
+                stats.Range = mx - mn;
+                stats.UnsaturatedG = stats.Unsaturated = unsaturated;
+                return;
+            }
+        }
+
+        const int32_t width = static_cast<int32_t>(V::Width);
+        if (x1 - x0 < width)
+        {
+            // Narrower than a vector, only for tiny images.
+            stats.Range = stats.UnsaturatedG = stats.Unsaturated = -1.0f;
+            for (uint32_t c = 0; c < 3; ++c)
+            {
+                float mn = S::ToFloat(pPlane[c][y0 * stride + x0]), mx = mn;
+                for (int32_t y = y0; y < y1; ++y)
+                {
+                    for (int32_t x = x0; x < x1; ++x)
+                    {
+                        const float v = S::ToFloat(pPlane[c][y * stride + x]);
+                        const float unsaturated = std::max(std::min(v, 1.0f - v), -v);
+                        mn = std::min(mn, v);
+                        mx = std::max(mx, v);
+                        stats.Unsaturated = std::max(stats.Unsaturated, unsaturated);
+                        stats.UnsaturatedG = c == 1 ? std::max(stats.UnsaturatedG, unsaturated) : stats.UnsaturatedG;
+                    }
+                }
+                stats.Range = std::max(stats.Range, mx - mn);
+            }
+            return;
+        }
+
+        // Whole vectors per row, the last one ends at x1 and overlaps the previous one.
+        const V one = V::Set(1.0f);
+        V mn[3], mx[3], unsaturated[3];
+        for (uint32_t c = 0; c < 3; ++c)
+        {
+            mn[c] = mx[c] = S::template Load<V>(pPlane[c] + y0 * stride + x0);
+            unsaturated[c] = CasUnsaturated(mn[c], one);
+        }
+        for (int32_t y = y0; y < y1; ++y)
+        {
+            for (int32_t x = x0; ; x += width)
+            {
+                const int32_t load = std::min(x, x1 - width);
+                for (uint32_t c = 0; c < 3; ++c)
+                {
+                    V v = S::template Load<V>(pPlane[c] + y * stride + load);
+                    mn[c] = Min(mn[c], v);
+                    mx[c] = Max(mx[c], v);
+                    unsaturated[c] = Max(unsaturated[c], CasUnsaturated(v, one));
+                }
+                if (load == x1 - width)
+                {
+                    break;
+                }
+            }
+        }
+
+        float lanes[3][V::Width];
+        CasMax3(mx[0] - mn[0], mx[1] - mn[1], mx[2] - mn[2]).Store(lanes[0]);
+        unsaturated[1].Store(lanes[1]);
+        CasMax3(unsaturated[0], unsaturated[1], unsaturated[2]).Store(lanes[2]);
+        stats.Range = lanes[0][0];
+        stats.UnsaturatedG = lanes[1][0];
+        stats.Unsaturated = lanes[2][0];
+        for (uint32_t i = 1; i < V::Width; ++i)
+        {
+            stats.Range = std::max(stats.Range, lanes[0][i]);
+            stats.UnsaturatedG = std::max(stats.UnsaturatedG, lanes[1][i]);
+            stats.Unsaturated = std::max(stats.Unsaturated, lanes[2][i]);
+        }
+    }
+
+    //==============================================================================================================
+    // Peak throughput, 8 independent multiply-add chains so latency is hidden.
+    //==============================================================================================================
+    template<typename V>
+    uint64_t CasPeakLoop(uint32_t iterations)
+    {
+        const V m = V::Set(0.999999f);
+        const V k = V::Set(1.0e-6f);
+        V acc0 = V::Set(0.1f), acc1 = V::Set(0.2f), acc2 = V::Set(0.3f), acc3 = V::Set(0.4f);
+        V acc4 = V::Set(0.5f), acc5 = V::Set(0.6f), acc6 = V::Set(0.7f), acc7 = V::Set(0.8f);
+        for (uint32_t i = 0; i < iterations; ++i)
+        {
+            acc0 = acc0 * m + k; acc1 = acc1 * m + k; acc2 = acc2 * m + k; acc3 = acc3 * m + k;
+            acc4 = acc4 * m + k; acc5 = acc5 * m + k; acc6 = acc6 * m + k; acc7 = acc7 * m + k;
+        }
+
+        // Keep the result alive.
+        float sink[V::Width];
+        ((acc0 + acc1) + (acc2 + acc3) + ((acc4 + acc5) + (acc6 + acc7))).Store(sink);
+        volatile float keep = sink[0];
+        (void)keep;
+        return static_cast<uint64_t>(iterations) * 8 * 2 * V::Width;
+    }
+
+    template<typename V, uint32_t Variant, uint32_t Channels>
+    inline void CasFillChannelKernels(CAS_KernelTable& table)
+    {
+        const bool betterDiagonals = (Variant & CAS_Variant_BetterDiagonals) != 0;
+        const bool slow = (Variant & CAS_Variant_Slow) != 0;
+        const bool goSlower = (Variant & CAS_Variant_GoSlower) != 0;
+        table.SharpenOnly[Channels - 1][CAS_Precision_FP32][Variant] = &CasSharpenOnlyChannelsTile<V, CasSourceFP32, Channels, betterDiagonals, slow, goSlower>;
+        table.SharpenOnly[Channels - 1][CAS_Precision_FP16][Variant] = &CasSharpenOnlyChannelsTile<V, CasSourceFP16, Channels, betterDiagonals, slow, goSlower>;
+        table.SharpenOnly[Channels - 1][CAS_Precision_Fixed16][Variant] = &CasSharpenOnlyChannelsTile<V, CasSourceFixed16, Channels, betterDiagonals, slow, goSlower>;
+        table.Upsample[Channels - 1][CAS_Precision_FP32][Variant] = &CasUpsampleChannelsTile<V, CasSourceFP32, Channels, betterDiagonals, slow, goSlower>;
+        table.Upsample[Channels - 1][CAS_Precision_FP16][Variant] = &CasUpsampleChannelsTile<V, CasSourceFP16, Channels, betterDiagonals, slow, goSlower>;
+        table.Upsample[Channels - 1][CAS_Precision_Fixed16][Variant] = &CasUpsampleChannelsTile<V, CasSourceFixed16, Channels, betterDiagonals, slow, goSlower>;
+    }
+
+    template<typename V, uint32_t Variant>
+    inline void CasFillKernelTable(CAS_KernelTable& table)
+    {
+        const bool betterDiagonals = (Variant & CAS_Variant_BetterDiagonals) != 0;
+        const bool slow = (Variant & CAS_Variant_Slow) != 0;
+        const bool goSlower = (Variant & CAS_Variant_GoSlower) != 0;
+        table.SharpenOnly[2][CAS_Precision_FP32][Variant] = &CasSharpenOnlyTile<V, CasSourceFP32, betterDiagonals, slow, goSlower>;
+        table.SharpenOnly[2][CAS_Precision_FP16][Variant] = &CasSharpenOnlyTile<V, CasSourceFP16, betterDiagonals, slow, goSlower>;
+        table.SharpenOnly[2][CAS_Precision_Fixed16][Variant] = &CasSharpenOnlyTile<V, CasSourceFixed16, betterDiagonals, slow, goSlower>;
+        table.Upsample[2][CAS_Precision_FP32][Variant] = &CasUpsampleTile<V, CasSourceFP32, betterDiagonals, slow, goSlower>;
+        table.Upsample[2][CAS_Precision_FP16][Variant] = &CasUpsampleTile<V, CasSourceFP16, betterDiagonals, slow, goSlower>;
+        table.Upsample[2][CAS_Precision_Fixed16][Variant] = &CasUpsampleTile<V, CasSourceFixed16, betterDiagonals, slow, goSlower>;
+        CasFillChannelKernels<V, Variant, 1>(table);
+        CasFillChannelKernels<V, Variant, 2>(table);
+        CasFillChannelKernels<V, Variant, 4>(table);
+        table.SharpenFlat[CAS_Precision_FP32][Variant] = &CasSharpenFlatTile<V, CasSourceFP32, betterDiagonals, slow, goSlower>;
+        table.SharpenFlat[CAS_Precision_FP16][Variant] = &CasSharpenFlatTile<V, CasSourceFP16, betterDiagonals, slow, goSlower>;
+        table.SharpenFlat[CAS_Precision_Fixed16][Variant] = &CasSharpenFlatTile<V, CasSourceFixed16, betterDiagonals, slow, goSlower>;
+        table.SharpenSaturated[CAS_Precision_FP32][Variant] = &CasSharpenSaturatedTile<V, CasSourceFP32, goSlower>;
+        table.SharpenSaturated[CAS_Precision_FP16][Variant] = &CasSharpenSaturatedTile<V, CasSourceFP16, goSlower>;
+        table.SharpenSaturated[CAS_Precision_Fixed16][Variant] = &CasSharpenSaturatedTile<V, CasSourceFixed16, goSlower>;
+        table.UpsampleFlat[CAS_Precision_FP32][Variant] = &CasUpsampleFlatTile<V, CasSourceFP32, betterDiagonals, slow, goSlower>;
+        table.UpsampleFlat[CAS_Precision_FP16][Variant] = &CasUpsampleFlatTile<V, CasSourceFP16, betterDiagonals, slow, goSlower>;
+        table.UpsampleFlat[CAS_Precision_Fixed16][Variant] = &CasUpsampleFlatTile<V, CasSourceFixed16, betterDiagonals, slow, goSlower>;
+        table.UpsampleSaturated[CAS_Precision_FP32][Variant] = &CasUpsampleSaturatedTile<V, CasSourceFP32, betterDiagonals, goSlower>;
+        table.UpsampleSaturated[CAS_Precision_FP16][Variant] = &CasUpsampleSaturatedTile<V, CasSourceFP16, betterDiagonals, goSlower>;
+        table.UpsampleSaturated[CAS_Precision_Fixed16][Variant] = &CasUpsampleSaturatedTile<V, CasSourceFixed16, betterDiagonals, goSlower>;
+    }
+
+    template<typename V>
+    inline CAS_KernelTable CAS_MakeKernelTable()
+    {
+        CAS_KernelTable table = {};
+        CasFillKernelTable<V, 0>(table);
+        CasFillKernelTable<V, 1>(table);
+        CasFillKernelTable<V, 2>(table);
+        CasFillKernelTable<V, 3>(table);
+        CasFillKernelTable<V, 4>(table);
+        CasFillKernelTable<V, 5>(table);
+        CasFillKernelTable<V, 6>(table);
+        CasFillKernelTable<V, 7>(table);
+        table.SharpenCopy[CAS_Precision_FP32] = &CasSharpenCopyTile<V, CasSourceFP32>;
+        table.SharpenCopy[CAS_Precision_FP16] = &CasSharpenCopyTile<V, CasSourceFP16>;
+        table.SharpenCopy[CAS_Precision_Fixed16] = &CasSharpenCopyTile<V, CasSourceFixed16>;
+        table.UpsampleBilinear[CAS_Precision_FP32] = &CasUpsampleBilinearTile<V, CasSourceFP32>;
+        table.UpsampleBilinear[CAS_Precision_FP16] = &CasUpsampleBilinearTile<V, CasSourceFP16>;
+        table.UpsampleBilinear[CAS_Precision_Fixed16] = &CasUpsampleBilinearTile<V, CasSourceFixed16>;
+        table.SharpenAlpha[CAS_Precision_FP32] = &CasSharpenAlphaTile<V, CasSourceFP32>;
+        table.SharpenAlpha[CAS_Precision_FP16] = &CasSharpenAlphaTile<V, CasSourceFP16>;
+        table.SharpenAlpha[CAS_Precision_Fixed16] = &CasSharpenAlphaTile<V, CasSourceFixed16>;
+        table.UpsampleAlpha[CAS_Precision_FP32] = &CasUpsampleAlphaTile<V, CasSourceFP32>;
+        table.UpsampleAlpha[CAS_Precision_FP16] = &CasUpsampleAlphaTile<V, CasSourceFP16>;
+        table.UpsampleAlpha[CAS_Precision_Fixed16] = &CasUpsampleAlphaTile<V, CasSourceFixed16>;
+        table.Contrast[CAS_Precision_FP32][0] = &CasContrastTile<V, CasSourceFP32, false>;
+        table.Contrast[CAS_Precision_FP16][0] = &CasContrastTile<V, CasSourceFP16, false>;
+        table.Contrast[CAS_Precision_Fixed16][0] = &CasContrastTile<V, CasSourceFixed16, false>;
+        table.Contrast[CAS_Precision_FP32][1] = &CasContrastTile<V, CasSourceFP32, true>;
+        table.Contrast[CAS_Precision_FP16][1] = &CasContrastTile<V, CasSourceFP16, true>;
+        table.Contrast[CAS_Precision_Fixed16][1] = &CasContrastTile<V, CasSourceFixed16, true>;
+        table.ContrastBlend = &CasContrastBlendTile<V>;
+        table.BlockStats[CAS_Precision_FP32] = &CasBlockStatsTile<V, CasSourceFP32>;
+        table.BlockStats[CAS_Precision_FP16] = &CasBlockStatsTile<V, CasSourceFP16>;
+        table.BlockStats[CAS_Precision_Fixed16] = &CasBlockStatsTile<V, CasSourceFixed16>;
+        table.Peak = &CasPeakLoop<V>;
+        return table;
+    }
+}
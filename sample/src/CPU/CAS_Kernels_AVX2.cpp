@@ -0,0 +1,112 @@
+//CAS Sample
+//
+// Copyright(c) 2019 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "CAS_Kernels.h"
+
+// This file is built with AVX2 and FMA code generation enabled (see CMakeLists.txt),
+// the filter only calls into it after checking the CPU supports both.
+#if defined(_M_X64) || defined(__x86_64__)
+#define CAS_KERNELS_AVX2 1
+#include <immintrin.h>
+#endif
+
+namespace CAS_SAMPLE_CPU
+{
+#ifdef CAS_KERNELS_AVX2
+    // 8 pixels per iteration, uses the hardware gather for the scaling taps.
+    struct CasLaneAVX2
+    {
+        static const uint32_t Width = 8;
+
+        __m256 v;
+
+        static CasLaneAVX2 Load(const float* p) { CasLaneAVX2 r = { _mm256_loadu_ps(p) }; return r; }
+        static CasLaneAVX2 Set(float f) { CasLaneAVX2 r = { _mm256_set1_ps(f) }; return r; }
+        static CasLaneAVX2 Gather(const float* p, const int32_t* pIndex)
+        {
+            CasLaneAVX2 r = { _mm256_i32gather_ps(p, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pIndex)), 4) };
+            return r;
+        }
+        void Store(float* p) const { _mm256_storeu_ps(p, v); }
+
+        static CasLaneAVX2 LoadHalf(const uint16_t* p) { return FromHalf(Widen(p)); }
+        static CasLaneAVX2 GatherHalf(const uint16_t* p, const int32_t* pIndex) { return FromHalf(Gather16(p, pIndex)); }
+        static CasLaneAVX2 LoadUnorm16(const uint16_t* p) { return FromUnorm16(Widen(p)); }
+        static CasLaneAVX2 GatherUnorm16(const uint16_t* p, const int32_t* pIndex) { return FromUnorm16(Gather16(p, pIndex)); }
+
+        static __m256i Widen(const uint16_t* p) { return _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))); }
+        // 32-bit gather at 2 byte scale and keep the low half, reads one texel past the last index (the window is padded).
+        static __m256i Gather16(const uint16_t* p, const int32_t* pIndex)
+        {
+            __m256i index = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pIndex));
+            return _mm256_and_si256(_mm256_i32gather_epi32(reinterpret_cast<const int*>(p), index, 2), _mm256_set1_epi32(0xffff));
+        }
+        static CasLaneAVX2 FromHalf(__m256i u32)
+        {
+            __m256 magnitude = _mm256_mul_ps(_mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(u32, _mm256_set1_epi32(0x7fff)), 13)), _mm256_set1_ps(CasHalfRebias));
+            __m256i sign = _mm256_slli_epi32(_mm256_and_si256(u32, _mm256_set1_epi32(0x8000)), 16);
+            CasLaneAVX2 r = { _mm256_or_ps(magnitude, _mm256_castsi256_ps(sign)) };
+            return r;
+        }
+        static CasLaneAVX2 FromUnorm16(__m256i u32)
+        {
+            CasLaneAVX2 r = { _mm256_mul_ps(_mm256_cvtepi32_ps(u32), _mm256_set1_ps(1.0f / 65535.0f)) };
+            return r;
+        }
+    };
+
+    static inline CasLaneAVX2 CasLane(__m256 v) { CasLaneAVX2 r = { v }; return r; }
+
+    static inline CasLaneAVX2 operator+(CasLaneAVX2 a, CasLaneAVX2 b) { return CasLane(_mm256_add_ps(a.v, b.v)); }
+    static inline CasLaneAVX2 operator-(CasLaneAVX2 a, CasLaneAVX2 b) { return CasLane(_mm256_sub_ps(a.v, b.v)); }
+    static inline CasLaneAVX2 operator*(CasLaneAVX2 a, CasLaneAVX2 b) { return CasLane(_mm256_mul_ps(a.v, b.v)); }
+    static inline CasLaneAVX2 Min(CasLaneAVX2 a, CasLaneAVX2 b) { return CasLane(_mm256_min_ps(a.v, b.v)); }
+    static inline CasLaneAVX2 Max(CasLaneAVX2 a, CasLaneAVX2 b) { return CasLane(_mm256_max_ps(a.v, b.v)); }
+    // Value first so a NaN (0 * rcp(0) from an all black neighborhood with CAS_GO_SLOWER) becomes 0 like GPU saturate().
+    static inline CasLaneAVX2 Sat(CasLaneAVX2 a) { return CasLane(_mm256_min_ps(_mm256_max_ps(a.v, _mm256_setzero_ps()), _mm256_set1_ps(1.0f))); }
+    static inline CasLaneAVX2 Rcp(CasLaneAVX2 a) { return CasLane(_mm256_div_ps(_mm256_set1_ps(1.0f), a.v)); }
+    static inline CasLaneAVX2 Sqrt(CasLaneAVX2 a) { return CasLane(_mm256_sqrt_ps(a.v)); }
+
+    // Same bit tricks as APrxLoRcpF1(), APrxMedRcpF1() and APrxLoSqrtF1() in ffx_a.h.
+    static inline CasLaneAVX2 PrxLoRcp(CasLaneAVX2 a)
+    {
+        return CasLane(_mm256_castsi256_ps(_mm256_sub_epi32(_mm256_set1_epi32(0x7ef07ebb), _mm256_castps_si256(a.v))));
+    }
+    static inline CasLaneAVX2 PrxMedRcp(CasLaneAVX2 a)
+    {
+        __m256 b = _mm256_castsi256_ps(_mm256_sub_epi32(_mm256_set1_epi32(0x7ef19fff), _mm256_castps_si256(a.v)));
+        return CasLane(_mm256_mul_ps(b, _mm256_fnmadd_ps(b, a.v, _mm256_set1_ps(2.0f))));
+    }
+    static inline CasLaneAVX2 PrxLoSqrt(CasLaneAVX2 a)
+    {
+        return CasLane(_mm256_castsi256_ps(_mm256_add_epi32(_mm256_srli_epi32(_mm256_castps_si256(a.v), 1), _mm256_set1_epi32(0x1fbc4639))));
+    }
+
+    const CAS_KernelTable* CAS_GetKernelTableAVX2()
+    {
+        static const CAS_KernelTable s_table = CAS_MakeKernelTable<CasLaneAVX2>();
+        return &s_table;
+    }
+#else
+    const CAS_KernelTable* CAS_GetKernelTableAVX2()
+    {
+        return nullptr;
+    }
+#endif
+}
@@ -0,0 +1,155 @@
+//CAS Sample
+//
+// Copyright(c) 2019 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "CAS_Kernels.h"
+#include "CAS_Roofline.h"
+
+namespace CAS_SAMPLE_CPU
+{
+    struct CasOpCounts
+    {
+        uint64_t Flops;
+        uint64_t IntOps;
+        uint64_t Loads;
+        uint64_t Stores;
+    };
+
+    static thread_local CasOpCounts s_opCounts;
+
+    // Scalar lane that computes the same results as CasLaneScalar and counts every operation it is asked to do.
+    struct CasLaneCount
+    {
+        static const uint32_t Width = 1;
+
+        float v;
+
+        static CasLaneCount Load(const float* p) { ++s_opCounts.Loads; CasLaneCount r = { *p }; return r; }
+        static CasLaneCount Set(float f) { CasLaneCount r = { f }; return r; }
+        static CasLaneCount Gather(const float* p, const int32_t* pIndex) { ++s_opCounts.Loads; CasLaneCount r = { p[pIndex[0]] }; return r; }
+        void Store(float* p) const { ++s_opCounts.Stores; *p = v; }
+
+        // The 16-bit source windows count the widening as integer ops (half) or one multiply (UNORM16).
+        static CasLaneCount LoadHalf(const uint16_t* p) { ++s_opCounts.Loads; return FromHalf(*p); }
+        static CasLaneCount GatherHalf(const uint16_t* p, const int32_t* pIndex) { ++s_opCounts.Loads; return FromHalf(p[pIndex[0]]); }
+        static CasLaneCount LoadUnorm16(const uint16_t* p) { ++s_opCounts.Loads; return FromUnorm16(*p); }
+        static CasLaneCount GatherUnorm16(const uint16_t* p, const int32_t* pIndex) { ++s_opCounts.Loads; return FromUnorm16(p[pIndex[0]]); }
+
+        static CasLaneCount FromHalf(uint16_t h);
+        static CasLaneCount FromUnorm16(uint16_t u);
+    };
+
+    static inline uint32_t CasAsUint(float f) { uint32_t u; memcpy(&u, &f, sizeof(u)); return u; }
+    static inline float CasAsFloat(uint32_t u) { float f; memcpy(&f, &u, sizeof(f)); return f; }
+
+    inline CasLaneCount CasLaneCount::FromHalf(uint16_t h)
+    {
+        s_opCounts.IntOps += 4;
+        s_opCounts.Flops += 1;
+        return Set(CasAsFloat(CasAsUint(CasAsFloat((h & 0x7fffu) << 13) * CasHalfRebias) | ((h & 0x8000u) << 16)));
+    }
+
+    inline CasLaneCount CasLaneCount::FromUnorm16(uint16_t u)
+    {
+        s_opCounts.IntOps += 1;
+        s_opCounts.Flops += 1;
+        return Set(static_cast<float>(u) * (1.0f / 65535.0f));
+    }
+    static inline CasLaneCount CasFlops(uint32_t count, float v) { s_opCounts.Flops += count; return CasLaneCount::Set(v); }
+
+    static inline CasLaneCount operator+(CasLaneCount a, CasLaneCount b) { return CasFlops(1, a.v + b.v); }
+    static inline CasLaneCount operator-(CasLaneCount a, CasLaneCount b) { return CasFlops(1, a.v - b.v); }
+    static inline CasLaneCount operator*(CasLaneCount a, CasLaneCount b) { return CasFlops(1, a.v * b.v); }
+    static inline CasLaneCount Min(CasLaneCount a, CasLaneCount b) { return CasFlops(1, a.v < b.v ? a.v : b.v); }
+    static inline CasLaneCount Max(CasLaneCount a, CasLaneCount b) { return CasFlops(1, a.v > b.v ? a.v : b.v); }
+    static inline CasLaneCount Sat(CasLaneCount a) { return CasFlops(2, std::min(1.0f, std::max(0.0f, a.v))); }
+    static inline CasLaneCount Rcp(CasLaneCount a) { return CasFlops(1, 1.0f / a.v); }
+    static inline CasLaneCount Sqrt(CasLaneCount a) { return CasFlops(1, std::sqrt(a.v)); }
+
+    static inline CasLaneCount PrxLoRcp(CasLaneCount a)
+    {
+        s_opCounts.IntOps += 1;
+        return CasLaneCount::Set(CasAsFloat(0x7ef07ebbu - CasAsUint(a.v)));
+    }
+    static inline CasLaneCount PrxMedRcp(CasLaneCount a)
+    {
+        s_opCounts.IntOps += 1;
+        float b = CasAsFloat(0x7ef19fffu - CasAsUint(a.v));
+        return CasFlops(3, b * (-b * a.v + 2.0f));
+    }
+    static inline CasLaneCount PrxLoSqrt(CasLaneCount a)
+    {
+        s_opCounts.IntOps += 2;
+        return CasLaneCount::Set(CasAsFloat((CasAsUint(a.v) >> 1u) + 0x1fbc4639u));
+    }
+
+    void CAS_Roofline::CountKernelCost(bool sharpenOnly, uint32_t variant, CAS_KernelCost& cost)
+    {
+        static const CAS_KernelTable s_table = CAS_MakeKernelTable<CasLaneCount>();
+
+        // A 2x up-sample sized window is enough for either mode, the kernels have no data dependent branches.
+        const uint32_t width = 8;
+        const uint32_t height = 4;
+        const uint32_t srcPitch = 16;
+        const uint32_t srcHeight = 8;
+        std::vector<float> source(srcPitch * srcHeight * 3, 0.5f);
+        std::vector<float> output(width * height * 3);
+        int32_t column[width], row[height];
+        float columnFrac[width], rowFrac[height];
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            column[x] = static_cast<int32_t>(x / 2 + 1);
+            columnFrac[x] = (x & 1) ? 0.75f : 0.25f;
+        }
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            row[y] = static_cast<int32_t>(y / 2 + 1);
+            rowFrac[y] = (y & 1) ? 0.75f : 0.25f;
+        }
+
+        CAS_TileArgs args = {};
+        for (int c = 0; c < 3; ++c)
+        {
+            args.pSrc[c] = source.data() + c * srcPitch * srcHeight;
+            args.pDst[c] = output.data() + c * width * height;
+        }
+        args.SrcPitch = srcPitch;
+        args.DstPitch = width;
+        args.Width = width;
+        args.Height = height;
+        args.Peak = -0.125f;
+        args.pColumn = column;
+        args.pColumnFrac = columnFrac;
+        args.pRow = row;
+        args.pRowFrac = rowFrac;
+
+        s_opCounts = CasOpCounts();
+        variant %= CAS_Variant_Count;
+        (sharpenOnly ? s_table.SharpenOnly[2][CAS_Precision_FP32][variant] : s_table.Upsample[2][CAS_Precision_FP32][variant])(args);
+
+        const double pixels = static_cast<double>(width * height);
+        cost.Flops = s_opCounts.Flops / pixels;
+        cost.IntOps = s_opCounts.IntOps / pixels;
+        cost.Loads = s_opCounts.Loads / pixels;
+        cost.Stores = s_opCounts.Stores / pixels;
+    }
+}
@@ -0,0 +1,105 @@
+//CAS Sample
+//
+// Copyright(c) 2019 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "CAS_Kernels.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define CAS_KERNELS_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace CAS_SAMPLE_CPU
+{
+#ifdef CAS_KERNELS_SSE2
+    // 4 pixels per iteration, baseline for every x86-64 CPU.
+    struct CasLaneSSE2
+    {
+        static const uint32_t Width = 4;
+
+        __m128 v;
+
+        static CasLaneSSE2 Load(const float* p) { CasLaneSSE2 r = { _mm_loadu_ps(p) }; return r; }
+        static CasLaneSSE2 Set(float f) { CasLaneSSE2 r = { _mm_set1_ps(f) }; return r; }
+        static CasLaneSSE2 Gather(const float* p, const int32_t* pIndex)
+        {
+            CasLaneSSE2 r = { _mm_setr_ps(p[pIndex[0]], p[pIndex[1]], p[pIndex[2]], p[pIndex[3]]) };
+            return r;
+        }
+        void Store(float* p) const { _mm_storeu_ps(p, v); }
+
+        static CasLaneSSE2 LoadHalf(const uint16_t* p) { return FromHalf(Widen(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)))); }
+        static CasLaneSSE2 GatherHalf(const uint16_t* p, const int32_t* pIndex) { return FromHalf(Gather16(p, pIndex)); }
+        static CasLaneSSE2 LoadUnorm16(const uint16_t* p) { return FromUnorm16(Widen(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)))); }
+        static CasLaneSSE2 GatherUnorm16(const uint16_t* p, const int32_t* pIndex) { return FromUnorm16(Gather16(p, pIndex)); }
+
+        static __m128i Widen(__m128i u16) { return _mm_unpacklo_epi16(u16, _mm_setzero_si128()); }
+        static __m128i Gather16(const uint16_t* p, const int32_t* pIndex) { return _mm_setr_epi32(p[pIndex[0]], p[pIndex[1]], p[pIndex[2]], p[pIndex[3]]); }
+        static CasLaneSSE2 FromHalf(__m128i u32)
+        {
+            __m128 magnitude = _mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(u32, _mm_set1_epi32(0x7fff)), 13)), _mm_set1_ps(CasHalfRebias));
+            __m128i sign = _mm_slli_epi32(_mm_and_si128(u32, _mm_set1_epi32(0x8000)), 16);
+            CasLaneSSE2 r = { _mm_or_ps(magnitude, _mm_castsi128_ps(sign)) };
+            return r;
+        }
+        static CasLaneSSE2 FromUnorm16(__m128i u32)
+        {
+            CasLaneSSE2 r = { _mm_mul_ps(_mm_cvtepi32_ps(u32), _mm_set1_ps(1.0f / 65535.0f)) };
+            return r;
+        }
+    };
+
+    static inline CasLaneSSE2 CasLane(__m128 v) { CasLaneSSE2 r = { v }; return r; }
+
+    static inline CasLaneSSE2 operator+(CasLaneSSE2 a, CasLaneSSE2 b) { return CasLane(_mm_add_ps(a.v, b.v)); }
+    static inline CasLaneSSE2 operator-(CasLaneSSE2 a, CasLaneSSE2 b) { return CasLane(_mm_sub_ps(a.v, b.v)); }
+    static inline CasLaneSSE2 operator*(CasLaneSSE2 a, CasLaneSSE2 b) { return CasLane(_mm_mul_ps(a.v, b.v)); }
+    static inline CasLaneSSE2 Min(CasLaneSSE2 a, CasLaneSSE2 b) { return CasLane(_mm_min_ps(a.v, b.v)); }
+    static inline CasLaneSSE2 Max(CasLaneSSE2 a, CasLaneSSE2 b) { return CasLane(_mm_max_ps(a.v, b.v)); }
+    // Value first so a NaN (0 * rcp(0) from an all black neighborhood with CAS_GO_SLOWER) becomes 0 like GPU saturate().
+    static inline CasLaneSSE2 Sat(CasLaneSSE2 a) { return CasLane(_mm_min_ps(_mm_max_ps(a.v, _mm_setzero_ps()), _mm_set1_ps(1.0f))); }
+    static inline CasLaneSSE2 Rcp(CasLaneSSE2 a) { return CasLane(_mm_div_ps(_mm_set1_ps(1.0f), a.v)); }
+    static inline CasLaneSSE2 Sqrt(CasLaneSSE2 a) { return CasLane(_mm_sqrt_ps(a.v)); }
+
+    // Same bit tricks as APrxLoRcpF1(), APrxMedRcpF1() and APrxLoSqrtF1() in ffx_a.h.
+    static inline CasLaneSSE2 PrxLoRcp(CasLaneSSE2 a)
+    {
+        return CasLane(_mm_castsi128_ps(_mm_sub_epi32(_mm_set1_epi32(0x7ef07ebb), _mm_castps_si128(a.v))));
+    }
+    static inline CasLaneSSE2 PrxMedRcp(CasLaneSSE2 a)
+    {
+        __m128 b = _mm_castsi128_ps(_mm_sub_epi32(_mm_set1_epi32(0x7ef19fff), _mm_castps_si128(a.v)));
+        return CasLane(_mm_mul_ps(b, _mm_sub_ps(_mm_set1_ps(2.0f), _mm_mul_ps(b, a.v))));
+    }
+    static inline CasLaneSSE2 PrxLoSqrt(CasLaneSSE2 a)
+    {
+        return CasLane(_mm_castsi128_ps(_mm_add_epi32(_mm_srli_epi32(_mm_castps_si128(a.v), 1), _mm_set1_epi32(0x1fbc4639))));
+    }
+
+    const CAS_KernelTable* CAS_GetKernelTableSSE2()
+    {
+        static const CAS_KernelTable s_table = CAS_MakeKernelTable<CasLaneSSE2>();
+        return &s_table;
+    }
+#else
+    const CAS_KernelTable* CAS_GetKernelTableSSE2()
+    {
+        return nullptr;
+    }
+#endif
+}
@@ -0,0 +1,79 @@
+//CAS Sample
+//
+// Copyright(c) 2019 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <cmath>
+#include <cstring>
+
+#include "CAS_Kernels.h"
+
+namespace CAS_SAMPLE_CPU
+{
+    // One pixel at a time, the reference tier that runs everywhere.
+    struct CasLaneScalar
+    {
+        static const uint32_t Width = 1;
+
+        float v;
+
+        static CasLaneScalar Load(const float* p) { CasLaneScalar r = { *p }; return r; }
+        static CasLaneScalar Set(float f) { CasLaneScalar r = { f }; return r; }
+        static CasLaneScalar Gather(const float* p, const int32_t* pIndex) { CasLaneScalar r = { p[pIndex[0]] }; return r; }
+        void Store(float* p) const { *p = v; }
+
+        static CasLaneScalar LoadHalf(const uint16_t* p) { return FromHalf(*p); }
+        static CasLaneScalar GatherHalf(const uint16_t* p, const int32_t* pIndex) { return FromHalf(p[pIndex[0]]); }
+        static CasLaneScalar LoadUnorm16(const uint16_t* p) { return Set(*p * (1.0f / 65535.0f)); }
+        static CasLaneScalar GatherUnorm16(const uint16_t* p, const int32_t* pIndex) { return Set(p[pIndex[0]] * (1.0f / 65535.0f)); }
+
+        static CasLaneScalar FromHalf(uint16_t h);
+    };
+
+    static inline uint32_t CasAsUint(float f) { uint32_t u; memcpy(&u, &f, sizeof(u)); return u; }
+    static inline float CasAsFloat(uint32_t u) { float f; memcpy(&f, &u, sizeof(f)); return f; }
+
+    inline CasLaneScalar CasLaneScalar::FromHalf(uint16_t h)
+    {
+        return Set(CasAsFloat(CasAsUint(CasAsFloat((h & 0x7fffu) << 13) * CasHalfRebias) | ((h & 0x8000u) << 16)));
+    }
+
+    static inline CasLaneScalar operator+(CasLaneScalar a, CasLaneScalar b) { return CasLaneScalar::Set(a.v + b.v); }
+    static inline CasLaneScalar operator-(CasLaneScalar a, CasLaneScalar b) { return CasLaneScalar::Set(a.v - b.v); }
+    static inline CasLaneScalar operator*(CasLaneScalar a, CasLaneScalar b) { return CasLaneScalar::Set(a.v * b.v); }
+    static inline CasLaneScalar Min(CasLaneScalar a, CasLaneScalar b) { return CasLaneScalar::Set(a.v < b.v ? a.v : b.v); }
+    static inline CasLaneScalar Max(CasLaneScalar a, CasLaneScalar b) { return CasLaneScalar::Set(a.v > b.v ? a.v : b.v); }
+    // Value first so a NaN (0 * rcp(0) from an all black neighborhood with CAS_GO_SLOWER) becomes 0 like GPU saturate().
+    static inline CasLaneScalar Sat(CasLaneScalar a) { return Min(Max(a, CasLaneScalar::Set(0.0f)), CasLaneScalar::Set(1.0f)); }
+    static inline CasLaneScalar Rcp(CasLaneScalar a) { return CasLaneScalar::Set(1.0f / a.v); }
+    static inline CasLaneScalar Sqrt(CasLaneScalar a) { return CasLaneScalar::Set(std::sqrt(a.v)); }
+
+    // Same bit tricks as APrxLoRcpF1(), APrxMedRcpF1() and APrxLoSqrtF1() in ffx_a.h.
+    static inline CasLaneScalar PrxLoRcp(CasLaneScalar a) { return CasLaneScalar::Set(CasAsFloat(0x7ef07ebbu - CasAsUint(a.v))); }
+    static inline CasLaneScalar PrxMedRcp(CasLaneScalar a)
+    {
+        float b = CasAsFloat(0x7ef19fffu - CasAsUint(a.v));
+        return CasLaneScalar::Set(b * (-b * a.v + 2.0f));
+    }
+    static inline CasLaneScalar PrxLoSqrt(CasLaneScalar a) { return CasLaneScalar::Set(CasAsFloat((CasAsUint(a.v) >> 1u) + 0x1fbc4639u)); }
+
+    const CAS_KernelTable* CAS_GetKernelTableScalar()
+    {
+        static const CAS_KernelTable s_table = CAS_MakeKernelTable<CasLaneScalar>();
+        return &s_table;
+    }
+}
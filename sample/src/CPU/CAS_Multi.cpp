@@ -0,0 +1,265 @@
+//CAS Sample
+//
+// Copyright(c) 2019 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Several outputs of one frame in one walk over the source. The source is split into tiles and every 8x8 block of every
+// output belongs to the source tile its first pixel's tap falls into, so each output is partitioned among the source
+// tiles without overlap. A work item decodes the union of the footprints of its blocks in all outputs once, into the
+// thread's shared window, and filters them from it; the tiles of an output read only that window. Outputs whose blocks
+// span more than half a source tile would widen the window too much and run on their own, they read little of the source
+// anyway.
+// A mip chain is not a set of outputs of one source: CAS scaling reads a 2x2 bilinear footprint, so a level 4x or more
+// smaller than the source would skip most texels and alias. Every level is halved from the unsharpened one before it
+// instead, each kept in an RGBA32F (R32F, RG32F) image, and sharpened on its own.
+
+#include "CAS_CPU.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace CAS_SAMPLE_CPU
+{
+    static inline float CasAsFloat(uint32_t u)
+    {
+        float f;
+        memcpy(&f, &u, sizeof(f));
+        return f;
+    }
+
+    // First 8x8 block column (or row) of the output every source tile owns, followed by the block count. A block belongs
+    // to the tile its first pixel's tap maps into, with the same float math as ProcessTile().
+    static void CasAssignBlocks(std::vector<uint32_t>& first, uint32_t size, uint32_t sourceSize, float scale, float offset,
+                                bool sharpenOnly, uint32_t tileSize, uint32_t tileCount)
+    {
+        const uint32_t blocks = (size + 7) / 8;
+        first.assign(tileCount + 1, blocks);
+        for (uint32_t block = blocks; block-- > 0;)
+        {
+            int32_t tap = static_cast<int32_t>(block * 8);
+            if (!sharpenOnly)
+            {
+                tap = static_cast<int32_t>(std::floor(static_cast<float>(block * 8) * scale + offset));
+            }
+            tap = std::min(std::max(tap, 0), static_cast<int32_t>(sourceSize) - 1);
+            first[static_cast<uint32_t>(tap) / tileSize] = block;
+        }
+
+        // Tiles that own no block start where the next one does.
+        for (uint32_t tile = tileCount; tile-- > 0;)
+        {
+            first[tile] = std::min(first[tile], first[tile + 1]);
+        }
+    }
+
+    uint32_t CAS_Filter::UpscaleMulti(const CAS_Image& input, const CAS_Output* pOutputs, uint32_t outputCount)
+    {
+        const uint32_t tileWidth = GetRunTileWidth();
+        if (outputCount == 0)
+        {
+            return 0;
+        }
+
+        // The outputs no longer match the hashes of UpscaleChanged().
+        m_tileHashes.clear();
+
+        struct MultiOutput
+        {
+            CASConstants                Consts;
+            FrameView                   View;
+            bool                        SharpenOnly;
+            bool                        Skipped;    // Beyond CAS_AREA_LIMIT with the cascade enabled.
+            bool                        Shared;
+            std::vector<uint32_t>       Columns;    // CasAssignBlocks() of the source tile columns and rows.
+            std::vector<uint32_t>       Rows;
+        };
+
+        const uint32_t sourceWidth = GetReducedSize(input.Width);
+        const uint32_t sourceHeight = GetReducedSize(input.Height);
+        const uint32_t tilesX = (sourceWidth + tileWidth - 1) / tileWidth;
+        const uint32_t tilesY = (sourceHeight + m_tileHeight - 1) / m_tileHeight;
+        std::vector<MultiOutput> outputs(outputCount);
+        bool anyShared = false;
+        uint32_t written = 0;
+        for (uint32_t i = 0; i < outputCount; ++i)
+        {
+            const CAS_Image& image = pOutputs[i].Image;
+            MultiOutput& output = outputs[i];
+            output.SharpenOnly = (image.Width == sourceWidth && image.Height == sourceHeight);
+            output.Skipped = m_cascadeEnabled && !IsScalingSupported(sourceWidth, sourceHeight, image.Width, image.Height);
+            if (output.Skipped)
+            {
+                output.Shared = false;
+                continue;
+            }
+            ++written;
+            SetupConstants(output.Consts, pOutputs[i].Sharpness, sourceWidth, sourceHeight, image.Width, image.Height);
+            output.View = GetFullFrameView(input, image);
+            output.View.pConsts = &output.Consts;
+            output.Shared = 16 * static_cast<uint64_t>(sourceWidth) <= static_cast<uint64_t>(tileWidth) * image.Width &&
+                            16 * static_cast<uint64_t>(sourceHeight) <= static_cast<uint64_t>(m_tileHeight) * image.Height;
+            if (output.Shared)
+            {
+                CasAssignBlocks(output.Columns, image.Width, sourceWidth, CasAsFloat(output.Consts.Const0[0]), CasAsFloat(output.Consts.Const0[2]),
+                                output.SharpenOnly, tileWidth, tilesX);
+                CasAssignBlocks(output.Rows, image.Height, sourceHeight, CasAsFloat(output.Consts.Const0[1]), CasAsFloat(output.Consts.Const0[3]),
+                                output.SharpenOnly, m_tileHeight, tilesY);
+                anyShared = true;
+            }
+        }
+
+        if (anyShared)
+        {
+            m_threadPool.Run(tilesX * tilesY, [&](uint32_t item, uint32_t threadIndex)
+            {
+                ThreadScratch& scratch = m_scratch[threadIndex];
+                const uint32_t tileX = item % tilesX;
+                const uint32_t tileY = item / tilesX;
+
+                // The blocks of every output this source tile owns, and the source texels all of them read.
+                std::vector<CAS_Rect>& grids = scratch.CascadeRects;
+                grids.assign(outputCount, CAS_Rect());
+                uint32_t x0 = sourceWidth, y0 = sourceHeight, x1 = 0, y1 = 0;
+                for (uint32_t i = 0; i < outputCount; ++i)
+                {
+                    const MultiOutput& output = outputs[i];
+                    if (!output.Shared)
+                    {
+                        continue;
+                    }
+                    const uint32_t gridX = output.Columns[tileX] * 8;
+                    const uint32_t gridY = output.Rows[tileY] * 8;
+                    const uint32_t gridX1 = std::min(output.Columns[tileX + 1] * 8, output.View.Width);
+                    const uint32_t gridY1 = std::min(output.Rows[tileY + 1] * 8, output.View.Height);
+                    if (gridX >= gridX1 || gridY >= gridY1)
+                    {
+                        continue;
+                    }
+                    grids[i] = { gridX, gridY, gridX1 - gridX, gridY1 - gridY };
+                    const CAS_Rect footprint = GetPassFootprint(grids[i], output.Consts, output.SharpenOnly, sourceWidth, sourceHeight);
+                    x0 = std::min(x0, footprint.X);
+                    y0 = std::min(y0, footprint.Y);
+                    x1 = std::max(x1, footprint.X + footprint.Width);
+                    y1 = std::max(y1, footprint.Y + footprint.Height);
+                }
+                if (x0 >= x1 || y0 >= y1)
+                {
+                    return;
+                }
+
+                DecodeSharedWindow(input, outputs[0].View, { x0, y0, x1 - x0, y1 - y0 }, scratch);
+                for (uint32_t i = 0; i < outputCount; ++i)
+                {
+                    if (grids[i].Width == 0)
+                    {
+                        continue;
+                    }
+                    FrameView view = outputs[i].View;
+                    view.Grid = grids[i];
+                    const uint32_t tiles = ((view.Grid.Width + tileWidth - 1) / tileWidth) * ((view.Grid.Height + m_tileHeight - 1) / m_tileHeight);
+                    for (uint32_t tile = 0; tile < tiles; ++tile)
+                    {
+                        ProcessTile(input, pOutputs[i].Image, view, outputs[i].SharpenOnly, tile, scratch);
+                    }
+                }
+                scratch.Shared.Valid = false;
+            });
+        }
+
+        for (uint32_t i = 0; i < outputCount; ++i)
+        {
+            const MultiOutput& output = outputs[i];
+            if (output.Shared || output.Skipped)
+            {
+                continue;
+            }
+            const FrameView& view = output.View;
+            const uint32_t tiles = ((view.Grid.Width + tileWidth - 1) / tileWidth) * ((view.Grid.Height + m_tileHeight - 1) / m_tileHeight);
+            m_threadPool.Run(tiles, [&](uint32_t item, uint32_t threadIndex)
+            {
+                ProcessTile(input, pOutputs[i].Image, view, output.SharpenOnly, item, m_scratch[threadIndex]);
+            });
+        }
+        return written;
+    }
+
+    void CAS_Filter::BuildMipChain(const CAS_Image& input, const CAS_Image* pLevels, uint32_t levelCount, float sharpness)
+    {
+        if (levelCount == 0)
+        {
+            return;
+        }
+        const uint32_t tileWidth = GetRunTileWidth();
+
+        // The levels no longer match the hashes of UpscaleChanged().
+        m_tileHashes.clear();
+
+        auto runPass = [&](const CAS_Image& source, const CAS_Image& target, const FrameView& view, bool sharpenOnly)
+        {
+            const uint32_t tiles = ((view.Grid.Width + tileWidth - 1) / tileWidth) * ((view.Grid.Height + m_tileHeight - 1) / m_tileHeight);
+            m_threadPool.Run(tiles, [&](uint32_t item, uint32_t threadIndex)
+            {
+                ProcessTile(source, target, view, sharpenOnly, item, m_scratch[threadIndex]);
+            });
+        };
+
+        // Views of a pass from the input (reduced and through the input transform) or from an unsharpened level.
+        auto getView = [&](const CAS_Image* pSource, const CAS_Image& target, const CASConstants& consts, bool last)
+        {
+            FrameView view = GetFullFrameView(input, target);
+            if (pSource)
+            {
+                view.SourceWidth = view.InputWidth = pSource->Width;
+                view.SourceHeight = view.InputHeight = pSource->Height;
+                view.Reduced = false;
+                view.pInputTransform = nullptr;
+            }
+            view.pConsts = &consts;
+            view.Mapped = view.Mapped && last;
+            view.pOutputTransform = last ? view.pOutputTransform : nullptr;
+            return view;
+        };
+
+        const uint32_t channels = GetFullFrameView(input, pLevels[0]).Channels;
+        const uint32_t texel = channels < 3 ? channels : 4;
+        const CAS_Format format = channels == 1 ? CAS_Format_R32F : channels == 2 ? CAS_Format_RG32F : CAS_Format_RGBA32F;
+
+        CASConstants sharpen;
+        SetupConstants(sharpen, sharpness, GetReducedSize(input.Width), GetReducedSize(input.Height), pLevels[0].Width, pLevels[0].Height);
+        runPass(input, pLevels[0], getView(nullptr, pLevels[0], sharpen, true), true);
+
+        CAS_Image parent = input;
+        for (uint32_t level = 1; level < levelCount; ++level)
+        {
+            const CAS_Image& image = pLevels[level];
+            std::vector<float>& storage = m_mipImages[level & 1];
+            storage.resize(static_cast<size_t>(image.Width) * image.Height * texel);
+            const CAS_Image unsharpened = { storage.data(), image.Width, image.Height, image.Width * texel * 4, format };
+
+            CASConstants halve;
+            const bool fromInput = (level == 1);
+            SetupScaleConstants(halve, fromInput ? GetReducedSize(input.Width) : parent.Width, fromInput ? GetReducedSize(input.Height) : parent.Height,
+                                image.Width, image.Height);
+            runPass(parent, unsharpened, getView(fromInput ? nullptr : &parent, unsharpened, halve, false), false);
+
+            SetupConstants(sharpen, sharpness, image.Width, image.Height, image.Width, image.Height);
+            runPass(unsharpened, image, getView(&unsharpened, image, sharpen, true), true);
+            parent = unsharpened;
+        }
+    }
+}
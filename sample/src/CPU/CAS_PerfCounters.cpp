@@ -0,0 +1,182 @@
+//CAS Sample
+//
+// Copyright(c) 2019 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "CAS_PerfCounters.h"
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+namespace CAS_SAMPLE_CPU
+{
+#if defined(__linux__)
+    static int CasOpenCounter(uint32_t type, uint64_t config)
+    {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.inherit = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+
+    static uint64_t CasCacheConfig(uint64_t cache, uint64_t op, uint64_t result)
+    {
+        return cache | (op << 8) | (result << 16);
+    }
+#endif
+
+    CAS_PerfCounters::CAS_PerfCounters()
+    {
+        for (int i = 0; i < CAS_Counter_Count; ++i)
+        {
+            m_fd[i] = -1;
+        }
+    }
+
+    CAS_PerfCounters::~CAS_PerfCounters()
+    {
+        Close();
+    }
+
+    bool CAS_PerfCounters::Open()
+    {
+        Close();
+#if defined(__linux__)
+        static const struct
+        {
+            uint32_t Type;
+            uint64_t Config;
+        } s_events[CAS_Counter_Count] =
+        {
+            { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+            { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+            { PERF_TYPE_HW_CACHE, CasCacheConfig(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS) },
+            { PERF_TYPE_HW_CACHE, CasCacheConfig(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS) },
+            { PERF_TYPE_HW_CACHE, CasCacheConfig(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS) },
+        };
+
+        int firstError = 0;
+        for (int i = 0; i < CAS_Counter_Count; ++i)
+        {
+            m_fd[i] = CasOpenCounter(s_events[i].Type, s_events[i].Config);
+            if (m_fd[i] < 0 && firstError == 0)
+            {
+                firstError = errno;
+            }
+        }
+
+        if (!IsAnyAvailable())
+        {
+            m_error = std::string("perf_event_open failed: ") + strerror(firstError);
+            if (firstError == EACCES || firstError == EPERM)
+            {
+                m_error += " (check /proc/sys/kernel/perf_event_paranoid or the container's seccomp profile)";
+            }
+            return false;
+        }
+        return true;
+#else
+        m_error = "hardware counters are only supported on Linux";
+        return false;
+#endif
+    }
+
+    void CAS_PerfCounters::Close()
+    {
+        for (int i = 0; i < CAS_Counter_Count; ++i)
+        {
+#if defined(__linux__)
+            if (m_fd[i] >= 0)
+            {
+                close(m_fd[i]);
+            }
+#endif
+            m_fd[i] = -1;
+        }
+    }
+
+    bool CAS_PerfCounters::IsAnyAvailable() const
+    {
+        for (int i = 0; i < CAS_Counter_Count; ++i)
+        {
+            if (m_fd[i] >= 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void CAS_PerfCounters::Start()
+    {
+#if defined(__linux__)
+        // Both ioctls also apply to the inherited per thread copies.
+        for (int i = 0; i < CAS_Counter_Count; ++i)
+        {
+            if (m_fd[i] >= 0)
+            {
+                ioctl(m_fd[i], PERF_EVENT_IOC_RESET, 0);
+                ioctl(m_fd[i], PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+#endif
+    }
+
+    void CAS_PerfCounters::Stop(CAS_CounterValues& values)
+    {
+        for (int i = 0; i < CAS_Counter_Count; ++i)
+        {
+            values.Value[i] = 0;
+            values.Valid[i] = false;
+#if defined(__linux__)
+            if (m_fd[i] < 0)
+            {
+                continue;
+            }
+            ioctl(m_fd[i], PERF_EVENT_IOC_DISABLE, 0);
+
+            // { value, time enabled, time running }, scaled up if the PMU had to multiplex the counter.
+            uint64_t data[3] = {};
+            if (read(m_fd[i], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data)) || data[2] == 0)
+            {
+                continue;
+            }
+            values.Value[i] = (data[2] < data[1]) ? static_cast<uint64_t>(static_cast<double>(data[0]) * data[1] / data[2]) : data[0];
+            values.Valid[i] = true;
+#endif
+        }
+    }
+
+    const char* CAS_PerfCounters::GetCounterName(CAS_Counter counter)
+    {
+        static const char* s_names[] = { "cycles", "instructions", "l1d_misses", "llc_misses", "dtlb_misses" };
+        return counter < CAS_Counter_Count ? s_names[counter] : "unknown";
+    }
+}
@@ -0,0 +1,71 @@
+//CAS Sample
+//
+// Copyright(c) 2019 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace CAS_SAMPLE_CPU
+{
+    enum CAS_Counter
+    {
+        CAS_Counter_Cycles,
+        CAS_Counter_Instructions,
+        CAS_Counter_L1DMisses,
+        CAS_Counter_LLCMisses,
+        CAS_Counter_DTLBMisses,
+        CAS_Counter_Count,
+    };
+
+    struct CAS_CounterValues
+    {
+        uint64_t    Value[CAS_Counter_Count];
+        bool        Valid[CAS_Counter_Count];
+    };
+
+    //
+    // User space hardware counters around a filter run, read through perf_event_open on Linux.
+    // Counters are opened with inherit set, so threads created after Open() (the filter's thread pool) are counted too.
+    // Any counter the kernel, the CPU or the container refuses is left invalid, on other platforms none are available.
+    //
+    class CAS_PerfCounters
+    {
+    public:
+        CAS_PerfCounters();
+        ~CAS_PerfCounters();
+
+        // Returns true if at least one counter could be opened, GetError() explains why not otherwise.
+        bool Open();
+        void Close();
+
+        bool IsAvailable(CAS_Counter counter) const { return m_fd[counter] >= 0; }
+        bool IsAnyAvailable() const;
+        const std::string& GetError() const { return m_error; }
+
+        void Start();
+        void Stop(CAS_CounterValues& values);
+
+        static const char* GetCounterName(CAS_Counter counter);
+
+    private:
+        int             m_fd[CAS_Counter_Count];
+        std::string     m_error;
+    };
+}
@@ -0,0 +1,283 @@
+//CAS Sample
+//
+// Copyright(c) 2019 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "CAS_Profile.h"
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+namespace CAS_SAMPLE_CPU
+{
+    static std::string CasTrim(const std::string& text)
+    {
+        size_t first = text.find_first_not_of(" \t\r\n");
+        size_t last = text.find_last_not_of(" \t\r\n");
+        return first == std::string::npos ? std::string() : text.substr(first, last - first + 1);
+    }
+
+    static bool CasEqualNoCase(const std::string& a, const char* pB)
+    {
+        size_t i = 0;
+        for (; i < a.size() && pB[i]; ++i)
+        {
+            if (tolower(static_cast<unsigned char>(a[i])) != tolower(static_cast<unsigned char>(pB[i])))
+            {
+                return false;
+            }
+        }
+        return i == a.size() && pB[i] == 0;
+    }
+
+    static bool CasParseVariant(const std::string& value, uint32_t& variant)
+    {
+        if (!value.empty() && isdigit(static_cast<unsigned char>(value[0])))
+        {
+            variant = static_cast<uint32_t>(atoi(value.c_str())) % CAS_Variant_Count;
+            return true;
+        }
+
+        variant = CAS_Variant_Default;
+        size_t start = 0;
+        while (start <= value.size())
+        {
+            size_t end = value.find('|', start);
+            std::string flag = CasTrim(value.substr(start, end == std::string::npos ? std::string::npos : end - start));
+            bool found = CasEqualNoCase(flag, "Default");
+            for (uint32_t bit = 1; bit < CAS_Variant_Count && !found; bit <<= 1)
+            {
+                if (CasEqualNoCase(flag, CAS_Filter::GetVariantName(bit).c_str()))
+                {
+                    variant |= bit;
+                    found = true;
+                }
+            }
+            if (!found)
+            {
+                return false;
+            }
+            if (end == std::string::npos)
+            {
+                break;
+            }
+            start = end + 1;
+        }
+        return true;
+    }
+
+    bool CAS_ProfileFile::Load(const char* pPath, CAS_Profile& profile)
+    {
+        std::ifstream file(pPath);
+        if (!file)
+        {
+            return false;
+        }
+
+        CAS_Profile result;
+        std::string line;
+        while (std::getline(file, line))
+        {
+            line = CasTrim(line.substr(0, line.find('#')));
+            size_t equals = line.find('=');
+            if (line.empty() || equals == std::string::npos)
+            {
+                continue;
+            }
+            const std::string key = CasTrim(line.substr(0, equals));
+            const std::string value = CasTrim(line.substr(equals + 1));
+
+            if (key == "tier")
+            {
+                result.Tier = CAS_Tier_Count;
+                for (int tier = 0; tier < CAS_Tier_Count; ++tier)
+                {
+                    if (CasEqualNoCase(value, CAS_Filter::GetTierName(static_cast<CAS_Tier>(tier))))
+                    {
+                        result.Tier = static_cast<CAS_Tier>(tier);
+                    }
+                }
+            }
+            else if (key == "variant")
+            {
+                if (!CasParseVariant(value, result.Variant))
+                {
+                    return false;
+                }
+            }
+            else if (key == "precision")
+            {
+                result.Precision = CAS_Precision_Count;
+                for (int precision = 0; precision < CAS_Precision_Count; ++precision)
+                {
+                    if (CasEqualNoCase(value, CAS_Filter::GetPrecisionName(static_cast<CAS_Precision>(precision))))
+                    {
+                        result.Precision = static_cast<CAS_Precision>(precision);
+                    }
+                }
+                if (result.Precision == CAS_Precision_Count)
+                {
+                    return false;
+                }
+            }
+            else if (key == "metric")
+            {
+                result.Metric = value;
+            }
+            else if (key == "threshold")
+            {
+                result.Threshold = atof(value.c_str());
+            }
+            else if (key == "quality")
+            {
+                result.Quality = atof(value.c_str());
+            }
+            else if (key == "ns_per_pixel")
+            {
+                result.NsPerPixel = atof(value.c_str());
+            }
+        }
+
+        profile = result;
+        return true;
+    }
+
+    bool CAS_ProfileFile::Save(const char* pPath, const CAS_Profile& profile)
+    {
+        FILE* pFile = fopen(pPath, "w");
+        if (!pFile)
+        {
+            return false;
+        }
+        fprintf(pFile, "# CAS_Tune profile\n");
+        fprintf(pFile, "tier = %s\n", CAS_Filter::GetTierName(profile.Tier));
+        fprintf(pFile, "variant = %s\n", CAS_Filter::GetVariantName(profile.Variant).c_str());
+        fprintf(pFile, "precision = %s\n", CAS_Filter::GetPrecisionName(profile.Precision));
+        if (!profile.Metric.empty())
+        {
+            fprintf(pFile, "metric = %s\n", profile.Metric.c_str());
+            fprintf(pFile, "threshold = %.6f\n", profile.Threshold);
+            fprintf(pFile, "quality = %.6f\n", profile.Quality);
+            fprintf(pFile, "ns_per_pixel = %.4f\n", profile.NsPerPixel);
+        }
+        return fclose(pFile) == 0;
+    }
+
+    std::string CAS_ScheduleCache::MakeKey(const std::string& cpuName, CAS_State casState, uint32_t renderWidth, uint32_t renderHeight, uint32_t width, uint32_t height)
+    {
+        const bool sharpenOnly = (casState != CAS_State_Upsample);
+        char sizes[64];
+        snprintf(sizes, sizeof(sizes), "%ux%u -> %ux%u", renderWidth, renderHeight, sharpenOnly ? renderWidth : width, sharpenOnly ? renderHeight : height);
+        return cpuName + (sharpenOnly ? " | sharpen | " : " | upsample | ") + sizes;
+    }
+
+    bool CAS_ScheduleCache::Load(const char* pPath)
+    {
+        m_entries.clear();
+        std::ifstream file(pPath);
+        if (!file)
+        {
+            return false;
+        }
+
+        CAS_Schedule* pSchedule = nullptr;
+        std::string line;
+        while (std::getline(file, line))
+        {
+            line = CasTrim(line.substr(0, line.find('#')));
+            if (line.size() > 2 && line.front() == '[' && line.back() == ']')
+            {
+                pSchedule = &m_entries[CasTrim(line.substr(1, line.size() - 2))];
+                continue;
+            }
+            size_t equals = line.find('=');
+            if (!pSchedule || equals == std::string::npos)
+            {
+                continue;
+            }
+            const std::string key = CasTrim(line.substr(0, equals));
+            const std::string value = CasTrim(line.substr(equals + 1));
+
+            if (key == "tile")
+            {
+                unsigned width = 0, height = 0;
+                if (sscanf(value.c_str(), "%ux%u", &width, &height) == 2)
+                {
+                    pSchedule->TileWidth = width;
+                    pSchedule->TileHeight = height;
+                }
+            }
+            else if (key == "threads")
+            {
+                pSchedule->Threads = static_cast<uint32_t>(atoi(value.c_str()));
+            }
+            else if (key == "traversal")
+            {
+                for (int traversal = 0; traversal < CAS_Traversal_Count; ++traversal)
+                {
+                    if (CasEqualNoCase(value, CAS_Filter::GetTraversalName(static_cast<CAS_Traversal>(traversal))))
+                    {
+                        pSchedule->Traversal = static_cast<CAS_Traversal>(traversal);
+                    }
+                }
+            }
+            else if (key == "hyperthreads")
+            {
+                pSchedule->Hyperthreads = atoi(value.c_str()) != 0;
+            }
+            else if (key == "ns_per_pixel")
+            {
+                pSchedule->NsPerPixel = atof(value.c_str());
+            }
+        }
+        return true;
+    }
+
+    bool CAS_ScheduleCache::Save(const char* pPath) const
+    {
+        FILE* pFile = fopen(pPath, "w");
+        if (!pFile)
+        {
+            return false;
+        }
+        fprintf(pFile, "# CAS schedule cache, [CPU | mode | input -> output]\n");
+        for (const auto& entry : m_entries)
+        {
+            const CAS_Schedule& schedule = entry.second;
+            fprintf(pFile, "\n[%s]\n", entry.first.c_str());
+            fprintf(pFile, "tile = %ux%u\n", schedule.TileWidth, schedule.TileHeight);
+            fprintf(pFile, "threads = %u\n", schedule.Threads);
+            fprintf(pFile, "traversal = %s\n", CAS_Filter::GetTraversalName(schedule.Traversal));
+            fprintf(pFile, "hyperthreads = %d\n", schedule.Hyperthreads ? 1 : 0);
+            fprintf(pFile, "ns_per_pixel = %.4f\n", schedule.NsPerPixel);
+        }
+        return fclose(pFile) == 0;
+    }
+
+    bool CAS_ScheduleCache::Find(const std::string& key, CAS_Schedule& schedule) const
+    {
+        auto it = m_entries.find(key);
+        if (it == m_entries.end())
+        {
+            return false;
+        }
+        schedule = it->second;
+        return true;
+    }
+}
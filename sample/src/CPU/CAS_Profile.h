@@ -0,0 +1,92 @@
+//CAS Sample
+//
+// Copyright(c) 2019 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <map>
+#include <string>
+
+#include "CAS_CPU.h"
+
+namespace CAS_SAMPLE_CPU
+{
+    // Filter settings picked by CAS_Tune for a quality target, see CAS_Filter::LoadProfile().
+    struct CAS_Profile
+    {
+        CAS_Tier            Tier = CAS_Tier_Count;      // CAS_Tier_Count picks the best supported tier.
+        uint32_t            Variant = CAS_Variant_Default;
+        CAS_Precision       Precision = CAS_Precision_FP32;
+
+        // What the tuner measured for the pick, informational.
+        std::string         Metric;
+        double              Threshold = 0.0;
+        double              Quality = 0.0;
+        double              NsPerPixel = 0.0;
+    };
+
+    //
+    // Text profile, one "key = value" per line and '#' comments:
+    //   tier = AVX2
+    //   variant = CAS_BETTER_DIAGONALS|CAS_SLOW
+    //   precision = FP16
+    // Names are the ones CAS_Filter reports, variant also accepts the CAS_Variant number. Unknown keys are ignored.
+    //
+    class CAS_ProfileFile
+    {
+    public:
+        static bool Load(const char* pPath, CAS_Profile& profile);
+        static bool Save(const char* pPath, const CAS_Profile& profile);
+    };
+
+    // Tile size, threads and traversal order tuned for a host and resolution, see CAS_Filter::TuneSchedule().
+    struct CAS_Schedule
+    {
+        uint32_t            TileWidth = 64;
+        uint32_t            TileHeight = 64;
+        uint32_t            Threads = 0;                // 0 uses every hardware thread.
+        CAS_Traversal       Traversal = CAS_Traversal_RowMajor;
+
+        // What the tuner measured, informational.
+        bool                Hyperthreads = false;       // More threads than physical cores.
+        double              NsPerPixel = 0.0;
+    };
+
+    //
+    // Schedules for any number of hosts in one file, a section per CPU model, mode and resolution:
+    //   [AMD Ryzen 9 7950X 16-Core Processor | sharpen | 1920x1080 -> 1920x1080]
+    //   tile = 128x32
+    //   threads = 16
+    //   traversal = Morton
+    //
+    class CAS_ScheduleCache
+    {
+    public:
+        static std::string MakeKey(const std::string& cpuName, CAS_State casState, uint32_t renderWidth, uint32_t renderHeight, uint32_t width, uint32_t height);
+
+        // Returns false when the file is missing or unreadable, the cache is then empty.
+        bool Load(const char* pPath);
+        bool Save(const char* pPath) const;
+
+        bool Find(const std::string& key, CAS_Schedule& schedule) const;
+        void Store(const std::string& key, const CAS_Schedule& schedule) { m_entries[key] = schedule; }
+
+    private:
+        std::map<std::string, CAS_Schedule> m_entries;
+    };
+}
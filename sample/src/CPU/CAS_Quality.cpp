@@ -0,0 +1,108 @@
+//CAS Sample
+//
+// Copyright(c) 2019 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "CAS_Quality.h"
+
+namespace CAS_SAMPLE_CPU
+{
+    // SSIM with the usual constants for a dynamic range of 1, on 8x8 windows stepped by 4 pixels.
+    static double CasSsim(const std::vector<double>& a, const std::vector<double>& b, uint32_t width, uint32_t height)
+    {
+        const uint32_t window = 8;
+        const uint32_t step = 4;
+        const double c1 = 0.01 * 0.01;
+        const double c2 = 0.03 * 0.03;
+        if (width < window || height < window)
+        {
+            return 1.0;
+        }
+
+        double sum = 0.0;
+        uint32_t count = 0;
+        for (uint32_t y0 = 0; y0 + window <= height; y0 += step)
+        {
+            for (uint32_t x0 = 0; x0 + window <= width; x0 += step)
+            {
+                double sumA = 0.0, sumB = 0.0, sumAA = 0.0, sumBB = 0.0, sumAB = 0.0;
+                for (uint32_t y = y0; y < y0 + window; ++y)
+                {
+                    for (uint32_t x = x0; x < x0 + window; ++x)
+                    {
+                        const double va = a[static_cast<size_t>(y) * width + x];
+                        const double vb = b[static_cast<size_t>(y) * width + x];
+                        sumA += va;
+                        sumB += vb;
+                        sumAA += va * va;
+                        sumBB += vb * vb;
+                        sumAB += va * vb;
+                    }
+                }
+                const double n = static_cast<double>(window * window);
+                const double meanA = sumA / n;
+                const double meanB = sumB / n;
+                const double varA = sumAA / n - meanA * meanA;
+                const double varB = sumBB / n - meanB * meanB;
+                const double covariance = sumAB / n - meanA * meanB;
+                sum += ((2.0 * meanA * meanB + c1) * (2.0 * covariance + c2)) /
+                       ((meanA * meanA + meanB * meanB + c1) * (varA + varB + c2));
+                ++count;
+            }
+        }
+        return sum / count;
+    }
+
+    void CAS_Quality::Measure(const CAS_Image& output, const CAS_ReferenceImage& reference, CAS_QualityStats& stats)
+    {
+        const size_t pixels = static_cast<size_t>(output.Width) * output.Height;
+        std::vector<double> lumaOutput(pixels), lumaReference(pixels);
+
+        double maxError = 0.0, sumError = 0.0, sumSquared = 0.0;
+        for (uint32_t y = 0; y < output.Height; ++y)
+        {
+            for (uint32_t x = 0; x < output.Width; ++x)
+            {
+                float rgb[3];
+                CAS_Filter::LoadPixel(output, x, y, rgb[0], rgb[1], rgb[2]);
+                const size_t index = static_cast<size_t>(y) * output.Width + x;
+                const double* pRef = &reference.Data[index * 3];
+                double value[3];
+                for (int c = 0; c < 3; ++c)
+                {
+                    value[c] = std::isnan(rgb[c]) ? (pRef[c] < 0.5 ? 1.0 : 0.0) : static_cast<double>(rgb[c]);
+                    double error = std::fabs(value[c] - pRef[c]);
+                    maxError = std::max(maxError, error);
+                    sumError += error;
+                    sumSquared += error * error;
+                }
+                lumaOutput[index] = 0.2126 * value[0] + 0.7152 * value[1] + 0.0722 * value[2];
+                lumaReference[index] = 0.2126 * pRef[0] + 0.7152 * pRef[1] + 0.0722 * pRef[2];
+            }
+        }
+
+        const double count = static_cast<double>(pixels) * 3;
+        stats.MaxError = maxError;
+        stats.MeanError = sumError / count;
+        stats.Psnr = sumSquared > 0.0 ? 10.0 * std::log10(count / sumSquared) : INFINITY;
+        stats.Ssim = CasSsim(lumaOutput, lumaReference, output.Width, output.Height);
+    }
+}
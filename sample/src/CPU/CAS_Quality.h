@@ -0,0 +1,44 @@
+//CAS Sample
+//
+// Copyright(c) 2019 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include "CAS_CPU.h"
+#include "CAS_Reference.h"
+
+namespace CAS_SAMPLE_CPU
+{
+    struct CAS_QualityStats
+    {
+        double MaxError;    // Largest absolute RGB difference.
+        double MeanError;
+        double Psnr;        // dB over RGB in {0 to 1}, infinity when identical.
+        double Ssim;        // Mean SSIM of the Rec. 709 luminance over 8x8 windows, 1 when identical.
+    };
+
+    //
+    // Full reference image quality of a filter output, used by CAS_Compare and CAS_Tune.
+    // A NaN output sample is replaced by the farthest value in {0 to 1} from the reference.
+    //
+    class CAS_Quality
+    {
+    public:
+        static void Measure(const CAS_Image& output, const CAS_ReferenceImage& reference, CAS_QualityStats& stats);
+    };
+}
@@ -0,0 +1,226 @@
+//CAS Sample
+//
+// Copyright(c) 2019 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <algorithm>
+
+#include "CAS_Reference.h"
+
+// CAS
+#define A_CPU
+#if defined(__GNUC__)
+#define A_GCC
+#endif
+#include "ffx_a.h"
+
+namespace CAS_SAMPLE_CPU
+{
+    struct CasRefPixel
+    {
+        AD1 c[3];
+    };
+
+    class CasRefSource
+    {
+    public:
+        explicit CasRefSource(const CAS_Image& image)
+            : m_width(static_cast<int32_t>(image.Width)), m_height(static_cast<int32_t>(image.Height)), m_pixels(image.Width * image.Height)
+        {
+            for (uint32_t y = 0; y < image.Height; ++y)
+            {
+                for (uint32_t x = 0; x < image.Width; ++x)
+                {
+                    float r, g, b;
+                    CAS_Filter::LoadPixel(image, x, y, r, g, b);
+                    CasRefPixel& p = m_pixels[y * image.Width + x];
+                    p.c[0] = r;
+                    p.c[1] = g;
+                    p.c[2] = b;
+                }
+            }
+        }
+
+        // Clamped to the edge like the CPU filter.
+        AD1 Load(int32_t x, int32_t y, int channel) const
+        {
+            x = std::min(std::max(x, 0), m_width - 1);
+            y = std::min(std::max(y, 0), m_height - 1);
+            return m_pixels[y * m_width + x].c[channel];
+        }
+
+    private:
+        int32_t                     m_width;
+        int32_t                     m_height;
+        std::vector<CasRefPixel>    m_pixels;
+    };
+
+    // Soft min and max of the 3x3 neighborhood centered on (x,y), 2.0x bigger with CAS_BETTER_DIAGONALS.
+    static void CasRefSoftMinMax(const CasRefSource& src, int32_t x, int32_t y, int channel, bool betterDiagonals, AD1& mn, AD1& mx)
+    {
+        AD1 b = src.Load(x, y - 1, channel);
+        AD1 d = src.Load(x - 1, y, channel);
+        AD1 e = src.Load(x, y, channel);
+        AD1 f = src.Load(x + 1, y, channel);
+        AD1 h = src.Load(x, y + 1, channel);
+        mn = AMinD1(AMinD1(AMinD1(d, e), AMinD1(f, b)), h);
+        mx = AMaxD1(AMaxD1(AMaxD1(d, e), AMaxD1(f, b)), h);
+        if (betterDiagonals)
+        {
+            AD1 a = src.Load(x - 1, y - 1, channel);
+            AD1 c = src.Load(x + 1, y - 1, channel);
+            AD1 g = src.Load(x - 1, y + 1, channel);
+            AD1 i = src.Load(x + 1, y + 1, channel);
+            mn = mn + AMinD1(AMinD1(AMinD1(mn, a), AMinD1(c, g)), i);
+            mx = mx + AMaxD1(AMaxD1(AMaxD1(mx, a), AMaxD1(c, g)), i);
+        }
+    }
+
+    // Negative lobe weight, an all black neighborhood gives 0 like saturate(NaN) does on the GPU.
+    static AD1 CasRefLobeWeight(AD1 mn, AD1 mx, bool betterDiagonals, AD1 peak)
+    {
+        if (mx <= AD1_(0.0))
+        {
+            return AD1_(0.0);
+        }
+        AD1 amp = ASatD1(AMinD1(mn, AD1_(betterDiagonals ? 2.0 : 1.0) - mx) * ARcpD1(mx));
+        return ASqrtD1(amp) * peak;
+    }
+
+    void CAS_Reference::Filter(const CAS_Image& input, uint32_t width, uint32_t height, bool sharpenOnly, float sharpness, uint32_t variant,
+                               CAS_ReferenceImage& output)
+    {
+        const bool betterDiagonals = (variant & CAS_Variant_BetterDiagonals) != 0;
+        const bool slow = (variant & CAS_Variant_Slow) != 0;
+        const AD1 peak = -ARcpD1(ALerpD1(AD1_(8.0), AD1_(5.0), AD1_(sharpness)));
+        const CasRefSource src(input);
+
+        output.Width = width;
+        output.Height = height;
+        output.Data.assign(static_cast<size_t>(width) * height * 3, 0.0);
+
+        // Same pixel mapping as CasSetup(): source position = (ip + 0.5) * in / out - 0.5.
+        const AD1 scaleX = AD1_(input.Width) / AD1_(width);
+        const AD1 scaleY = AD1_(input.Height) / AD1_(height);
+
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                AD1* pOut = &output.Data[(static_cast<size_t>(y) * width + x) * 3];
+                if (sharpenOnly)
+                {
+                    const int32_t sx = static_cast<int32_t>(x);
+                    const int32_t sy = static_cast<int32_t>(y);
+                    AD1 w[3];
+                    for (int c = 0; c < 3; ++c)
+                    {
+                        AD1 mn, mx;
+                        CasRefSoftMinMax(src, sx, sy, c, betterDiagonals, mn, mx);
+                        w[c] = CasRefLobeWeight(mn, mx, betterDiagonals, peak);
+                    }
+                    for (int c = 0; c < 3; ++c)
+                    {
+                        // Using green coef only unless CAS_SLOW.
+                        const AD1 wc = slow ? w[c] : w[1];
+                        AD1 sum = (src.Load(sx, sy - 1, c) + src.Load(sx - 1, sy, c) + src.Load(sx + 1, sy, c) + src.Load(sx, sy + 1, c)) * wc + src.Load(sx, sy, c);
+                        pOut[c] = ASatD1(sum * ARcpD1(AD1_(1.0) + AD1_(4.0) * wc));
+                    }
+                    continue;
+                }
+
+                const AD1 ppx = (AD1_(x) + AD1_(0.5)) * scaleX - AD1_(0.5);
+                const AD1 ppy = (AD1_(y) + AD1_(0.5)) * scaleY - AD1_(0.5);
+                const AD1 fx = AFloorD1(ppx);
+                const AD1 fy = AFloorD1(ppy);
+                const AD1 tx = ppx - fx;
+                const AD1 ty = ppy - fy;
+                const int32_t sx = static_cast<int32_t>(fx);
+                const int32_t sy = static_cast<int32_t>(fy);
+
+                // Lobe weights and green contrast of the no-scaling results at f, g, j, k.
+                AD1 w[4][3], range[4];
+                for (int q = 0; q < 4; ++q)
+                {
+                    for (int c = 0; c < 3; ++c)
+                    {
+                        AD1 mn, mx;
+                        CasRefSoftMinMax(src, sx + (q & 1), sy + (q >> 1), c, betterDiagonals, mn, mx);
+                        w[q][c] = CasRefLobeWeight(mn, mx, betterDiagonals, peak);
+                        if (c == 1)
+                        {
+                            range[q] = mx - mn;
+                        }
+                    }
+                }
+
+                // Bilinear weights thinned by the local contrast.
+                const AD1 thinB = AD1_(1.0 / 32.0);
+                AD1 s = (AD1_(1.0) - tx) * (AD1_(1.0) - ty) * ARcpD1(thinB + range[0]);
+                AD1 t = tx * (AD1_(1.0) - ty) * ARcpD1(thinB + range[1]);
+                AD1 u = (AD1_(1.0) - tx) * ty * ARcpD1(thinB + range[2]);
+                AD1 v = tx * ty * ARcpD1(thinB + range[3]);
+
+                for (int c = 0; c < 3; ++c)
+                {
+                    const int wc = slow ? c : 1;
+                    const AD1 wf = w[0][wc], wg = w[1][wc], wj = w[2][wc], wk = w[3][wc];
+                    const AD1 qbe = wf * s;
+                    const AD1 qch = wg * t;
+                    const AD1 qf = wg * t + wj * u + s;
+                    const AD1 qg = wf * s + wk * v + t;
+                    const AD1 qj = wf * s + wk * v + u;
+                    const AD1 qk = wg * t + wj * u + v;
+                    const AD1 qin = wj * u;
+                    const AD1 qlo = wk * v;
+
+                    //    b c
+                    //  e f g h
+                    //  i j k l
+                    //    n o
+                    AD1 sum = (src.Load(sx, sy - 1, c) + src.Load(sx - 1, sy, c)) * qbe +
+                              (src.Load(sx + 1, sy - 1, c) + src.Load(sx + 2, sy, c)) * qch +
+                              (src.Load(sx - 1, sy + 1, c) + src.Load(sx, sy + 2, c)) * qin +
+                              (src.Load(sx + 2, sy + 1, c) + src.Load(sx + 1, sy + 2, c)) * qlo +
+                              src.Load(sx, sy, c) * qf + src.Load(sx + 1, sy, c) * qg +
+                              src.Load(sx, sy + 1, c) * qj + src.Load(sx + 1, sy + 1, c) * qk;
+                    AD1 weight = AD1_(2.0) * (qbe + qch + qin + qlo) + qf + qg + qj + qk;
+                    pOut[c] = ASatD1(sum * ARcpD1(weight));
+                }
+            }
+        }
+    }
+
+    void CAS_Reference::FromImage(const CAS_Image& image, CAS_ReferenceImage& output)
+    {
+        output.Width = image.Width;
+        output.Height = image.Height;
+        output.Data.resize(static_cast<size_t>(image.Width) * image.Height * 3);
+        for (uint32_t y = 0; y < image.Height; ++y)
+        {
+            for (uint32_t x = 0; x < image.Width; ++x)
+            {
+                float r, g, b;
+                CAS_Filter::LoadPixel(image, x, y, r, g, b);
+                double* pOut = &output.Data[(static_cast<size_t>(y) * image.Width + x) * 3];
+                pOut[0] = r;
+                pOut[1] = g;
+                pOut[2] = b;
+            }
+        }
+    }
+}
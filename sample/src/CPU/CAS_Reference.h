@@ -0,0 +1,53 @@
+//CAS Sample
+//
+// Copyright(c) 2019 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "CAS_CPU.h"
+
+namespace CAS_SAMPLE_CPU
+{
+    // Interleaved double RGB, no alpha.
+    struct CAS_ReferenceImage
+    {
+        uint32_t                Width = 0;
+        uint32_t                Height = 0;
+        std::vector<double>     Data;
+    };
+
+    //
+    // Double precision CAS used to measure the error of the fast kernels.
+    // Follows CasFilter() with CAS_GO_SLOWER semantics in 64-bit math: exact reciprocals and square roots instead of the
+    // APrx*() approximations, and the sharpness and pixel mapping derived in double instead of from the float CasSetup()
+    // constants. CAS_BETTER_DIAGONALS and CAS_SLOW change the algorithm rather than its precision, so the reference takes
+    // the variant and honors those two. Edges are clamped like the CPU filter.
+    //
+    class CAS_Reference
+    {
+    public:
+        // input is render sized, width x height is the output size (equal to the input for sharpen only).
+        static void Filter(const CAS_Image& input, uint32_t width, uint32_t height, bool sharpenOnly, float sharpness, uint32_t variant, CAS_ReferenceImage& output);
+
+        // Uses an image as the reference, for example a target supplied instead of the double precision result.
+        static void FromImage(const CAS_Image& image, CAS_ReferenceImage& output);
+    };
+}
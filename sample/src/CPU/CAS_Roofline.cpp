@@ -0,0 +1,115 @@
+//CAS Sample
+//
+// Copyright(c) 2019 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "CAS_Kernels.h"
+#include "CAS_Roofline.h"
+
+namespace CAS_SAMPLE_CPU
+{
+    static double CasSeconds(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+    {
+        return std::chrono::duration<double>(end - start).count();
+    }
+
+    double CAS_Roofline::GetCompulsoryBytesPerPixel(uint32_t renderWidth, uint32_t renderHeight, uint32_t width, uint32_t height, CAS_Format format)
+    {
+        const double sourceTexels = static_cast<double>(renderWidth) * renderHeight;
+        const double outputPixels = static_cast<double>(width) * height;
+        return (sourceTexels / outputPixels + 1.0) * CAS_Filter::GetFormatSize(format);
+    }
+
+    double CAS_Roofline::MeasureBandwidth(uint32_t threadCount)
+    {
+        // 2 x 128MB, well past any last level cache.
+        const size_t count = static_cast<size_t>(32) << 20;
+        const size_t chunk = static_cast<size_t>(1) << 18;
+        const uint32_t chunks = static_cast<uint32_t>(count / chunk);
+        std::vector<float> source(count), destination(count);
+
+        CAS_ThreadPool pool;
+        pool.OnCreate(threadCount);
+
+        // Touch the pages from the threads that will stream them.
+        pool.Run(chunks, [&](uint32_t item, uint32_t)
+        {
+            std::fill(source.begin() + item * chunk, source.begin() + (item + 1) * chunk, 1.0f);
+            std::fill(destination.begin() + item * chunk, destination.begin() + (item + 1) * chunk, 0.0f);
+        });
+
+        double best = 0.0;
+        for (int pass = 0; pass < 5; ++pass)
+        {
+            auto start = std::chrono::steady_clock::now();
+            pool.Run(chunks, [&](uint32_t item, uint32_t)
+            {
+                const float* pSrc = source.data() + item * chunk;
+                float* pDst = destination.data() + item * chunk;
+                for (size_t i = 0; i < chunk; ++i)
+                {
+                    pDst[i] = pSrc[i];
+                }
+            });
+            auto end = std::chrono::steady_clock::now();
+            best = std::max(best, 2.0 * count * sizeof(float) / CasSeconds(start, end));
+        }
+
+        pool.OnDestroy();
+        return best * 1e-9;
+    }
+
+    double CAS_Roofline::MeasurePeakFlops(CAS_Tier tier, uint32_t threadCount)
+    {
+        const CAS_KernelTable* pKernels = CAS_GetKernelTable(tier);
+        if (!pKernels)
+        {
+            return 0.0;
+        }
+
+        CAS_ThreadPool pool;
+        pool.OnCreate(threadCount);
+        const uint32_t threads = pool.GetThreadCount();
+
+        // One item per thread, a pool thread that runs a second item only makes the result conservative.
+        double best = 0.0;
+        for (int pass = 0; pass < 3; ++pass)
+        {
+            std::vector<uint64_t> flops(threads, 0);
+            auto start = std::chrono::steady_clock::now();
+            pool.Run(threads, [&](uint32_t item, uint32_t)
+            {
+                flops[item] = pKernels->Peak(1u << 22);
+            });
+            auto end = std::chrono::steady_clock::now();
+
+            double total = 0.0;
+            for (uint64_t f : flops)
+            {
+                total += static_cast<double>(f);
+            }
+            best = std::max(best, total / CasSeconds(start, end));
+        }
+
+        pool.OnDestroy();
+        return best * 1e-9;
+    }
+}
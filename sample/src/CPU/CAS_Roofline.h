@@ -0,0 +1,56 @@
+//CAS Sample
+//
+// Copyright(c) 2019 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+
+#include "CAS_CPU.h"
+
+namespace CAS_SAMPLE_CPU
+{
+    // Work done by one kernel per output pixel, independent of the tier since the math is shared.
+    struct CAS_KernelCost
+    {
+        double      Flops;      // Float add, sub, mul, min, max, rcp and sqrt, ASatF1() counts as a min and a max.
+        double      IntOps;     // Integer ops of the APrx*() approximations, they issue on the same vector ALUs.
+        double      Loads;      // Floats read from the planar source window.
+        double      Stores;     // Floats written to the planar output tile.
+    };
+
+    //
+    // Inputs for a roofline view of the CPU kernels: counted work per pixel, compulsory memory traffic per pixel and the
+    // host's measured copy bandwidth and multiply-add throughput.
+    //
+    class CAS_Roofline
+    {
+    public:
+        // Runs the kernel once on a small tile with counting lanes.
+        static void CountKernelCost(bool sharpenOnly, uint32_t variant, CAS_KernelCost& cost);
+
+        // Bytes per output pixel that have to come from or go to memory: every source texel read once, every output pixel written once.
+        static double GetCompulsoryBytesPerPixel(uint32_t renderWidth, uint32_t renderHeight, uint32_t width, uint32_t height, CAS_Format format);
+
+        // Read plus write bandwidth of a streaming copy over buffers much larger than the caches, in GB/s.
+        static double MeasureBandwidth(uint32_t threadCount);
+
+        // Float operations per second of independent multiply-add chains on the tier's lanes, in GFLOP/s.
+        static double MeasurePeakFlops(CAS_Tier tier, uint32_t threadCount);
+    };
+}
@@ -0,0 +1,164 @@
+//CAS Sample
+//
+// Copyright(c) 2019 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Per host tuning of how the CPU filter runs: tile size, thread count (with or without SMT siblings) and the order tiles
+// are handed out. The filter's result does not depend on any of these, so the sweep runs on the caller's real frame.
+
+#include "CAS_CPU.h"
+#include "CAS_Profile.h"
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+namespace CAS_SAMPLE_CPU
+{
+    static const uint32_t s_TileWidths[] = { 32, 64, 128, 256 };
+    static const uint32_t s_TileHeights[] = { 8, 16, 32, 64 };
+
+    void CAS_Filter::ApplySchedule(const CAS_Schedule& schedule)
+    {
+        SetThreadCount(schedule.Threads);
+        SetTileSize(schedule.TileWidth, schedule.TileHeight);
+        SetTraversal(schedule.Traversal);
+    }
+
+    bool CAS_Filter::LoadSchedule(const char* pCachePath, CAS_State casState)
+    {
+        CAS_ScheduleCache cache;
+        CAS_Schedule schedule;
+        if (!cache.Load(pCachePath) ||
+            !cache.Find(CAS_ScheduleCache::MakeKey(GetCpuName(), casState, m_renderWidth, m_renderHeight, m_width, m_height), schedule))
+        {
+            return false;
+        }
+        ApplySchedule(schedule);
+        return true;
+    }
+
+    CAS_Schedule CAS_Filter::TuneSchedule(const CAS_Image& input, const CAS_Image& output, CAS_State casState)
+    {
+        const uint32_t hardwareThreads = CAS_ThreadPool::GetHardwareThreadCount();
+        const uint32_t physicalCores = CAS_ThreadPool::GetPhysicalCoreCount();
+
+        // Median of a few runs after a warm up, per output pixel.
+        auto measure = [&](const CAS_Schedule& schedule)
+        {
+            ApplySchedule(schedule);
+            Upscale(input, output, casState);
+            std::vector<double> samples;
+            for (int i = 0; i < 5; ++i)
+            {
+                auto start = std::chrono::steady_clock::now();
+                Upscale(input, output, casState);
+                auto end = std::chrono::steady_clock::now();
+                samples.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+            }
+            std::nth_element(samples.begin(), samples.begin() + 2, samples.end());
+            return samples[2] / (static_cast<double>(output.Width) * output.Height);
+        };
+
+        auto sweepTiles = [&](CAS_Schedule& best)
+        {
+            for (uint32_t width : s_TileWidths)
+            {
+                for (uint32_t height : s_TileHeights)
+                {
+                    // Tiles past the frame size all behave the same.
+                    if ((width > output.Width && width != s_TileWidths[0]) || (height > output.Height && height != s_TileHeights[0]))
+                    {
+                        continue;
+                    }
+                    CAS_Schedule schedule = best;
+                    schedule.TileWidth = width;
+                    schedule.TileHeight = height;
+                    schedule.NsPerPixel = measure(schedule);
+                    if (schedule.NsPerPixel < best.NsPerPixel)
+                    {
+                        best = schedule;
+                    }
+                }
+            }
+        };
+
+        // Every thread first, then coordinate descent: tile size, traversal, thread count, tile size again.
+        CAS_Schedule best;
+        best.Threads = hardwareThreads;
+        best.NsPerPixel = measure(best);
+        sweepTiles(best);
+
+        for (int traversal = CAS_Traversal_RowMajor + 1; traversal < CAS_Traversal_Count; ++traversal)
+        {
+            CAS_Schedule schedule = best;
+            schedule.Traversal = static_cast<CAS_Traversal>(traversal);
+            schedule.NsPerPixel = measure(schedule);
+            if (schedule.NsPerPixel < best.NsPerPixel)
+            {
+                best = schedule;
+            }
+        }
+
+        std::vector<uint32_t> threadCounts;
+        for (uint32_t threads = 1; threads < physicalCores; threads *= 2)
+        {
+            threadCounts.push_back(threads);
+        }
+        threadCounts.push_back(physicalCores);
+        const uint32_t allThreads = best.Threads;
+        for (uint32_t threads : threadCounts)
+        {
+            if (threads == allThreads)
+            {
+                continue;
+            }
+            CAS_Schedule schedule = best;
+            schedule.Threads = threads;
+            schedule.NsPerPixel = measure(schedule);
+            if (schedule.NsPerPixel < best.NsPerPixel)
+            {
+                best = schedule;
+            }
+        }
+        if (best.Threads != allThreads)
+        {
+            sweepTiles(best);
+        }
+
+        best.Hyperthreads = best.Threads > physicalCores;
+        ApplySchedule(best);
+        Upscale(input, output, casState);
+        return best;
+    }
+
+    void CAS_Filter::AutotuneSchedule(const char* pCachePath, const CAS_Image& input, const CAS_Image& output, CAS_State casState)
+    {
+        CAS_ScheduleCache cache;
+        cache.Load(pCachePath);
+        const std::string key = CAS_ScheduleCache::MakeKey(GetCpuName(), casState, m_renderWidth, m_renderHeight, m_width, m_height);
+        CAS_Schedule schedule;
+        if (cache.Find(key, schedule))
+        {
+            ApplySchedule(schedule);
+            return;
+        }
+
+        cache.Store(key, TuneSchedule(input, output, casState));
+        cache.Save(pCachePath);
+    }
+}
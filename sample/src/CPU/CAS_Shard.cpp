@@ -0,0 +1,507 @@
+//CAS Sample
+//
+// Copyright(c) 2019 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Multi-process sharded CAS for frames that outgrow one process (16K and up).
+// The coordinator splits the output into horizontal bands (CAS_PlanShards), starts a worker process per band and waits
+// for them. Each worker produces only the input rows it owns (generated, or read from the --input file), swaps the few halo rows at its band edges with its
+// neighbours and filters its band with CAS_Filter::UpscaleRegion(), which keeps the whole frame's CasSetup() constants
+// and only offsets the band by its integer origin, so the result is bit identical to one process filtering the frame.
+// With --transport shm the halos and the output frame live in one POSIX shared memory segment. With --transport socket
+// the coordinator relays the halos and gathers the bands over TCP: it starts workers on the loopback interface, or with
+// --listen waits for workers started elsewhere with --worker-connect <host>:<port>.
+
+#include "CAS_Bench.h"
+#include "CAS_ImageFile.h"
+#include "CAS_Shard.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace CAS_SAMPLE_CPU;
+
+struct ShardOptions
+{
+    CAS_ShardJob        Job = {};
+    bool                SocketTransport = false;
+    float               Scale = 1.5f;
+    uint32_t            Width = 7680;
+    uint32_t            Height = 4320;
+    int32_t             ListenPort = -1;        // Wait for remote workers on this port instead of starting them.
+    const char         *pBindAddress = "127.0.0.1";
+    bool                Verify = true;
+    uint32_t            TimeoutMs = 120000;
+    const char         *pInputPath = nullptr;   // PPM or PFM input instead of the generated one, loaded by every process.
+    std::vector<uint8_t> InputStorage;
+    CAS_Image           Input = {};
+
+    // Worker side.
+    const char         *pWorkerShm = nullptr;
+    const char         *pWorkerConnect = nullptr;
+    uint32_t            WorkerShard = 0;
+};
+
+// --format values, by CAS_Format.
+static const char* const s_FormatNames[] = { "rgba32f", "rgba16f", "rgba8" };
+
+static void PrintUsage()
+{
+    printf("Usage: CAS_Shard [options]\n"
+           "  --shards <n>                      Worker processes, one horizontal band each (default 4)\n"
+           "  --transport <shm|socket>          Halo and band exchange (default shm)\n"
+           "  --size <w>x<h>                    Input size (default 7680x4320)\n"
+           "  --input <file>                    PPM or PFM input instead of the generated one, every worker reads its rows\n"
+           "                                    (remote workers need the same file and --format)\n"
+           "  --mode <sharpen|upsample>         Filter mode (default sharpen)\n"
+           "  --scale <s>                       Output size over input size for upsample (default 1.5)\n"
+           "  --format <rgba32f|rgba16f|rgba8>  Input and output format (default rgba8)\n"
+           "  --sharpness <s>                   Sharpness in [0, 1] (default 0.5)\n"
+           "  --tier <scalar|sse2|avx2|best>    Kernel tier of the workers (default best)\n"
+           "  --threads <n>                     Threads per worker, 0 = all hardware threads (default cores / shards)\n"
+           "  --listen <port>                   Socket transport: wait for remote workers instead of starting local ones\n"
+           "  --bind <address>                  Socket transport: address to listen on (default 127.0.0.1)\n"
+           "  --verify <0|1>                    Compare with a single process run of the whole frame (default 1)\n"
+           "  --timeout <ms>                    Give up on workers after this long (default 120000)\n"
+           "Worker processes (started by the coordinator, or by hand on other hosts):\n"
+           "  --worker-shm <name> --shard <k>   Run band k of the shared memory job\n"
+           "  --worker-connect <host>:<port>    Run the band the coordinator assigns\n");
+}
+
+static bool ParseOptions(int argc, char** argv, ShardOptions& options)
+{
+    CAS_ShardJob& job = options.Job;
+    job.State = CAS_State_SharpenOnly;
+    job.Format = CAS_Format_RGBA8;
+    job.Sharpness = 0.5f;
+    job.Tier = CAS_Tier_Count;
+    job.Variant = CAS_Variant_Default;
+    job.Precision = CAS_Precision_FP32;
+    job.ShardCount = 4;
+    job.ThreadsPerShard = ~0u;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const char* pArg = argv[i];
+        const char* pValue = (i + 1 < argc) ? argv[++i] : nullptr;
+        if (!pValue)
+        {
+            return false;
+        }
+        if (strcmp(pArg, "--shards") == 0)
+        {
+            job.ShardCount = static_cast<uint32_t>(std::max(1, atoi(pValue)));
+        }
+        else if (strcmp(pArg, "--transport") == 0)
+        {
+            options.SocketTransport = strcmp(pValue, "socket") == 0;
+        }
+        else if (strcmp(pArg, "--size") == 0)
+        {
+            if (sscanf(pValue, "%ux%u", &options.Width, &options.Height) != 2 || options.Width == 0 || options.Height == 0)
+            {
+                return false;
+            }
+        }
+        else if (strcmp(pArg, "--input") == 0)
+        {
+            options.pInputPath = pValue;
+        }
+        else if (strcmp(pArg, "--mode") == 0)
+        {
+            job.State = strcmp(pValue, "upsample") == 0 ? CAS_State_Upsample : CAS_State_SharpenOnly;
+        }
+        else if (strcmp(pArg, "--scale") == 0)
+        {
+            options.Scale = static_cast<float>(atof(pValue));
+        }
+        else if (strcmp(pArg, "--format") == 0)
+        {
+            job.Format = strcmp(pValue, "rgba32f") == 0 ? CAS_Format_RGBA32F : strcmp(pValue, "rgba16f") == 0 ? CAS_Format_RGBA16F : CAS_Format_RGBA8;
+        }
+        else if (strcmp(pArg, "--sharpness") == 0)
+        {
+            job.Sharpness = static_cast<float>(atof(pValue));
+        }
+        else if (strcmp(pArg, "--tier") == 0)
+        {
+            job.Tier = strcmp(pValue, "scalar") == 0 ? CAS_Tier_Scalar : strcmp(pValue, "sse2") == 0 ? CAS_Tier_SSE2 :
+                strcmp(pValue, "avx2") == 0 ? CAS_Tier_AVX2 : CAS_Tier_Count;
+        }
+        else if (strcmp(pArg, "--threads") == 0)
+        {
+            job.ThreadsPerShard = static_cast<uint32_t>(atoi(pValue));
+        }
+        else if (strcmp(pArg, "--listen") == 0)
+        {
+            options.ListenPort = atoi(pValue);
+        }
+        else if (strcmp(pArg, "--bind") == 0)
+        {
+            options.pBindAddress = pValue;
+        }
+        else if (strcmp(pArg, "--verify") == 0)
+        {
+            options.Verify = atoi(pValue) != 0;
+        }
+        else if (strcmp(pArg, "--timeout") == 0)
+        {
+            options.TimeoutMs = static_cast<uint32_t>(std::max(1, atoi(pValue)));
+        }
+        else if (strcmp(pArg, "--worker-shm") == 0)
+        {
+            options.pWorkerShm = pValue;
+        }
+        else if (strcmp(pArg, "--shard") == 0)
+        {
+            options.WorkerShard = static_cast<uint32_t>(atoi(pValue));
+        }
+        else if (strcmp(pArg, "--worker-connect") == 0)
+        {
+            options.pWorkerConnect = pValue;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    if (options.pInputPath)
+    {
+        std::vector<uint8_t> fileStorage;
+        CAS_Image file = {};
+        std::string error;
+        if (!CAS_ImageFile::Load(options.pInputPath, fileStorage, file, error))
+        {
+            printf("%s\n", error.c_str());
+            return false;
+        }
+        ConvertImage(file, options.InputStorage, options.Input, static_cast<CAS_Format>(job.Format));
+        options.Width = file.Width;
+        options.Height = file.Height;
+    }
+
+    job.InputWidth = options.Width;
+    job.InputHeight = options.Height;
+    job.OutputWidth = options.Width;
+    job.OutputHeight = options.Height;
+    if (job.State == CAS_State_Upsample)
+    {
+        job.OutputWidth = static_cast<uint32_t>(options.Width * options.Scale + 0.5f);
+        job.OutputHeight = static_cast<uint32_t>(options.Height * options.Scale + 0.5f);
+    }
+    if (job.ThreadsPerShard == ~0u)
+    {
+        job.ThreadsPerShard = std::max(1u, CAS_ThreadPool::GetHardwareThreadCount() / job.ShardCount);
+    }
+    return true;
+}
+
+// Input rows of a worker: from the --input file, or generated.
+static CAS_ShardInputFn GetInputFn(const ShardOptions& options)
+{
+    if (!options.pInputPath)
+    {
+        return [](const CAS_ShardJob& job, uint32_t y0, const CAS_Image& image)
+        {
+            CAS_FillShardInput(job, y0, image);
+            return true;
+        };
+    }
+    const CAS_Image& input = options.Input;
+    return [&input](const CAS_ShardJob& job, uint32_t y0, const CAS_Image& image)
+    {
+        // A remote worker's file has to be the coordinator's.
+        if (job.InputWidth != input.Width || job.InputHeight != input.Height || job.Format != static_cast<uint32_t>(input.Format) ||
+            image.Width != input.Width || y0 + image.Height > input.Height)
+        {
+            return false;
+        }
+        const size_t rowSize = static_cast<size_t>(image.Width) * CAS_Filter::GetFormatSize(input.Format);
+        for (uint32_t y = 0; y < image.Height; ++y)
+        {
+            memcpy(static_cast<uint8_t*>(image.pData) + static_cast<size_t>(y) * image.RowPitch,
+                   static_cast<const uint8_t*>(input.pData) + static_cast<size_t>(y0 + y) * input.RowPitch, rowSize);
+        }
+        return true;
+    };
+}
+
+static int RunWorker(const ShardOptions& options)
+{
+    CAS_ShardPlan plan;
+    std::string error;
+    if (options.pWorkerShm)
+    {
+        CAS_ShardSharedMemory shm;
+        if (!shm.Open(options.pWorkerShm))
+        {
+            printf("Shard %u: %s\n", options.WorkerShard, shm.GetError().c_str());
+            return 1;
+        }
+        if (!CAS_PlanShards(shm.GetJob(), plan, error) || options.WorkerShard >= plan.Bands.size() ||
+            !CAS_RunShard(plan, options.WorkerShard, shm, GetInputFn(options), error))
+        {
+            printf("Shard %u: %s\n", options.WorkerShard, error.empty() ? "no such shard" : error.c_str());
+            shm.SetFailed();
+            return 1;
+        }
+        return 0;
+    }
+
+    std::string host = options.pWorkerConnect;
+    const size_t colon = host.rfind(':');
+    if (colon == std::string::npos)
+    {
+        printf("--worker-connect needs <host>:<port>\n");
+        return 1;
+    }
+    const uint16_t port = static_cast<uint16_t>(atoi(host.c_str() + colon + 1));
+    host.resize(colon);
+
+    CAS_ShardSocket socket;
+    CAS_ShardJob job;
+    uint32_t shard = 0;
+    if (!socket.Connect(host.c_str(), port, job, shard))
+    {
+        printf("Worker: %s\n", socket.GetError().c_str());
+        return 1;
+    }
+    if (!CAS_PlanShards(job, plan, error) || shard >= plan.Bands.size() || !CAS_RunShard(plan, shard, socket, GetInputFn(options), error))
+    {
+        printf("Shard %u: %s\n", shard, error.empty() ? "no such shard" : error.c_str());
+        return 1;
+    }
+    return 0;
+}
+
+// Starts this executable again as a worker with the given arguments.
+static pid_t SpawnWorker(const char* pExecutable, const std::vector<std::string>& arguments)
+{
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        std::vector<char*> argv;
+        argv.push_back(const_cast<char*>(pExecutable));
+        for (const std::string& argument : arguments)
+        {
+            argv.push_back(const_cast<char*>(argument.c_str()));
+        }
+        argv.push_back(nullptr);
+        execvp(pExecutable, argv.data());
+        _exit(127);
+    }
+    return pid;
+}
+
+static bool WaitForWorkers(const std::vector<pid_t>& workers)
+{
+    bool ok = true;
+    for (pid_t pid : workers)
+    {
+        int status = 0;
+        if (pid == 0)
+        {
+            continue;       // Already reaped, see the shared memory wait.
+        }
+        if (pid < 0 || waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        {
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+static double MillisecondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Filters the whole frame in this process and compares it with the assembled bands.
+static bool VerifyFrame(const CAS_ShardJob& job, const CAS_ShardInputFn& fillInput, const CAS_Image& frame)
+{
+    const CAS_Format format = static_cast<CAS_Format>(job.Format);
+    const CAS_State state = static_cast<CAS_State>(job.State);
+    std::vector<uint8_t> inputStorage(static_cast<size_t>(job.InputWidth) * job.InputHeight * CAS_Filter::GetFormatSize(format));
+    CAS_Image input = { inputStorage.data(), job.InputWidth, job.InputHeight, job.InputWidth * CAS_Filter::GetFormatSize(format), format };
+    fillInput(job, 0, input);
+    std::vector<uint8_t> outputStorage(static_cast<size_t>(frame.RowPitch) * frame.Height);
+    CAS_Image output = frame;
+    output.pData = outputStorage.data();
+
+    CAS_Filter filter;
+    filter.OnCreate(0, static_cast<CAS_Tier>(job.Tier));
+    filter.SetVariant(job.Variant);
+    filter.SetPrecision(static_cast<CAS_Precision>(job.Precision));
+    filter.OnCreateWindowSizeDependentResources(job.InputWidth, job.InputHeight, job.OutputWidth, job.OutputHeight, state);
+    filter.UpdateSharpness(job.Sharpness, state);
+    const auto start = std::chrono::steady_clock::now();
+    filter.Upscale(input, output, state);
+    printf("Single process, %u threads: %.1f ms\n", filter.GetThreadCount(), MillisecondsSince(start));
+    filter.OnDestroy();
+
+    uint32_t badRows = 0;
+    for (uint32_t y = 0; y < frame.Height; ++y)
+    {
+        const size_t offset = static_cast<size_t>(y) * frame.RowPitch;
+        badRows += memcmp(static_cast<const uint8_t*>(frame.pData) + offset, outputStorage.data() + offset, frame.RowPitch) != 0;
+    }
+    printf("Sharded output %s the single process one (%u of %u rows differ)\n", badRows ? "DIFFERS from" : "is identical to", badRows, frame.Height);
+    return badRows == 0;
+}
+
+int main(int argc, char** argv)
+{
+    ShardOptions options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        PrintUsage();
+        return 1;
+    }
+    if (options.pWorkerShm || options.pWorkerConnect)
+    {
+        return RunWorker(options);
+    }
+
+    CAS_ShardPlan plan;
+    std::string error;
+    if (!CAS_PlanShards(options.Job, plan, error))
+    {
+        printf("%s\n", error.c_str());
+        return 1;
+    }
+    const CAS_ShardJob& job = plan.Job;
+    printf("%ux%u -> %ux%u %s %s, %u shards over %s, %u threads each, halo up to %u rows\n", job.InputWidth, job.InputHeight,
+           job.OutputWidth, job.OutputHeight, job.State == CAS_State_Upsample ? "upsample" : "sharpen",
+           s_FormatNames[job.Format],
+           job.ShardCount, options.SocketTransport ? "sockets" : "shared memory", job.ThreadsPerShard, plan.MaxHalo);
+
+    // Worker start-up is part of the time, as it is for a real job.
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<pid_t> workers;
+    bool ok = true;
+    CAS_Image frame = {};
+    std::vector<uint8_t> frameStorage;
+    CAS_ShardSharedMemory shm;
+    if (!options.SocketTransport)
+    {
+        const std::string name = "/cas_shard_" + std::to_string(getpid());
+        if (!shm.Create(name.c_str(), plan))
+        {
+            printf("%s\n", shm.GetError().c_str());
+            return 1;
+        }
+        for (uint32_t k = 0; k < job.ShardCount; ++k)
+        {
+            std::vector<std::string> arguments = { "--worker-shm", name, "--shard", std::to_string(k) };
+            if (options.pInputPath)
+            {
+                arguments.insert(arguments.end(), { "--input", options.pInputPath, "--format", s_FormatNames[job.Format] });
+            }
+            workers.push_back(SpawnWorker(argv[0], arguments));
+        }
+        ok = shm.WaitForShards(options.TimeoutMs, [&workers]()
+        {
+            // Workers that exited cleanly are marked 0, any other exit is a failure.
+            for (pid_t& pid : workers)
+            {
+                int status = 0;
+                if (pid < 0)
+                {
+                    return false;
+                }
+                if (pid > 0 && waitpid(pid, &status, WNOHANG) == pid)
+                {
+                    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+                    {
+                        return false;
+                    }
+                    pid = 0;
+                }
+            }
+            return true;
+        });
+        if (!ok)
+        {
+            // Lets the other workers stop waiting for halos.
+            shm.SetFailed();
+        }
+        if (!ok)
+        {
+            printf("%s\n", shm.GetError().c_str());
+        }
+        frame = shm.GetFrame();
+    }
+    else
+    {
+        const uint32_t pitch = job.OutputWidth * CAS_Filter::GetFormatSize(static_cast<CAS_Format>(job.Format));
+        frameStorage.resize(static_cast<size_t>(pitch) * job.OutputHeight);
+        frame = { frameStorage.data(), job.OutputWidth, job.OutputHeight, pitch, static_cast<CAS_Format>(job.Format) };
+
+        CAS_ShardSocketServer server;
+        if (!server.Listen(options.pBindAddress, static_cast<uint16_t>(std::max(options.ListenPort, 0))))
+        {
+            printf("%s\n", server.GetError().c_str());
+            return 1;
+        }
+        if (options.ListenPort >= 0)
+        {
+            printf("Waiting for %u workers on %s:%u\n", job.ShardCount, options.pBindAddress, server.GetPort());
+        }
+        else
+        {
+            const std::string address = "127.0.0.1:" + std::to_string(server.GetPort());
+            for (uint32_t k = 0; k < job.ShardCount; ++k)
+            {
+                std::vector<std::string> arguments = { "--worker-connect", address };
+                if (options.pInputPath)
+                {
+                    arguments.insert(arguments.end(), { "--input", options.pInputPath, "--format", s_FormatNames[job.Format] });
+                }
+                workers.push_back(SpawnWorker(argv[0], arguments));
+            }
+        }
+        ok = server.Run(plan, frame, options.TimeoutMs);
+        if (!ok)
+        {
+            printf("%s\n", server.GetError().c_str());
+        }
+    }
+    ok = WaitForWorkers(workers) && ok;
+    const double milliseconds = MillisecondsSince(start);
+    if (!ok)
+    {
+        printf("The sharded run failed\n");
+        return 1;
+    }
+
+    const double pixels = static_cast<double>(job.OutputWidth) * job.OutputHeight;
+    printf("Sharded: %.1f ms, %.2f ns per output pixel\n", milliseconds, milliseconds * 1.0e6 / pixels);
+    if (options.Verify && !VerifyFrame(job, GetInputFn(options), frame))
+    {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,189 @@
+//CAS Sample
+//
+// Copyright(c) 2019 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "CAS_CPU.h"
+
+namespace CAS_SAMPLE_CPU
+{
+    // Frame settings of a sharded job, sent to the workers as is.
+    struct CAS_ShardJob
+    {
+        uint32_t            InputWidth;
+        uint32_t            InputHeight;
+        uint32_t            OutputWidth;        // Equal to the input size for CAS_State_SharpenOnly.
+        uint32_t            OutputHeight;
+        uint32_t            State;              // CAS_State.
+        uint32_t            Format;             // CAS_Format of input and output.
+        float               Sharpness;
+        uint32_t            Tier;               // CAS_Tier, CAS_Tier_Count picks the best one of each worker.
+        uint32_t            Variant;
+        uint32_t            Precision;          // CAS_Precision.
+        uint32_t            ThreadsPerShard;    // 0 = all hardware threads.
+        uint32_t            ShardCount;
+    };
+
+    // Horizontal band of a shard. A shard gets the input rows it owns (CAS_ShardInputFn), gets the halo rows the filter reads beyond them
+    // from its neighbours and filters its output rows with CAS_Filter::UpscaleRegion().
+    struct CAS_ShardBand
+    {
+        uint32_t            OutputY;
+        uint32_t            OutputHeight;       // Multiple of 8 except for the last band.
+        uint32_t            InputY;
+        uint32_t            InputHeight;
+        uint32_t            HaloTop;            // Rows needed from the shard above, the last ones it owns.
+        uint32_t            HaloBottom;         // Rows needed from the shard below, the first ones it owns.
+    };
+
+    struct CAS_ShardPlan
+    {
+        CAS_ShardJob                Job;
+        std::vector<CAS_ShardBand>  Bands;
+        uint32_t                    MaxHalo;    // Largest HaloTop or HaloBottom, sizes the halo buffers.
+    };
+
+    // Splits the job's output into bands on the 8x8 block grid and assigns the input rows in proportion. Every process
+    // computes the same plan from the job. Fails when a band is too thin for its halo to come from one neighbour.
+    bool CAS_PlanShards(const CAS_ShardJob& job, CAS_ShardPlan& plan, std::string& error);
+
+    // Source of a worker's input: fills rows [y0, y0 + image.Height) of the input frame into image, which has the job's
+    // input width and format. A worker only asks for the rows it owns, from a decoder, a render or a file of its own.
+    // False fails the shard.
+    typedef std::function<bool(const CAS_ShardJob& job, uint32_t y0, const CAS_Image& image)> CAS_ShardInputFn;
+
+    // Generated input of the shard tool, a deterministic mix of gradients, edges and noise computed per texel so every
+    // shard can produce its own rows. Fills rows [y0, y0 + image.Height) of the input frame.
+    void CAS_FillShardInput(const CAS_ShardJob& job, uint32_t y0, const CAS_Image& image);
+
+    //
+    // Worker end of a shard transport. The worker owns rows [InputY, InputY + InputHeight) of the input and holds them in
+    // a slice image with HaloTop rows above and HaloBottom rows below.
+    //
+    class CAS_ShardTransport
+    {
+    public:
+        virtual ~CAS_ShardTransport() {}
+
+        // Sends the edge rows the neighbours need and receives this shard's halo rows into the slice.
+        virtual bool ExchangeHalos(const CAS_ShardPlan& plan, uint32_t shard, const CAS_Image& slice) = 0;
+        // Image the band is filtered into, OutputHeight rows.
+        virtual CAS_Image GetOutput(const CAS_ShardPlan& plan, uint32_t shard) = 0;
+        // Hands the filtered band to the coordinator.
+        virtual bool SubmitOutput(const CAS_ShardPlan& plan, uint32_t shard, const CAS_Image& output) = 0;
+
+        const std::string& GetError() const { return m_error; }
+
+    protected:
+        std::string         m_error;
+    };
+
+    // Gets the band's own input rows from input, exchanges the halos and filters the band of one shard.
+    bool CAS_RunShard(const CAS_ShardPlan& plan, uint32_t shard, CAS_ShardTransport& transport, const CAS_ShardInputFn& input, std::string& error);
+    // The same on the generated input of CAS_FillShardInput().
+    bool CAS_RunShard(const CAS_ShardPlan& plan, uint32_t shard, CAS_ShardTransport& transport, std::string& error);
+
+    //
+    // POSIX shared memory transport for shards on one host. The coordinator creates one segment holding the job, the
+    // halo rows of every band edge and the whole output frame, the workers open it by name. Halo rows are the only input
+    // that crosses processes, and the workers filter straight into the frame, so nothing else is copied.
+    //
+    class CAS_ShardSharedMemory : public CAS_ShardTransport
+    {
+    public:
+        CAS_ShardSharedMemory();
+        ~CAS_ShardSharedMemory() override;
+
+        // Coordinator: creates the segment for the plan. The name is removed again on destruction.
+        bool Create(const char* pName, const CAS_ShardPlan& plan);
+        // Coordinator: waits until every shard is done, false when one failed, alive() returned false (a worker process
+        // died before it could say so) or on timeout.
+        bool WaitForShards(uint32_t timeoutMs, const std::function<bool()>& alive);
+        // Coordinator: the output frame in the segment.
+        CAS_Image GetFrame() const;
+
+        // Worker: maps an existing segment.
+        bool Open(const char* pName);
+        const CAS_ShardJob& GetJob() const;
+        // Marks the job failed, so the coordinator and the workers stop waiting for each other.
+        void SetFailed();
+
+        bool ExchangeHalos(const CAS_ShardPlan& plan, uint32_t shard, const CAS_Image& slice) override;
+        CAS_Image GetOutput(const CAS_ShardPlan& plan, uint32_t shard) override;
+        bool SubmitOutput(const CAS_ShardPlan& plan, uint32_t shard, const CAS_Image& output) override;
+
+    private:
+        bool Map(int fd, size_t size);
+        uint8_t* GetHalo(uint32_t shard, bool top) const;
+
+        std::string         m_name;
+        bool                m_owner;
+        void               *m_pBase;
+        size_t              m_size;
+    };
+
+    //
+    // Loopback (or any TCP) socket transport for shards on several hosts. The coordinator accepts one connection per
+    // shard, sends each worker the job and its index, relays the halo rows between neighbours once all of them arrived
+    // and collects the filtered bands into its frame.
+    //
+    class CAS_ShardSocket : public CAS_ShardTransport
+    {
+    public:
+        CAS_ShardSocket();
+        ~CAS_ShardSocket() override;
+
+        // Worker: connects to the coordinator and receives the job and the shard index.
+        bool Connect(const char* pHost, uint16_t port, CAS_ShardJob& job, uint32_t& shard);
+
+        bool ExchangeHalos(const CAS_ShardPlan& plan, uint32_t shard, const CAS_Image& slice) override;
+        CAS_Image GetOutput(const CAS_ShardPlan& plan, uint32_t shard) override;
+        bool SubmitOutput(const CAS_ShardPlan& plan, uint32_t shard, const CAS_Image& output) override;
+
+    private:
+        int                     m_socket;
+        std::vector<uint8_t>    m_output;
+    };
+
+    class CAS_ShardSocketServer
+    {
+    public:
+        CAS_ShardSocketServer();
+        ~CAS_ShardSocketServer();
+
+        // Port 0 picks a free one, GetPort() tells which.
+        bool Listen(const char* pBindAddress, uint16_t port);
+        uint16_t GetPort() const { return m_port; }
+        // Accepts a worker per shard, then sends the jobs, relays the halos and gathers the bands into frame.
+        bool Run(const CAS_ShardPlan& plan, const CAS_Image& frame, uint32_t timeoutMs);
+
+        const std::string& GetError() const { return m_error; }
+
+    private:
+        int                 m_listen;
+        uint16_t            m_port;
+        std::vector<int>    m_workers;
+        std::string         m_error;
+    };
+}
@@ -0,0 +1,790 @@
+//CAS Sample
+//
+// Copyright(c) 2019 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Band planning, the worker loop and the two transports of CAS_Shard (POSIX only).
+// Both transports move the same data: the few input rows at each band edge the neighbouring band's filter footprint
+// reaches into, and the filtered bands. Shared memory keeps them in one segment with a ready flag per shard, the socket
+// transport relays them through the coordinator in three phases (all halos in, all halos out, all bands in) so no
+// process ever blocks on a send while its peer blocks on one too.
+
+#include "CAS_Bench.h"
+#include "CAS_Shard.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <thread>
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace CAS_SAMPLE_CPU
+{
+    static const uint32_t s_ShardMagic = 0x44485343u;      // 'CSHD'
+    static const uint32_t s_MaxShards = 256;
+    static const uint32_t s_HaloTimeoutMs = 60000;
+
+    static_assert(ATOMIC_INT_LOCK_FREE == 2, "the shard flags are shared between processes and must be lock free");
+
+    static uint32_t CasShardPitch(const CAS_ShardJob& job, uint32_t width)
+    {
+        return width * CAS_Filter::GetFormatSize(static_cast<CAS_Format>(job.Format));
+    }
+
+    //==============================================================================================================
+    // Plan and worker
+    //==============================================================================================================
+    bool CAS_PlanShards(const CAS_ShardJob& job, CAS_ShardPlan& plan, std::string& error)
+    {
+        plan.Job = job;
+        plan.Bands.clear();
+        plan.MaxHalo = 0;
+
+        const CAS_State state = static_cast<CAS_State>(job.State);
+        if (state != CAS_State_SharpenOnly && state != CAS_State_Upsample)
+        {
+            error = "the job has no CAS mode";
+            return false;
+        }
+        if (job.Format >= CAS_Format_Count || job.InputWidth == 0 || job.InputHeight == 0 || job.OutputWidth == 0 || job.OutputHeight == 0)
+        {
+            error = "the job has an invalid format or size";
+            return false;
+        }
+        if (state == CAS_State_SharpenOnly && (job.OutputWidth != job.InputWidth || job.OutputHeight != job.InputHeight))
+        {
+            error = "sharpen only jobs need the output size to match the input";
+            return false;
+        }
+
+        // The bands only need the constants, no thread pool.
+        CAS_Filter filter;
+        filter.OnCreateWindowSizeDependentResources(job.InputWidth, job.InputHeight, job.OutputWidth, job.OutputHeight, state);
+        filter.UpdateSharpness(job.Sharpness, state);
+
+        // Output bands on the 8x8 block grid, input rows owned in proportion.
+        const uint32_t blocks = (job.OutputHeight + 7) / 8;
+        const uint32_t count = std::min(std::min(std::max(job.ShardCount, 1u), blocks), s_MaxShards);
+        plan.Job.ShardCount = count;
+        plan.Bands.resize(count);
+        for (uint32_t k = 0; k < count; ++k)
+        {
+            CAS_ShardBand& band = plan.Bands[k];
+            band.OutputY = blocks * k / count * 8;
+            band.OutputHeight = std::min(blocks * (k + 1) / count * 8, job.OutputHeight) - band.OutputY;
+            band.InputY = static_cast<uint32_t>(static_cast<uint64_t>(band.OutputY) * job.InputHeight / job.OutputHeight);
+        }
+        for (uint32_t k = 0; k < count; ++k)
+        {
+            CAS_ShardBand& band = plan.Bands[k];
+            const uint32_t inputEnd = (k + 1 < count) ? plan.Bands[k + 1].InputY : job.InputHeight;
+            band.InputHeight = inputEnd - band.InputY;
+
+            CAS_Rect region = { 0, band.OutputY, job.OutputWidth, band.OutputHeight };
+            CAS_Rect footprint = filter.GetInputRegion(region, state);
+            band.HaloTop = footprint.Y < band.InputY ? band.InputY - footprint.Y : 0;
+            band.HaloBottom = footprint.Y + footprint.Height > inputEnd ? footprint.Y + footprint.Height - inputEnd : 0;
+            plan.MaxHalo = std::max(plan.MaxHalo, std::max(band.HaloTop, band.HaloBottom));
+        }
+        for (uint32_t k = 0; k < count; ++k)
+        {
+            const CAS_ShardBand& band = plan.Bands[k];
+            if (band.InputHeight == 0 || (k > 0 && band.HaloTop > plan.Bands[k - 1].InputHeight) ||
+                (k + 1 < count && band.HaloBottom > plan.Bands[k + 1].InputHeight))
+            {
+                error = "too many shards for the frame height, the bands are thinner than the filter halo";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void CAS_FillShardInput(const CAS_ShardJob& job, uint32_t y0, const CAS_Image& image)
+    {
+        const CAS_Format format = static_cast<CAS_Format>(job.Format);
+        const uint32_t pixelSize = CAS_Filter::GetFormatSize(format);
+        for (uint32_t y = 0; y < image.Height; ++y)
+        {
+            const uint32_t frameY = y0 + y;
+            uint8_t* pRow = static_cast<uint8_t*>(image.pData) + static_cast<size_t>(y) * image.RowPitch;
+            for (uint32_t x = 0; x < image.Width; ++x)
+            {
+                uint32_t hash = (x * 0x9e3779b1u) ^ (frameY * 0x85ebca77u);
+                hash = (hash ^ (hash >> 15)) * 0x2c1b3c6du;
+                hash ^= hash >> 12;
+                float noise = static_cast<float>(hash >> 8) * (1.0f / 16777216.0f);
+                float gradient = static_cast<float>(x) / static_cast<float>(job.InputWidth);
+                float edge = (((x >> 5) ^ (frameY >> 5)) & 1) ? 0.8f : 0.2f;
+                float rgb[3] =
+                {
+                    0.5f * gradient + 0.4f * edge + 0.1f * noise,
+                    0.3f * gradient + 0.5f * edge + 0.2f * noise,
+                    0.6f * (1.0f - gradient) + 0.3f * edge + 0.1f * noise,
+                };
+                StorePixel(format, pRow + x * pixelSize, rgb);
+            }
+        }
+    }
+
+    bool CAS_RunShard(const CAS_ShardPlan& plan, uint32_t shard, CAS_ShardTransport& transport, std::string& error)
+    {
+        return CAS_RunShard(plan, shard, transport, [](const CAS_ShardJob& job, uint32_t y0, const CAS_Image& image)
+        {
+            CAS_FillShardInput(job, y0, image);
+            return true;
+        }, error);
+    }
+
+    bool CAS_RunShard(const CAS_ShardPlan& plan, uint32_t shard, CAS_ShardTransport& transport, const CAS_ShardInputFn& input, std::string& error)
+    {
+        const CAS_ShardJob& job = plan.Job;
+        const CAS_ShardBand& band = plan.Bands[shard];
+        const CAS_State state = static_cast<CAS_State>(job.State);
+        const uint32_t pitch = CasShardPitch(job, job.InputWidth);
+
+        // Own rows with room for the halos above and below.
+        std::vector<uint8_t> storage(static_cast<size_t>(band.HaloTop + band.InputHeight + band.HaloBottom) * pitch);
+        CAS_Image slice = { storage.data(), job.InputWidth, band.HaloTop + band.InputHeight + band.HaloBottom, pitch, static_cast<CAS_Format>(job.Format) };
+        CAS_Image own = slice;
+        own.pData = storage.data() + static_cast<size_t>(band.HaloTop) * pitch;
+        own.Height = band.InputHeight;
+        if (!input(job, band.InputY, own))
+        {
+            error = "no input for rows " + std::to_string(band.InputY) + " to " + std::to_string(band.InputY + band.InputHeight);
+            return false;
+        }
+
+        if (!transport.ExchangeHalos(plan, shard, slice))
+        {
+            error = transport.GetError();
+            return false;
+        }
+
+        // The frame constants stay those of the whole frame, UpscaleRegion() rebases the band by its integer origin.
+        CAS_Filter filter;
+        filter.OnCreate(job.ThreadsPerShard, static_cast<CAS_Tier>(job.Tier));
+        filter.SetVariant(job.Variant);
+        filter.SetPrecision(static_cast<CAS_Precision>(job.Precision));
+        filter.OnCreateWindowSizeDependentResources(job.InputWidth, job.InputHeight, job.OutputWidth, job.OutputHeight, state);
+        filter.UpdateSharpness(job.Sharpness, state);
+
+        const CAS_Image output = transport.GetOutput(plan, shard);
+        const CAS_Rect region = { 0, band.OutputY, job.OutputWidth, band.OutputHeight };
+        filter.UpscaleRegion(slice, 0, band.InputY - band.HaloTop, output, state, region);
+        filter.OnDestroy();
+
+        if (!transport.SubmitOutput(plan, shard, output))
+        {
+            error = transport.GetError();
+            return false;
+        }
+        return true;
+    }
+
+    //==============================================================================================================
+    // Shared memory
+    //==============================================================================================================
+    struct CasShardHeader
+    {
+        uint32_t                    Magic;
+        uint32_t                    MaxHalo;
+        uint64_t                    Size;
+        uint64_t                    HaloOffset;         // Two slots of MaxHalo rows per shard, top edge then bottom edge.
+        uint64_t                    FrameOffset;
+        CAS_ShardJob                Job;
+        std::atomic<uint32_t>       Failed;
+        std::atomic<uint32_t>       HaloReady[s_MaxShards];
+        std::atomic<uint32_t>       Done[s_MaxShards];
+    };
+
+    static size_t CasAlignPage(size_t size)
+    {
+        return (size + 4095) & ~static_cast<size_t>(4095);
+    }
+
+    // Waits for a flag another process sets, false on timeout or when any shard failed.
+    static bool CasWaitFlag(const std::atomic<uint32_t>& flag, const std::atomic<uint32_t>& failed, uint32_t timeoutMs)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+        for (uint32_t spin = 0; flag.load(std::memory_order_acquire) == 0; ++spin)
+        {
+            if (failed.load(std::memory_order_relaxed) != 0 || std::chrono::steady_clock::now() > deadline)
+            {
+                return false;
+            }
+            if (spin < 64)
+            {
+                std::this_thread::yield();
+            }
+            else
+            {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+        }
+        return true;
+    }
+
+    CAS_ShardSharedMemory::CAS_ShardSharedMemory()
+        : m_owner(false)
+        , m_pBase(nullptr)
+        , m_size(0)
+    {
+    }
+
+    CAS_ShardSharedMemory::~CAS_ShardSharedMemory()
+    {
+        if (m_pBase)
+        {
+            munmap(m_pBase, m_size);
+        }
+        if (m_owner)
+        {
+            shm_unlink(m_name.c_str());
+        }
+    }
+
+    bool CAS_ShardSharedMemory::Map(int fd, size_t size)
+    {
+        m_pBase = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (m_pBase == MAP_FAILED)
+        {
+            m_pBase = nullptr;
+            m_error = std::string("mmap failed: ") + strerror(errno);
+            return false;
+        }
+        m_size = size;
+        return true;
+    }
+
+    bool CAS_ShardSharedMemory::Create(const char* pName, const CAS_ShardPlan& plan)
+    {
+        const CAS_ShardJob& job = plan.Job;
+        const size_t haloSlot = static_cast<size_t>(plan.MaxHalo) * CasShardPitch(job, job.InputWidth);
+        const size_t haloOffset = CasAlignPage(sizeof(CasShardHeader));
+        const size_t frameOffset = CasAlignPage(haloOffset + haloSlot * 2 * job.ShardCount);
+        const size_t size = frameOffset + static_cast<size_t>(job.OutputHeight) * CasShardPitch(job, job.OutputWidth);
+
+        int fd = shm_open(pName, O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0)
+        {
+            m_error = std::string("shm_open failed: ") + strerror(errno);
+            return false;
+        }
+        m_name = pName;
+        m_owner = true;
+        if (ftruncate(fd, static_cast<off_t>(size)) != 0)
+        {
+            m_error = std::string("ftruncate failed: ") + strerror(errno);
+            close(fd);
+            return false;
+        }
+        if (!Map(fd, size))
+        {
+            return false;
+        }
+
+        // The pages start zeroed, the flags only need constructing.
+        CasShardHeader* pHeader = new (m_pBase) CasShardHeader();
+        pHeader->MaxHalo = plan.MaxHalo;
+        pHeader->Size = size;
+        pHeader->HaloOffset = haloOffset;
+        pHeader->FrameOffset = frameOffset;
+        pHeader->Job = job;
+        pHeader->Failed.store(0);
+        for (uint32_t k = 0; k < s_MaxShards; ++k)
+        {
+            pHeader->HaloReady[k].store(0);
+            pHeader->Done[k].store(0);
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+        pHeader->Magic = s_ShardMagic;
+        return true;
+    }
+
+    bool CAS_ShardSharedMemory::Open(const char* pName)
+    {
+        int fd = shm_open(pName, O_RDWR, 0600);
+        if (fd < 0)
+        {
+            m_error = std::string("shm_open failed: ") + strerror(errno);
+            return false;
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(CasShardHeader))
+        {
+            m_error = "the shared memory segment is too small";
+            close(fd);
+            return false;
+        }
+        if (!Map(fd, static_cast<size_t>(info.st_size)))
+        {
+            return false;
+        }
+        const CasShardHeader* pHeader = static_cast<const CasShardHeader*>(m_pBase);
+        if (pHeader->Magic != s_ShardMagic || pHeader->Size != m_size)
+        {
+            m_error = "the shared memory segment is not a CAS shard job";
+            return false;
+        }
+        m_name = pName;
+        return true;
+    }
+
+    const CAS_ShardJob& CAS_ShardSharedMemory::GetJob() const
+    {
+        return static_cast<const CasShardHeader*>(m_pBase)->Job;
+    }
+
+    void CAS_ShardSharedMemory::SetFailed()
+    {
+        if (m_pBase)
+        {
+            static_cast<CasShardHeader*>(m_pBase)->Failed.store(1, std::memory_order_release);
+        }
+    }
+
+    uint8_t* CAS_ShardSharedMemory::GetHalo(uint32_t shard, bool top) const
+    {
+        const CasShardHeader* pHeader = static_cast<const CasShardHeader*>(m_pBase);
+        const size_t slot = static_cast<size_t>(pHeader->MaxHalo) * CasShardPitch(pHeader->Job, pHeader->Job.InputWidth);
+        return static_cast<uint8_t*>(m_pBase) + pHeader->HaloOffset + slot * (shard * 2 + (top ? 0 : 1));
+    }
+
+    bool CAS_ShardSharedMemory::ExchangeHalos(const CAS_ShardPlan& plan, uint32_t shard, const CAS_Image& slice)
+    {
+        CasShardHeader* pHeader = static_cast<CasShardHeader*>(m_pBase);
+        const CAS_ShardBand& band = plan.Bands[shard];
+        const size_t pitch = slice.RowPitch;
+        uint8_t* pSlice = static_cast<uint8_t*>(slice.pData);
+        uint8_t* pOwn = pSlice + band.HaloTop * pitch;
+        uint8_t* pBelow = pOwn + static_cast<size_t>(band.InputHeight) * pitch;
+
+        // Publish the edges: the first rows for the band above, the last rows for the band below.
+        if (shard > 0)
+        {
+            memcpy(GetHalo(shard, true), pOwn, plan.Bands[shard - 1].HaloBottom * pitch);
+        }
+        if (shard + 1 < plan.Bands.size())
+        {
+            const uint32_t rows = plan.Bands[shard + 1].HaloTop;
+            memcpy(GetHalo(shard, false), pBelow - rows * pitch, rows * pitch);
+        }
+        pHeader->HaloReady[shard].store(1, std::memory_order_release);
+
+        if (band.HaloTop > 0)
+        {
+            if (!CasWaitFlag(pHeader->HaloReady[shard - 1], pHeader->Failed, s_HaloTimeoutMs))
+            {
+                m_error = "no halo from the shard above";
+                return false;
+            }
+            memcpy(pSlice, GetHalo(shard - 1, false), band.HaloTop * pitch);
+        }
+        if (band.HaloBottom > 0)
+        {
+            if (!CasWaitFlag(pHeader->HaloReady[shard + 1], pHeader->Failed, s_HaloTimeoutMs))
+            {
+                m_error = "no halo from the shard below";
+                return false;
+            }
+            memcpy(pBelow, GetHalo(shard + 1, true), band.HaloBottom * pitch);
+        }
+        return true;
+    }
+
+    CAS_Image CAS_ShardSharedMemory::GetFrame() const
+    {
+        const CasShardHeader* pHeader = static_cast<const CasShardHeader*>(m_pBase);
+        const CAS_ShardJob& job = pHeader->Job;
+        CAS_Image frame = { static_cast<uint8_t*>(m_pBase) + pHeader->FrameOffset, job.OutputWidth, job.OutputHeight,
+            CasShardPitch(job, job.OutputWidth), static_cast<CAS_Format>(job.Format) };
+        return frame;
+    }
+
+    CAS_Image CAS_ShardSharedMemory::GetOutput(const CAS_ShardPlan& plan, uint32_t shard)
+    {
+        CAS_Image output = GetFrame();
+        output.pData = static_cast<uint8_t*>(output.pData) + static_cast<size_t>(plan.Bands[shard].OutputY) * output.RowPitch;
+        output.Height = plan.Bands[shard].OutputHeight;
+        return output;
+    }
+
+    bool CAS_ShardSharedMemory::SubmitOutput(const CAS_ShardPlan&, uint32_t shard, const CAS_Image&)
+    {
+        // The band is already in the frame.
+        static_cast<CasShardHeader*>(m_pBase)->Done[shard].store(1, std::memory_order_release);
+        return true;
+    }
+
+    bool CAS_ShardSharedMemory::WaitForShards(uint32_t timeoutMs, const std::function<bool()>& alive)
+    {
+        const CasShardHeader* pHeader = static_cast<const CasShardHeader*>(m_pBase);
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+        for (;;)
+        {
+            uint32_t done = 0;
+            for (uint32_t k = 0; k < pHeader->Job.ShardCount; ++k)
+            {
+                done += pHeader->Done[k].load(std::memory_order_acquire);
+            }
+            if (done == pHeader->Job.ShardCount)
+            {
+                return true;
+            }
+            if (pHeader->Failed.load() != 0 || !alive())
+            {
+                m_error = "a shard failed";
+                return false;
+            }
+            if (std::chrono::steady_clock::now() > deadline)
+            {
+                m_error = "timed out waiting for the shards";
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    //==============================================================================================================
+    // Sockets
+    //==============================================================================================================
+    // Messages are a header and Size bytes of payload, in host byte order: the hosts of a render farm share one.
+    enum CasShardMessageType
+    {
+        CasShardMessage_Job = 1,
+        CasShardMessage_HaloUp,         // Worker's first rows, for the shard above.
+        CasShardMessage_HaloDown,       // Worker's last rows, for the shard below.
+        CasShardMessage_HaloTop,        // Rows above the worker's band.
+        CasShardMessage_HaloBottom,     // Rows below the worker's band.
+        CasShardMessage_Output,
+    };
+
+    struct CasShardMessage
+    {
+        uint32_t    Type;
+        uint32_t    Shard;
+        uint64_t    Size;
+    };
+
+    static bool CasSendAll(int fd, const void* pData, size_t size)
+    {
+        const uint8_t* p = static_cast<const uint8_t*>(pData);
+        while (size > 0)
+        {
+#if defined(MSG_NOSIGNAL)
+            ssize_t sent = send(fd, p, size, MSG_NOSIGNAL);
+#else
+            ssize_t sent = send(fd, p, size, 0);
+#endif
+            if (sent < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (sent <= 0)
+            {
+                return false;
+            }
+            p += sent;
+            size -= static_cast<size_t>(sent);
+        }
+        return true;
+    }
+
+    static bool CasReceiveAll(int fd, void* pData, size_t size)
+    {
+        uint8_t* p = static_cast<uint8_t*>(pData);
+        while (size > 0)
+        {
+            ssize_t received = recv(fd, p, size, 0);
+            if (received < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (received <= 0)
+            {
+                return false;
+            }
+            p += received;
+            size -= static_cast<size_t>(received);
+        }
+        return true;
+    }
+
+    static bool CasSendMessage(int fd, uint32_t type, uint32_t shard, const void* pPayload, size_t size)
+    {
+        CasShardMessage message = { type, shard, size };
+        return CasSendAll(fd, &message, sizeof(message)) && CasSendAll(fd, pPayload, size);
+    }
+
+    // Receives a message of the expected type, its payload into data.
+    static bool CasReceiveMessage(int fd, uint32_t type, std::vector<uint8_t>& data, CasShardMessage& message)
+    {
+        if (!CasReceiveAll(fd, &message, sizeof(message)) || message.Type != type)
+        {
+            return false;
+        }
+        data.resize(static_cast<size_t>(message.Size));
+        return CasReceiveAll(fd, data.data(), data.size());
+    }
+
+    static void CasSetNoDelay(int fd)
+    {
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+
+    CAS_ShardSocket::CAS_ShardSocket()
+        : m_socket(-1)
+    {
+    }
+
+    CAS_ShardSocket::~CAS_ShardSocket()
+    {
+        if (m_socket >= 0)
+        {
+            close(m_socket);
+        }
+    }
+
+    bool CAS_ShardSocket::Connect(const char* pHost, uint16_t port, CAS_ShardJob& job, uint32_t& shard)
+    {
+        addrinfo hints = {};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* pList = nullptr;
+        const std::string service = std::to_string(port);
+        if (getaddrinfo(pHost, service.c_str(), &hints, &pList) != 0)
+        {
+            m_error = std::string("cannot resolve ") + pHost;
+            return false;
+        }
+        for (addrinfo* pAddress = pList; pAddress && m_socket < 0; pAddress = pAddress->ai_next)
+        {
+            m_socket = socket(pAddress->ai_family, pAddress->ai_socktype, pAddress->ai_protocol);
+            if (m_socket >= 0 && connect(m_socket, pAddress->ai_addr, pAddress->ai_addrlen) != 0)
+            {
+                close(m_socket);
+                m_socket = -1;
+            }
+        }
+        freeaddrinfo(pList);
+        if (m_socket < 0)
+        {
+            m_error = std::string("cannot connect to ") + pHost + ":" + service;
+            return false;
+        }
+        CasSetNoDelay(m_socket);
+
+        std::vector<uint8_t> payload;
+        CasShardMessage message;
+        if (!CasReceiveMessage(m_socket, CasShardMessage_Job, payload, message) || payload.size() != sizeof(CAS_ShardJob))
+        {
+            m_error = "no job from the coordinator";
+            return false;
+        }
+        memcpy(&job, payload.data(), sizeof(job));
+        shard = message.Shard;
+        return true;
+    }
+
+    bool CAS_ShardSocket::ExchangeHalos(const CAS_ShardPlan& plan, uint32_t shard, const CAS_Image& slice)
+    {
+        const CAS_ShardBand& band = plan.Bands[shard];
+        const size_t pitch = slice.RowPitch;
+        uint8_t* pSlice = static_cast<uint8_t*>(slice.pData);
+        uint8_t* pOwn = pSlice + band.HaloTop * pitch;
+        uint8_t* pBelow = pOwn + static_cast<size_t>(band.InputHeight) * pitch;
+
+        const size_t upRows = shard > 0 ? plan.Bands[shard - 1].HaloBottom : 0;
+        const size_t downRows = shard + 1 < plan.Bands.size() ? plan.Bands[shard + 1].HaloTop : 0;
+        if (!CasSendMessage(m_socket, CasShardMessage_HaloUp, shard, pOwn, upRows * pitch) ||
+            !CasSendMessage(m_socket, CasShardMessage_HaloDown, shard, pBelow - downRows * pitch, downRows * pitch))
+        {
+            m_error = "lost the coordinator while sending halos";
+            return false;
+        }
+
+        std::vector<uint8_t> rows;
+        CasShardMessage message;
+        if (!CasReceiveMessage(m_socket, CasShardMessage_HaloTop, rows, message) || rows.size() != band.HaloTop * pitch)
+        {
+            m_error = "bad halo from the shard above";
+            return false;
+        }
+        memcpy(pSlice, rows.data(), rows.size());
+        if (!CasReceiveMessage(m_socket, CasShardMessage_HaloBottom, rows, message) || rows.size() != band.HaloBottom * pitch)
+        {
+            m_error = "bad halo from the shard below";
+            return false;
+        }
+        memcpy(pBelow, rows.data(), rows.size());
+        return true;
+    }
+
+    CAS_Image CAS_ShardSocket::GetOutput(const CAS_ShardPlan& plan, uint32_t shard)
+    {
+        const CAS_ShardJob& job = plan.Job;
+        const uint32_t pitch = CasShardPitch(job, job.OutputWidth);
+        m_output.resize(static_cast<size_t>(plan.Bands[shard].OutputHeight) * pitch);
+        CAS_Image output = { m_output.data(), job.OutputWidth, plan.Bands[shard].OutputHeight, pitch, static_cast<CAS_Format>(job.Format) };
+        return output;
+    }
+
+    bool CAS_ShardSocket::SubmitOutput(const CAS_ShardPlan&, uint32_t shard, const CAS_Image& output)
+    {
+        if (!CasSendMessage(m_socket, CasShardMessage_Output, shard, output.pData, static_cast<size_t>(output.Height) * output.RowPitch))
+        {
+            m_error = "lost the coordinator while sending the band";
+            return false;
+        }
+        return true;
+    }
+
+    CAS_ShardSocketServer::CAS_ShardSocketServer()
+        : m_listen(-1)
+        , m_port(0)
+    {
+    }
+
+    CAS_ShardSocketServer::~CAS_ShardSocketServer()
+    {
+        for (int fd : m_workers)
+        {
+            close(fd);
+        }
+        if (m_listen >= 0)
+        {
+            close(m_listen);
+        }
+    }
+
+    bool CAS_ShardSocketServer::Listen(const char* pBindAddress, uint16_t port)
+    {
+        addrinfo hints = {};
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags = AI_PASSIVE;
+        addrinfo* pList = nullptr;
+        const std::string service = std::to_string(port);
+        if (getaddrinfo(pBindAddress, service.c_str(), &hints, &pList) != 0 || !pList)
+        {
+            m_error = std::string("cannot resolve ") + (pBindAddress ? pBindAddress : "any");
+            return false;
+        }
+        m_listen = socket(pList->ai_family, pList->ai_socktype, pList->ai_protocol);
+        int one = 1;
+        const bool bound = m_listen >= 0 && setsockopt(m_listen, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) == 0 &&
+            bind(m_listen, pList->ai_addr, pList->ai_addrlen) == 0 && listen(m_listen, static_cast<int>(s_MaxShards)) == 0;
+        freeaddrinfo(pList);
+        if (!bound)
+        {
+            m_error = std::string("cannot listen: ") + strerror(errno);
+            return false;
+        }
+
+        sockaddr_in address = {};
+        socklen_t length = sizeof(address);
+        getsockname(m_listen, reinterpret_cast<sockaddr*>(&address), &length);
+        m_port = ntohs(address.sin_port);
+        return true;
+    }
+
+    bool CAS_ShardSocketServer::Run(const CAS_ShardPlan& plan, const CAS_Image& frame, uint32_t timeoutMs)
+    {
+        const uint32_t count = plan.Job.ShardCount;
+
+        // One connection per shard, numbered in the order they arrive.
+        while (m_workers.size() < count)
+        {
+            pollfd entry = { m_listen, POLLIN, 0 };
+            if (poll(&entry, 1, static_cast<int>(timeoutMs)) <= 0)
+            {
+                m_error = "timed out waiting for workers to connect";
+                return false;
+            }
+            int fd = accept(m_listen, nullptr, nullptr);
+            if (fd < 0)
+            {
+                continue;
+            }
+            CasSetNoDelay(fd);
+            timeval timeout = { static_cast<time_t>(timeoutMs / 1000), static_cast<suseconds_t>((timeoutMs % 1000) * 1000) };
+            setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+            m_workers.push_back(fd);
+        }
+        for (uint32_t k = 0; k < count; ++k)
+        {
+            if (!CasSendMessage(m_workers[k], CasShardMessage_Job, k, &plan.Job, sizeof(plan.Job)))
+            {
+                m_error = "lost a worker while sending the job";
+                return false;
+            }
+        }
+
+        // Every worker sends its edges before it waits for anything, so gather all of them first.
+        std::vector<std::vector<uint8_t>> up(count), down(count);
+        CasShardMessage message;
+        for (uint32_t k = 0; k < count; ++k)
+        {
+            if (!CasReceiveMessage(m_workers[k], CasShardMessage_HaloUp, up[k], message) ||
+                !CasReceiveMessage(m_workers[k], CasShardMessage_HaloDown, down[k], message))
+            {
+                m_error = "lost a worker while receiving halos";
+                return false;
+            }
+        }
+        const std::vector<uint8_t> none;
+        for (uint32_t k = 0; k < count; ++k)
+        {
+            const std::vector<uint8_t>& top = k > 0 ? down[k - 1] : none;
+            const std::vector<uint8_t>& bottom = k + 1 < count ? up[k + 1] : none;
+            if (!CasSendMessage(m_workers[k], CasShardMessage_HaloTop, k, top.data(), top.size()) ||
+                !CasSendMessage(m_workers[k], CasShardMessage_HaloBottom, k, bottom.data(), bottom.size()))
+            {
+                m_error = "lost a worker while sending halos";
+                return false;
+            }
+        }
+
+        // Bands straight into the frame.
+        for (uint32_t k = 0; k < count; ++k)
+        {
+            const CAS_ShardBand& band = plan.Bands[k];
+            const size_t size = static_cast<size_t>(band.OutputHeight) * frame.RowPitch;
+            if (!CasReceiveAll(m_workers[k], &message, sizeof(message)) || message.Type != CasShardMessage_Output || message.Size != size ||
+                !CasReceiveAll(m_workers[k], static_cast<uint8_t*>(frame.pData) + static_cast<size_t>(band.OutputY) * frame.RowPitch, size))
+            {
+                m_error = "lost a worker while receiving its band";
+                return false;
+            }
+        }
+        return true;
+    }
+}
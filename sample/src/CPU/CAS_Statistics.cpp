@@ -0,0 +1,152 @@
+//CAS Sample
+//
+// Copyright(c) 2019 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Luminance statistics of the output, gathered by the tiles as they store it so the frame is not read again. Every work
+// item of a run accumulates its own partial (a tile, or a group of tiles for a fused cascade) and the partials are
+// merged in work item order afterwards, so the results do not depend on how the items were spread over the threads.
+// The histogram bin of a pixel comes from a table indexed by the top bits of its luminance's float representation, 128
+// buckets per octave, with one compare against the edge of the next bin since the bins are wider than the buckets.
+
+#include "CAS_CPU.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace CAS_SAMPLE_CPU
+{
+    static inline float CasAsFloat(uint32_t u)
+    {
+        float f;
+        memcpy(&f, &u, sizeof(f));
+        return f;
+    }
+
+    static inline uint32_t CasAsUint(float f)
+    {
+        uint32_t u;
+        memcpy(&u, &f, sizeof(u));
+        return u;
+    }
+
+    void CAS_Filter::SetStatistics(bool enable, float minLog2, float maxLog2)
+    {
+        m_statisticsEnabled = enable;
+
+        // Within the normal float range, and at least 1 apart so no bucket holds more than one bin edge.
+        minLog2 = std::min(std::max(minLog2, -120.0f), 119.0f);
+        maxLog2 = std::min(std::max(maxLog2, minLog2 + 1.0f), 120.0f);
+        m_statistics = {};
+        m_statistics.MinLog2 = minLog2;
+        m_statistics.MaxLog2 = maxLog2;
+
+        const uint32_t binCount = CAS_Statistics::BinCount;
+        for (uint32_t edge = 0; edge <= binCount; ++edge)
+        {
+            const double value = std::exp2(minLog2 + (static_cast<double>(maxLog2) - minLog2) * edge / binCount);
+            m_histogramEdges[edge] = static_cast<float>(value);
+            if (static_cast<double>(m_histogramEdges[edge]) < value)
+            {
+                m_histogramEdges[edge] = std::nextafter(m_histogramEdges[edge], std::numeric_limits<float>::max());
+            }
+        }
+
+        m_histogramBase = CasAsUint(m_histogramEdges[0]) >> 16;
+        m_histogramBuckets.resize((CasAsUint(m_histogramEdges[binCount]) >> 16) - m_histogramBase + 1);
+        uint32_t bin = 0;
+        for (uint32_t bucket = 0; bucket < m_histogramBuckets.size(); ++bucket)
+        {
+            const float start = CasAsFloat((m_histogramBase + bucket) << 16);
+            while (bin + 1 < binCount && m_histogramEdges[bin + 1] <= start)
+            {
+                ++bin;
+            }
+            m_histogramBuckets[bucket] = static_cast<uint8_t>(bin);
+        }
+    }
+
+    void CAS_Filter::MeasureRow(TileStatistics& statistics, const float* pR, const float* pG, const float* pB, uint32_t count) const
+    {
+        // Luminance is clamped into the histogram range, the top just below the last edge so it lands in the last bin.
+        const float bottom = m_histogramEdges[0];
+        const float top = std::nextafter(m_histogramEdges[CAS_Statistics::BinCount], 0.0f);
+        const uint8_t* pBuckets = m_histogramBuckets.data();
+        float minimum = statistics.Min;
+        float maximum = statistics.Max;
+        float sum = 0.0f;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const float luma = 0.2126f * pR[i] + 0.7152f * pG[i] + 0.0722f * pB[i];
+            minimum = std::min(minimum, luma);
+            maximum = std::max(maximum, luma);
+            sum += luma;
+
+            const float x = std::min(top, std::max(bottom, luma));
+            uint32_t bin = pBuckets[(CasAsUint(x) >> 16) - m_histogramBase];
+            bin += (x >= m_histogramEdges[bin + 1]) ? 1 : 0;
+            ++statistics.Histogram[bin];
+        }
+        statistics.Min = minimum;
+        statistics.Max = maximum;
+        statistics.Sum += sum;
+    }
+
+    CAS_Filter::TileStatistics* CAS_Filter::BeginStatistics(uint32_t itemCount)
+    {
+        if (!m_statisticsEnabled)
+        {
+            return nullptr;
+        }
+
+        TileStatistics empty = {};
+        empty.Min = std::numeric_limits<float>::max();
+        empty.Max = std::numeric_limits<float>::lowest();
+        m_tileStatistics.assign(itemCount, empty);
+        return m_tileStatistics.data();
+    }
+
+    void CAS_Filter::EndStatistics()
+    {
+        CAS_Statistics& statistics = m_statistics;
+        memset(statistics.Histogram, 0, sizeof(statistics.Histogram));
+        statistics.Min = std::numeric_limits<float>::max();
+        statistics.Max = std::numeric_limits<float>::lowest();
+        statistics.Count = 0;
+        double sum = 0.0;
+        for (const TileStatistics& tile : m_tileStatistics)
+        {
+            statistics.Min = std::min(statistics.Min, tile.Min);
+            statistics.Max = std::max(statistics.Max, tile.Max);
+            sum += tile.Sum;
+            for (uint32_t bin = 0; bin < CAS_Statistics::BinCount; ++bin)
+            {
+                statistics.Histogram[bin] += tile.Histogram[bin];
+                statistics.Count += tile.Histogram[bin];
+            }
+        }
+
+        if (statistics.Count == 0)
+        {
+            statistics.Min = statistics.Max = statistics.Mean = 0.0f;
+            return;
+        }
+        statistics.Mean = static_cast<float>(sum / static_cast<double>(statistics.Count));
+    }
+}
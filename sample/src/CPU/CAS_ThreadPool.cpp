@@ -0,0 +1,179 @@
+//CAS Sample
+//
+// Copyright(c) 2019 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "CAS_ThreadPool.h"
+
+#include <cstdio>
+#include <set>
+#include <utility>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+namespace CAS_SAMPLE_CPU
+{
+    void CAS_ThreadPool::OnCreate(uint32_t threadCount)
+    {
+        m_quit = false;
+        m_generation = 0;
+        m_busyWorkers = 0;
+        m_nextItem = 0;
+
+        for (uint32_t i = 1; i < threadCount; ++i)
+        {
+            m_workers.emplace_back(&CAS_ThreadPool::WorkerMain, this, i);
+        }
+    }
+
+    void CAS_ThreadPool::OnDestroy()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_quit = true;
+        }
+        m_startCondition.notify_all();
+
+        for (std::thread& worker : m_workers)
+        {
+            worker.join();
+        }
+        m_workers.clear();
+    }
+
+    void CAS_ThreadPool::Run(uint32_t itemCount, const Job& job)
+    {
+        if (m_workers.empty() || itemCount <= 1)
+        {
+            for (uint32_t i = 0; i < itemCount; ++i)
+            {
+                job(i, 0);
+            }
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_pJob = &job;
+            m_itemCount = itemCount;
+            m_nextItem = 0;
+            m_busyWorkers = static_cast<uint32_t>(m_workers.size());
+            ++m_generation;
+        }
+        m_startCondition.notify_all();
+
+        ExecuteItems(0);
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_doneCondition.wait(lock, [this] { return m_busyWorkers == 0; });
+        m_pJob = nullptr;
+    }
+
+    void CAS_ThreadPool::WorkerMain(uint32_t threadIndex)
+    {
+        uint64_t seenGeneration = 0;
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_startCondition.wait(lock, [&] { return m_quit || m_generation != seenGeneration; });
+                if (m_quit)
+                {
+                    return;
+                }
+                seenGeneration = m_generation;
+            }
+
+            ExecuteItems(threadIndex);
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                --m_busyWorkers;
+            }
+            m_doneCondition.notify_one();
+        }
+    }
+
+    void CAS_ThreadPool::ExecuteItems(uint32_t threadIndex)
+    {
+        const Job& job = *m_pJob;
+        for (;;)
+        {
+            uint32_t item = m_nextItem.fetch_add(1, std::memory_order_relaxed);
+            if (item >= m_itemCount)
+            {
+                break;
+            }
+            job(item, threadIndex);
+        }
+    }
+
+    uint32_t CAS_ThreadPool::GetHardwareThreadCount()
+    {
+        uint32_t count = std::thread::hardware_concurrency();
+        return count ? count : 1;
+    }
+
+    uint32_t CAS_ThreadPool::GetPhysicalCoreCount()
+    {
+        const uint32_t hardwareThreads = GetHardwareThreadCount();
+        uint32_t cores = 0;
+#if defined(_WIN32)
+        DWORD size = 0;
+        GetLogicalProcessorInformation(nullptr, &size);
+        std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> info(size / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
+        if (!info.empty() && GetLogicalProcessorInformation(info.data(), &size))
+        {
+            for (const SYSTEM_LOGICAL_PROCESSOR_INFORMATION& entry : info)
+            {
+                cores += (entry.Relationship == RelationProcessorCore) ? 1 : 0;
+            }
+        }
+#elif defined(__linux__)
+        // Distinct (package, core) pairs of the logical CPUs.
+        std::set<std::pair<int, int>> seen;
+        for (uint32_t cpu = 0; cpu < hardwareThreads; ++cpu)
+        {
+            int ids[2] = { -1, -1 };
+            const char* pFiles[2] = { "physical_package_id", "core_id" };
+            for (int i = 0; i < 2; ++i)
+            {
+                char path[128];
+                snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/topology/%s", cpu, pFiles[i]);
+                if (FILE* pFile = fopen(path, "r"))
+                {
+                    if (fscanf(pFile, "%d", &ids[i]) != 1)
+                    {
+                        ids[i] = -1;
+                    }
+                    fclose(pFile);
+                }
+            }
+            if (ids[1] < 0)
+            {
+                return hardwareThreads;
+            }
+            seen.insert(std::make_pair(ids[0], ids[1]));
+        }
+        cores = static_cast<uint32_t>(seen.size());
+#endif
+        return (cores == 0 || cores > hardwareThreads) ? hardwareThreads : cores;
+    }
+}
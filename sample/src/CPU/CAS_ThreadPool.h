@@ -0,0 +1,72 @@
+//CAS Sample
+//
+// Copyright(c) 2019 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace CAS_SAMPLE_CPU
+{
+    //
+    // Persistent worker threads used by the CPU filter to run tiles in parallel.
+    // The calling thread takes part in every Run() so a pool of 1 has no worker threads at all.
+    //
+    class CAS_ThreadPool
+    {
+    public:
+        // Job signature: (work item index, index of the thread running it in [0, GetThreadCount())).
+        typedef std::function<void(uint32_t, uint32_t)> Job;
+
+        void OnCreate(uint32_t threadCount);
+        void OnDestroy();
+
+        uint32_t GetThreadCount() const { return static_cast<uint32_t>(m_workers.size()) + 1; }
+
+        // Runs job for every index in [0, itemCount) and returns once all of them are done.
+        void Run(uint32_t itemCount, const Job& job);
+
+        static uint32_t GetHardwareThreadCount();
+        // Cores without counting SMT siblings (hyperthreads), the hardware thread count when the topology is unknown.
+        static uint32_t GetPhysicalCoreCount();
+
+    private:
+        void WorkerMain(uint32_t threadIndex);
+        void ExecuteItems(uint32_t threadIndex);
+
+        std::vector<std::thread>        m_workers;
+
+        std::mutex                      m_mutex;
+        std::condition_variable         m_startCondition;
+        std::condition_variable         m_doneCondition;
+
+        const Job                      *m_pJob = nullptr;
+        uint32_t                        m_itemCount = 0;
+        uint64_t                        m_generation = 0;
+        uint32_t                        m_busyWorkers = 0;
+        bool                            m_quit = false;
+
+        std::atomic<uint32_t>           m_nextItem;
+    };
+}
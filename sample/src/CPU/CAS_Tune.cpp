@@ -0,0 +1,433 @@
+//CAS Sample
+//
+// Copyright(c) 2019 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Quality/cost autotuner for the CPU CAS filter.
+// Every supported tier, CAS_* variant and source precision runs over a corpus of images (PPM/PFM files, or a generated
+// test image when none are given). Quality is measured as PSNR or SSIM against the double precision reference
+// (CAS_Reference) of the variant's algorithm, or against user supplied target images. The fastest candidate whose worst
+// quality over the corpus meets the threshold is written to a profile that CAS_Filter::LoadProfile() applies.
+// With --schedule-cache the tile size, thread count and traversal order are then tuned for this host at every corpus
+// resolution with the selected profile, and stored in the cache CAS_Filter::LoadSchedule() reads.
+
+#include "CAS_Bench.h"
+#include "CAS_ImageFile.h"
+#include "CAS_Profile.h"
+#include "CAS_Quality.h"
+#include "CAS_Reference.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace CAS_SAMPLE_CPU;
+
+struct TuneOptions
+{
+    std::vector<const char*>    Corpus;
+    std::vector<const char*>    Targets;
+    std::vector<CAS_Tier>       Tiers;
+    bool                        SharpenOnly = true;
+    float                       Scale = 1.5f;
+    float                       Sharpness = 0.5f;
+    bool                        Ssim = false;
+    double                      Threshold = -1.0;       // Negative picks the metric's default.
+    CAS_Format                  Format = CAS_Format_RGBA16F;
+    uint32_t                    Threads = 1;
+    uint32_t                    Repeat = 7;
+    const char                 *pProfilePath = "cas_profile.txt";
+    const char                 *pScheduleCachePath = nullptr;
+};
+
+struct CorpusItem
+{
+    std::string                 Name;
+    std::vector<uint8_t>        InputStorage;
+    CAS_Image                   Input;
+    std::vector<uint8_t>        OutputStorage;
+    CAS_Image                   Output;
+    // One per algorithm (CAS_BETTER_DIAGONALS and CAS_SLOW bits), or a single user supplied target.
+    CAS_ReferenceImage          References[CAS_Variant_Count];
+    bool                        HasTarget;
+};
+
+struct Candidate
+{
+    CAS_Tier                    Tier;
+    uint32_t                    Variant;
+    CAS_Precision               Precision;
+    double                      NsPerPixel;
+    double                      Quality;    // Worst over the corpus.
+};
+
+static void PrintUsage()
+{
+    printf("Usage: CAS_Tune [options]\n"
+           "  --corpus <file>                   Input image, PPM (P6, sRGB) or PFM (linear), repeat for more (default: generated)\n"
+           "  --target <file>                   Target for the matching --corpus image instead of the double reference\n"
+           "  --mode <sharpen|upsample>         Filter mode (default sharpen)\n"
+           "  --scale <s>                       Output size over input size for upsample (default 1.5)\n"
+           "  --sharpness <s>                   Sharpness in [0, 1] (default 0.5)\n"
+           "  --metric <psnr|ssim>              Quality metric (default psnr)\n"
+           "  --threshold <q>                   Minimum quality (default 45 dB for psnr, 0.995 for ssim)\n"
+           "  --tier <scalar|sse2|avx2|all>     Tiers to consider (default all supported)\n"
+           "  --format <rgba32f|rgba16f|rgba8>  Input and output format (default rgba16f)\n"
+           "  --threads <n>                     Worker threads, 0 = all hardware threads (default 1)\n"
+           "  --repeat <n>                      Timed runs per image, the median is used (default 7)\n"
+           "  --profile <file>                  Profile to write (default cas_profile.txt)\n"
+           "  --schedule-cache <file>           Also tune tile size, threads and traversal and add them to this cache\n");
+}
+
+static bool ParseOptions(int argc, char** argv, TuneOptions& options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const char* pArg = argv[i];
+        const char* pValue = (i + 1 < argc) ? argv[++i] : nullptr;
+        if (!pValue)
+        {
+            return false;
+        }
+        if (strcmp(pArg, "--corpus") == 0)
+        {
+            options.Corpus.push_back(pValue);
+        }
+        else if (strcmp(pArg, "--target") == 0)
+        {
+            options.Targets.push_back(pValue);
+        }
+        else if (strcmp(pArg, "--mode") == 0)
+        {
+            options.SharpenOnly = strcmp(pValue, "upsample") != 0;
+        }
+        else if (strcmp(pArg, "--scale") == 0)
+        {
+            options.Scale = static_cast<float>(atof(pValue));
+        }
+        else if (strcmp(pArg, "--sharpness") == 0)
+        {
+            options.Sharpness = static_cast<float>(atof(pValue));
+        }
+        else if (strcmp(pArg, "--metric") == 0)
+        {
+            options.Ssim = strcmp(pValue, "ssim") == 0;
+        }
+        else if (strcmp(pArg, "--threshold") == 0)
+        {
+            options.Threshold = atof(pValue);
+        }
+        else if (strcmp(pArg, "--tier") == 0)
+        {
+            for (int tier = 0; tier < CAS_Tier_Count; ++tier)
+            {
+                std::string name = CAS_Filter::GetTierName(static_cast<CAS_Tier>(tier));
+                std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+                if (name == pValue || strcmp(pValue, "all") == 0)
+                {
+                    options.Tiers.push_back(static_cast<CAS_Tier>(tier));
+                }
+            }
+        }
+        else if (strcmp(pArg, "--format") == 0)
+        {
+            options.Format = strcmp(pValue, "rgba32f") == 0 ? CAS_Format_RGBA32F : strcmp(pValue, "rgba8") == 0 ? CAS_Format_RGBA8 : CAS_Format_RGBA16F;
+        }
+        else if (strcmp(pArg, "--threads") == 0)
+        {
+            options.Threads = static_cast<uint32_t>(atoi(pValue));
+        }
+        else if (strcmp(pArg, "--repeat") == 0)
+        {
+            options.Repeat = std::max(1, atoi(pValue));
+        }
+        else if (strcmp(pArg, "--profile") == 0)
+        {
+            options.pProfilePath = pValue;
+        }
+        else if (strcmp(pArg, "--schedule-cache") == 0)
+        {
+            options.pScheduleCachePath = pValue;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    if (!options.Targets.empty() && options.Targets.size() != options.Corpus.size())
+    {
+        printf("--target must be given once for every --corpus image\n");
+        return false;
+    }
+    if (options.Tiers.empty())
+    {
+        options.Tiers = { CAS_Tier_Scalar, CAS_Tier_SSE2, CAS_Tier_AVX2 };
+    }
+    if (options.Threshold < 0.0)
+    {
+        options.Threshold = options.Ssim ? 0.995 : 45.0;
+    }
+    return true;
+}
+
+static bool LoadCorpus(const TuneOptions& options, std::vector<CorpusItem>& corpus)
+{
+    const size_t count = std::max<size_t>(options.Corpus.size(), 1);
+    corpus.resize(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        CorpusItem& item = corpus[i];
+        std::vector<uint8_t> fileStorage;
+        CAS_Image file = {};
+        if (options.Corpus.empty())
+        {
+            item.Name = "generated 1280x720";
+            FillTestImage(fileStorage, file, 1280, 720, CAS_Format_RGBA32F);
+        }
+        else
+        {
+            std::string error;
+            item.Name = options.Corpus[i];
+            if (!CAS_ImageFile::Load(options.Corpus[i], fileStorage, file, error))
+            {
+                printf("%s\n", error.c_str());
+                return false;
+            }
+        }
+        ConvertImage(file, item.InputStorage, item.Input, options.Format);
+
+        uint32_t outputWidth = item.Input.Width;
+        uint32_t outputHeight = item.Input.Height;
+        item.HasTarget = !options.Targets.empty();
+        if (item.HasTarget)
+        {
+            std::vector<uint8_t> targetStorage;
+            CAS_Image target = {};
+            std::string error;
+            if (!CAS_ImageFile::Load(options.Targets[i], targetStorage, target, error))
+            {
+                printf("%s\n", error.c_str());
+                return false;
+            }
+            outputWidth = target.Width;
+            outputHeight = target.Height;
+            if (options.SharpenOnly && (outputWidth != item.Input.Width || outputHeight != item.Input.Height))
+            {
+                printf("%s: sharpen only needs a target the size of the input\n", options.Targets[i]);
+                return false;
+            }
+            CAS_Reference::FromImage(target, item.References[0]);
+        }
+        else if (!options.SharpenOnly)
+        {
+            outputWidth = static_cast<uint32_t>(item.Input.Width * options.Scale + 0.5f);
+            outputHeight = static_cast<uint32_t>(item.Input.Height * options.Scale + 0.5f);
+        }
+        FillTestImage(item.OutputStorage, item.Output, outputWidth, outputHeight, options.Format);
+    }
+    return true;
+}
+
+static const CAS_ReferenceImage& GetReference(const TuneOptions& options, CorpusItem& item, uint32_t variant)
+{
+    if (item.HasTarget)
+    {
+        return item.References[0];
+    }
+    const uint32_t algorithm = variant & (CAS_Variant_BetterDiagonals | CAS_Variant_Slow);
+    CAS_ReferenceImage& reference = item.References[algorithm];
+    if (reference.Data.empty())
+    {
+        CAS_Reference::Filter(item.Input, item.Output.Width, item.Output.Height, options.SharpenOnly, options.Sharpness, algorithm, reference);
+    }
+    return reference;
+}
+
+static Candidate RunCandidate(const TuneOptions& options, std::vector<CorpusItem>& corpus, CAS_Tier tier, uint32_t variant, CAS_Precision precision)
+{
+    Candidate candidate = { tier, variant, precision, 0.0, INFINITY };
+    const CAS_State casState = options.SharpenOnly ? CAS_State_SharpenOnly : CAS_State_Upsample;
+
+    CAS_Filter filter;
+    filter.OnCreate(options.Threads, tier);
+    filter.SetVariant(variant);
+    filter.SetPrecision(precision);
+
+    double totalNs = 0.0, totalPixels = 0.0;
+    for (CorpusItem& item : corpus)
+    {
+        filter.OnCreateWindowSizeDependentResources(item.Input.Width, item.Input.Height, item.Output.Width, item.Output.Height, casState);
+        filter.UpdateSharpness(options.Sharpness, casState);
+
+        // The first run warms up and is the one measured for quality.
+        filter.Upscale(item.Input, item.Output, casState);
+        CAS_QualityStats stats;
+        CAS_Quality::Measure(item.Output, GetReference(options, item, variant), stats);
+        candidate.Quality = std::min(candidate.Quality, options.Ssim ? stats.Ssim : stats.Psnr);
+
+        std::vector<double> samples;
+        for (uint32_t i = 0; i < options.Repeat; ++i)
+        {
+            auto start = std::chrono::steady_clock::now();
+            filter.Upscale(item.Input, item.Output, casState);
+            auto end = std::chrono::steady_clock::now();
+            samples.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+        }
+        std::sort(samples.begin(), samples.end());
+        totalNs += Percentile(samples, 0.5);
+        totalPixels += static_cast<double>(item.Output.Width) * item.Output.Height;
+
+        filter.OnDestroyWindowSizeDependentResources();
+    }
+    filter.OnDestroy();
+
+    candidate.NsPerPixel = totalNs / totalPixels;
+    return candidate;
+}
+
+static bool TuneSchedules(const TuneOptions& options, std::vector<CorpusItem>& corpus, const CAS_Profile& profile)
+{
+    const CAS_State casState = options.SharpenOnly ? CAS_State_SharpenOnly : CAS_State_Upsample;
+    const std::string cpuName = CAS_Filter::GetCpuName();
+    printf("\nSchedule for %s, %u hardware threads, %u cores\n", cpuName.c_str(), CAS_ThreadPool::GetHardwareThreadCount(), CAS_ThreadPool::GetPhysicalCoreCount());
+    printf("%-28s %10s %8s %12s %10s\n", "Resolution", "tile", "threads", "traversal", "ns/pixel");
+
+    CAS_ScheduleCache cache;
+    cache.Load(options.pScheduleCachePath);
+    for (CorpusItem& item : corpus)
+    {
+        const std::string key = CAS_ScheduleCache::MakeKey(cpuName, casState, item.Input.Width, item.Input.Height, item.Output.Width, item.Output.Height);
+
+        CAS_Filter filter;
+        filter.OnCreate(0, profile.Tier);
+        filter.ApplyProfile(profile);
+        filter.OnCreateWindowSizeDependentResources(item.Input.Width, item.Input.Height, item.Output.Width, item.Output.Height, casState);
+        filter.UpdateSharpness(options.Sharpness, casState);
+        CAS_Schedule schedule = filter.TuneSchedule(item.Input, item.Output, casState);
+        filter.OnDestroyWindowSizeDependentResources();
+        filter.OnDestroy();
+
+        cache.Store(key, schedule);
+        char resolution[64], tile[32];
+        snprintf(resolution, sizeof(resolution), "%ux%u -> %ux%u", item.Input.Width, item.Input.Height, item.Output.Width, item.Output.Height);
+        snprintf(tile, sizeof(tile), "%ux%u", schedule.TileWidth, schedule.TileHeight);
+        printf("%-28s %10s %7u%s %12s %10.3f\n", resolution, tile, schedule.Threads, schedule.Hyperthreads ? "*" : " ",
+               CAS_Filter::GetTraversalName(schedule.Traversal), schedule.NsPerPixel);
+    }
+
+    if (!cache.Save(options.pScheduleCachePath))
+    {
+        printf("\nCould not write %s\n", options.pScheduleCachePath);
+        return false;
+    }
+    printf("\nWrote %s (* = uses hyperthreads)\n", options.pScheduleCachePath);
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    TuneOptions options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    std::vector<CorpusItem> corpus;
+    if (!LoadCorpus(options, corpus))
+    {
+        return 1;
+    }
+
+    const char* pMetric = options.Ssim ? "ssim" : "psnr";
+    printf("CAS_Tune: %s, sharpness %.2f, %zu image(s), %s >= %g, %u thread(s)\n", options.SharpenOnly ? "sharpen only" : "upsample",
+           options.Sharpness, corpus.size(), pMetric, options.Threshold, options.Threads);
+    for (const CorpusItem& item : corpus)
+    {
+        printf("  %s: %ux%u -> %ux%u%s\n", item.Name.c_str(), item.Input.Width, item.Input.Height, item.Output.Width, item.Output.Height,
+               item.HasTarget ? " (target)" : "");
+    }
+
+    std::vector<Candidate> candidates;
+    for (CAS_Tier tier : options.Tiers)
+    {
+        if (!CAS_Filter::IsTierSupported(tier))
+        {
+            continue;
+        }
+        for (uint32_t variant = 0; variant < CAS_Variant_Count; ++variant)
+        {
+            for (int precision = 0; precision < CAS_Precision_Count; ++precision)
+            {
+                candidates.push_back(RunCandidate(options, corpus, tier, variant, static_cast<CAS_Precision>(precision)));
+            }
+        }
+    }
+    if (candidates.empty())
+    {
+        printf("No supported tier selected\n");
+        return 1;
+    }
+
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) { return a.NsPerPixel < b.NsPerPixel; });
+
+    printf("\n%-7s %-44s %-9s %10s %10s\n", "Tier", "Variant", "Precision", "ns/pixel", options.Ssim ? "SSIM" : "PSNR(dB)");
+    const Candidate* pBest = nullptr;
+    for (const Candidate& c : candidates)
+    {
+        const bool pass = c.Quality >= options.Threshold;
+        if (pass && !pBest)
+        {
+            pBest = &c;
+        }
+        printf("%-7s %-44s %-9s %10.3f %10.5g%s\n", CAS_Filter::GetTierName(c.Tier), CAS_Filter::GetVariantName(c.Variant).c_str(),
+               CAS_Filter::GetPrecisionName(c.Precision), c.NsPerPixel, c.Quality, pBest == &c ? "  <- selected" : pass ? "" : "  below threshold");
+    }
+
+    if (!pBest)
+    {
+        printf("\nNo candidate reaches %s %g, no profile written\n", pMetric, options.Threshold);
+        return 1;
+    }
+
+    CAS_Profile profile;
+    profile.Tier = pBest->Tier;
+    profile.Variant = pBest->Variant;
+    profile.Precision = pBest->Precision;
+    profile.Metric = pMetric;
+    profile.Threshold = options.Threshold;
+    profile.Quality = pBest->Quality;
+    profile.NsPerPixel = pBest->NsPerPixel;
+    if (!CAS_ProfileFile::Save(options.pProfilePath, profile))
+    {
+        printf("\nCould not write %s\n", options.pProfilePath);
+        return 1;
+    }
+    printf("\nWrote %s\n", options.pProfilePath);
+
+    if (options.pScheduleCachePath && !TuneSchedules(options, corpus, profile))
+    {
+        return 1;
+    }
+    return 0;
+}
@@ -27,6 +27,16 @@
 
 namespace CAS_SAMPLE_DX12
 {
+    // Range of the luminance histogram in log2, as CAS_Filter::SetStatistics() of the CPU port defaults to.
+    static const float s_StatsMinLog2 = -10.0f;
+    static const float s_StatsMaxLog2 = 6.0f;
+    // Offset of the merged histogram and results in the stats buffer (CAS_STATS_HISTOGRAM), in bytes.
+    static const uint32_t s_StatsResultOffset = 64 * sizeof(uint32_t);
+    // Bins, results and the partials that follow them (CAS_STATS_PARTIALS), in uints.
+    static const uint32_t s_StatsHeaderSize = 64 * 2 + 4;
+    // This value is the image region dim that each thread group of the CAS shader operates on
+    static const int threadGroupWorkRegionDim = 16;
+
     void CAS_Filter::OnCreate(
         Device *pDevice,
         ResourceViewHeaps      *pResourceViewHeaps,
@@ -41,7 +51,7 @@ namespace CAS_SAMPLE_DX12
         m_pDevice = pDevice;
         
         m_pResourceViewHeaps->AllocCBV_SRV_UAVDescriptor(1, &m_constBuffer);
-        m_pResourceViewHeaps->AllocCBV_SRV_UAVDescriptor(1, &m_outputTextureUav);
+        m_pResourceViewHeaps->AllocCBV_SRV_UAVDescriptor(2, &m_outputTextureUav);
         m_pResourceViewHeaps->AllocCBV_SRV_UAVDescriptor(1, &m_outputTextureSrv);
         
         D3D12_STATIC_SAMPLER_DESC SamplerDesc = {};
@@ -62,25 +72,40 @@ namespace CAS_SAMPLE_DX12
         DefineList defines;
         defines["CAS_SAMPLE_FP16"] = "0";
         defines["CAS_SAMPLE_SHARPEN_ONLY"] = "0";
+        // Every CAS pass gathers the luminance statistics of its output into the buffer at u1, mergeStatsCS combines them.
+        defines["CAS_SAMPLE_STATS"] = "1";
 
         if (pDevice->IsFp16Supported())
         {
             defines["CAS_SAMPLE_FP16"] = "1";
 
             defines["CAS_SAMPLE_SHARPEN_ONLY"] = "1"; 
-            m_casPackedSharpenOnly.OnCreate(pDevice, pResourceViewHeaps, "CAS_Shader.hlsl", "mainCS", 1, 1, 64, 1, 1, &defines);
+            m_casPackedSharpenOnly.OnCreate(pDevice, pResourceViewHeaps, "CAS_Shader.hlsl", "mainCS", 2, 1, 64, 1, 1, &defines);
 
             defines["CAS_SAMPLE_SHARPEN_ONLY"] = "0";
-            m_casPackedFast.OnCreate(pDevice, pResourceViewHeaps, "CAS_Shader.hlsl", "mainCS", 1, 1, 64, 1, 1, &defines);
+            m_casPackedFast.OnCreate(pDevice, pResourceViewHeaps, "CAS_Shader.hlsl", "mainCS", 2, 1, 64, 1, 1, &defines);
         }
 
         defines["CAS_SAMPLE_FP16"] = "0";
 
         defines["CAS_SAMPLE_SHARPEN_ONLY"] = "1";
-        m_casSharpenOnly.OnCreate(pDevice, pResourceViewHeaps, "CAS_Shader.hlsl", "mainCS", 1, 1, 64, 1, 1, &defines);
+        m_casSharpenOnly.OnCreate(pDevice, pResourceViewHeaps, "CAS_Shader.hlsl", "mainCS", 2, 1, 64, 1, 1, &defines);
 
         defines["CAS_SAMPLE_SHARPEN_ONLY"] = "0"; 
-        m_casFast.OnCreate(pDevice, pResourceViewHeaps, "CAS_Shader.hlsl", "mainCS", 1, 1, 64, 1, 1, &defines);
+        m_casFast.OnCreate(pDevice, pResourceViewHeaps, "CAS_Shader.hlsl", "mainCS", 2, 1, 64, 1, 1, &defines);
+
+        // Same root signature as the CAS passes, so it binds the same tables.
+        m_casStatsMerge.OnCreate(pDevice, pResourceViewHeaps, "CAS_Shader.hlsl", "mergeStatsCS", 2, 1, 64, 1, 1, &defines);
+
+        // The statistics go through a ring of readback buffers, each mapped once the GPU is done with its frame.
+        for (uint32_t i = 0; i < s_StatsFrames; ++i)
+        {
+            ThrowIfFailed(pDevice->GetDevice()->CreateCommittedResource(&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_READBACK), D3D12_HEAP_FLAG_NONE, &CD3DX12_RESOURCE_DESC::Buffer(sizeof(CASStatistics)),
+                                                                        D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(&m_pStatsReadback[i])));
+            m_statsPending[i] = false;
+        }
+        m_statsFrame = 0;
+        m_statistics = {};
 
         m_renderFullscreen.OnCreate(pDevice, "CAS_RenderPS.hlsl", pResourceViewHeaps, pStaticBufferPool, 1, 1, &SamplerDesc, outFormat);
     }
@@ -127,6 +152,28 @@ namespace CAS_SAMPLE_DX12
             
             UpdateSharpness(m_sharpenVal, CASState);
         }
+
+        // Stats buffer, a partial per workgroup after the header. Committed resources start zeroed, which the bins need.
+        {
+            const uint32_t dispatchX = (Width + (threadGroupWorkRegionDim - 1)) / threadGroupWorkRegionDim;
+            const uint32_t dispatchY = (Height + (threadGroupWorkRegionDim - 1)) / threadGroupWorkRegionDim;
+            const uint32_t statsSize = s_StatsHeaderSize + 4 * dispatchX * dispatchY;
+            ThrowIfFailed(pDevice->GetDevice()->CreateCommittedResource(&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT), D3D12_HEAP_FLAG_NONE,
+                                                                        &CD3DX12_RESOURCE_DESC::Buffer(statsSize * sizeof(uint32_t), D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS),
+                                                                        D3D12_RESOURCE_STATE_UNORDERED_ACCESS, nullptr, IID_PPV_ARGS(&m_pStatsBuffer)));
+
+            D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
+            uavDesc.Format = DXGI_FORMAT_R32_TYPELESS;
+            uavDesc.ViewDimension = D3D12_UAV_DIMENSION_BUFFER;
+            uavDesc.Buffer.FirstElement = 0;
+            uavDesc.Buffer.NumElements = statsSize;
+            uavDesc.Buffer.Flags = D3D12_BUFFER_UAV_FLAG_RAW;
+            pDevice->GetDevice()->CreateUnorderedAccessView(m_pStatsBuffer, 0, &uavDesc, m_outputTextureUav.GetCPU(1));
+
+            const float binScale = 64.0f / (s_StatsMaxLog2 - s_StatsMinLog2);
+            const float binBias = -s_StatsMinLog2 * binScale;
+            m_consts.Const2 = XMUINT4(AU1_AF1(binScale), AU1_AF1(binBias), dispatchX, dispatchX * dispatchY);
+        }
     }
 
     void CAS_Filter::OnDestroyWindowSizeDependentResources()
@@ -135,13 +182,23 @@ namespace CAS_SAMPLE_DX12
         {
             m_pOutputTexture->Release();
         }
+        if (m_pStatsBuffer)
+        {
+            m_pStatsBuffer->Release();
+            m_pStatsBuffer = nullptr;
+        }
     }
 
     void CAS_Filter::OnDestroy()
     {
         m_casSharpenOnly.OnDestroy();
         m_casFast.OnDestroy();
+        m_casStatsMerge.OnDestroy();
         m_renderFullscreen.OnDestroy();
+        for (uint32_t i = 0; i < s_StatsFrames; ++i)
+        {
+            m_pStatsReadback[i]->Release();
+        }
         if (m_pDevice->IsFp16Supported())
         {
             m_casPackedFast.OnDestroy();
@@ -156,8 +213,6 @@ namespace CAS_SAMPLE_DX12
         m_pConstantBufferRing->AllocConstantBuffer(sizeof(CASConstants), (void **)&pConstMem, &cbHandle);
         memcpy(pConstMem, &m_consts, sizeof(CASConstants));
 
-        // This value is the image region dim that each thread group of the CAS shader operates on
-        static const int threadGroupWorkRegionDim = 16;
         int dispatchX = (m_width + (threadGroupWorkRegionDim - 1)) / threadGroupWorkRegionDim;
         int dispatchY = (m_height + (threadGroupWorkRegionDim - 1)) / threadGroupWorkRegionDim;
 
@@ -188,6 +243,26 @@ namespace CAS_SAMPLE_DX12
                 }
             }
 
+            // The slot of this frame was last written s_StatsFrames frames ago, its copy is done.
+            const uint32_t statsSlot = m_statsFrame++ % s_StatsFrames;
+            if (m_statsPending[statsSlot])
+            {
+                void* pStats = nullptr;
+                const D3D12_RANGE readRange = { 0, sizeof(CASStatistics) };
+                const D3D12_RANGE writtenRange = { 0, 0 };
+                ThrowIfFailed(m_pStatsReadback[statsSlot]->Map(0, &readRange, &pStats));
+                memcpy(&m_statistics, pStats, sizeof(CASStatistics));
+                m_pStatsReadback[statsSlot]->Unmap(0, &writtenRange);
+            }
+
+            // Merge the workgroup partials once all of them are written, then copy the result out.
+            pCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::UAV(m_pStatsBuffer));
+            m_casStatsMerge.Draw(pCommandList, cbHandle, &m_outputTextureUav, &inputSrv, 1, 1, 1);
+            pCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(m_pStatsBuffer, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_COPY_SOURCE, 0));
+            pCommandList->CopyBufferRegion(m_pStatsReadback[statsSlot], 0, m_pStatsBuffer, s_StatsResultOffset, sizeof(CASStatistics));
+            pCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(m_pStatsBuffer, D3D12_RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, 0));
+            m_statsPending[statsSlot] = true;
+
             // Transition our UAV to display it
             D3D12_RESOURCE_BARRIER Barriers[] = 
             {
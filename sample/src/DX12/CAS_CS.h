@@ -43,6 +43,19 @@ namespace CAS_SAMPLE_DX12
     {
         XMUINT4 Const0;
         XMUINT4 Const1;
+        XMUINT4 Const2;     // CAS_SAMPLE_STATS: histogram scale and bias (float bits), workgroups per row, workgroup count.
+    };
+
+    // Luminance statistics of the CAS output, the CAS_SAMPLE_STATS side output of the shader as it is laid out in the
+    // stats buffer after mergeStatsCS. Luminance is the Rec. 709 weighted sum of the output, the histogram has equal
+    // bins of log2 luminance from -10 to 6 (the CPU port's default), the first and last also count what is beyond.
+    struct CASStatistics
+    {
+        uint32_t Histogram[64];
+        float Min;
+        float Max;
+        float Mean;
+        uint32_t Count;
     };
 
     class CAS_Filter
@@ -67,6 +80,9 @@ namespace CAS_SAMPLE_DX12
 
         static void GetSupportedResolutions(uint32_t displayWidth, uint32_t displayHeight, std::vector<ResolutionInfo>& supportedList);
 
+        // Statistics of the last CAS frame read back, s_StatsFrames frames old. Count is 0 until one was.
+        const CASStatistics& GetStatistics() const { return m_statistics; }
+
     private:
         Device                         *m_pDevice;
 
@@ -77,6 +93,7 @@ namespace CAS_SAMPLE_DX12
         PostProcCS                      m_casFast;
         PostProcCS                      m_casPackedSharpenOnly;
         PostProcCS                      m_casPackedFast;
+        PostProcCS                      m_casStatsMerge;
         PostProcPS                      m_renderFullscreen;
 
         DXGI_FORMAT                     m_outFormat;
@@ -90,9 +107,17 @@ namespace CAS_SAMPLE_DX12
         CASConstants                    m_consts;
         CBV_SRV_UAV                     m_constBuffer;
 
-        CBV_SRV_UAV                     m_outputTextureUav;
+        CBV_SRV_UAV                     m_outputTextureUav;     // u0 the output texture, u1 the stats buffer.
         CBV_SRV_UAV                     m_outputTextureSrv;
         ID3D12Resource                 *m_pOutputTexture;
+
+        // Frames a readback buffer waits before it is mapped, more than the frames in flight (cNumSwapBufs).
+        static const uint32_t           s_StatsFrames = 3;
+        ID3D12Resource                 *m_pStatsBuffer;
+        ID3D12Resource                 *m_pStatsReadback[s_StatsFrames];
+        bool                            m_statsPending[s_StatsFrames];
+        uint32_t                        m_statsFrame;
+        CASStatistics                   m_statistics;
     };
 }
 
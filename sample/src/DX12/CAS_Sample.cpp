@@ -447,6 +447,12 @@ void CAS_Sample::OnRender()
         }
         ImGui::Text("Avg Cas Time: %f", m_CASAvgTiming);
 
+        if (m_state.CASState != CAS_State_NoCas)
+        {
+            const CASStatistics& statistics = m_pNode->GetCASStatistics();
+            ImGui::Text("Output luminance : min %.3f, max %.3f, mean %.3f", statistics.Min, statistics.Max, statistics.Mean);
+        }
+
         ImGui::End();
 
         // If the mouse was not used by the GUI then it's for the camera
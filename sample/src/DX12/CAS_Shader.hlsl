@@ -21,11 +21,21 @@ cbuffer cb : register(b0)
 {
     uint4 const0;
     uint4 const1;
+#if CAS_SAMPLE_STATS
+    uint4 const2;   // Histogram scale and bias of log2 luminance (as float bits), workgroups per row, workgroup count.
+#endif
 };
 
 Texture2D InputTexture : register(t0);
 RWTexture2D<float4> OutputTexture : register(u0);
 
+#if CAS_SAMPLE_STATS
+// Luminance statistics of the output, in uints: the 64 bins the workgroups add to, then what mergeStatsCS writes (the
+// frame's histogram, min, max, mean and pixel count), then the min, max, sum and count of every workgroup. The merge
+// clears the bins again for the next frame, the application only zeroes the buffer once.
+RWByteAddressBuffer StatsBuffer : register(u1);
+#endif
+
 #define A_GPU 1
 #define A_HLSL 1
 
@@ -64,11 +74,131 @@ void CasInput(inout AF1 r, inout AF1 g, inout AF1 b) {}
 
 #include "ffx_cas.h"
 
+#if CAS_SAMPLE_STATS
+
+#define CAS_STATS_BINS 64u
+#define CAS_STATS_HISTOGRAM (CAS_STATS_BINS * 4u)
+#define CAS_STATS_RESULT (CAS_STATS_HISTOGRAM * 2u)
+#define CAS_STATS_PARTIALS (CAS_STATS_RESULT + 16u)
+
+groupshared AU1 casStatsBins[CAS_STATS_BINS];
+groupshared AF1 casStatsMin[64];
+groupshared AF1 casStatsMax[64];
+groupshared AF1 casStatsSum[64];
+groupshared AU1 casStatsCount[64];
+
+// Adds an output pixel to the thread's partial and the workgroup's histogram.
+void CasStatsAdd(AF3 c, AU2 gxy, inout AF1 mn, inout AF1 mx, inout AF1 sum, inout AU1 count)
+{
+    AU1 width, height;
+    OutputTexture.GetDimensions(width, height);
+    if (gxy.x >= width || gxy.y >= height)
+    {
+        return;
+    }
+
+    AF1 luma = dot(c, AF3(0.2126, 0.7152, 0.0722));
+    mn = min(mn, luma);
+    mx = max(mx, luma);
+    sum += luma;
+    count++;
+    AF1 bin = log2(max(luma, AF1_(1.0e-30))) * AF1_AU1(const2.x) + AF1_AU1(const2.y);
+    InterlockedAdd(casStatsBins[AU1(clamp(bin, 0.0, AF1(CAS_STATS_BINS - 1u)))], 1u);
+}
+
+// Reduces the partials of the 64 threads into element 0. ARmpRed8x8() places 2x2 quads, then 4x4 blocks, in
+// consecutive lanes, so every step merges neighbouring 2D blocks: the order a wave reduction would take.
+void CasStatsReduce(AU1 lane)
+{
+    for (AU1 step = 1u; step < 64u; step <<= 1u)
+    {
+        GroupMemoryBarrierWithGroupSync();
+        if ((lane & (step * 2u - 1u)) == 0u)
+        {
+            casStatsMin[lane] = min(casStatsMin[lane], casStatsMin[lane + step]);
+            casStatsMax[lane] = max(casStatsMax[lane], casStatsMax[lane + step]);
+            casStatsSum[lane] += casStatsSum[lane + step];
+            casStatsCount[lane] += casStatsCount[lane + step];
+        }
+    }
+    GroupMemoryBarrierWithGroupSync();
+}
+
+// Writes the workgroup's partial and adds its histogram to the frame's.
+void CasStatsStore(AU1 lane, AU2 workGroup, AF1 mn, AF1 mx, AF1 sum, AU1 count)
+{
+    casStatsMin[lane] = mn;
+    casStatsMax[lane] = mx;
+    casStatsSum[lane] = sum;
+    casStatsCount[lane] = count;
+    CasStatsReduce(lane);
+    if (lane == 0u)
+    {
+        StatsBuffer.Store4(CAS_STATS_PARTIALS + 16u * (workGroup.y * const2.z + workGroup.x),
+                           AU4(AU1_AF1(casStatsMin[0]), AU1_AF1(casStatsMax[0]), AU1_AF1(casStatsSum[0]), casStatsCount[0]));
+    }
+    if (casStatsBins[lane] != 0u)
+    {
+        StatsBuffer.InterlockedAdd(lane * 4u, casStatsBins[lane]);
+    }
+}
+
+#define CAS_STATS_ADD(c, p) CasStatsAdd(c, p, statsMin, statsMax, statsSum, statsCount)
+
+// Merges the partials of all workgroups, one workgroup dispatched after mainCS.
+[numthreads(WIDTH, HEIGHT, DEPTH)]
+void mergeStatsCS(uint3 LocalThreadId : SV_GroupThreadID)
+{
+    AU1 lane = LocalThreadId.x;
+    StatsBuffer.Store(CAS_STATS_HISTOGRAM + lane * 4u, StatsBuffer.Load(lane * 4u));
+    StatsBuffer.Store(lane * 4u, 0u);
+
+    AF1 mn = AF1_AU1(0x7f7fffffu);
+    AF1 mx = -mn;
+    AF1 sum = 0.0;
+    AU1 count = 0u;
+    for (AU1 group = lane; group < const2.w; group += 64u)
+    {
+        AU4 partial = StatsBuffer.Load4(CAS_STATS_PARTIALS + 16u * group);
+        mn = min(mn, AF1_AU1(partial.x));
+        mx = max(mx, AF1_AU1(partial.y));
+        sum += AF1_AU1(partial.z);
+        count += partial.w;
+    }
+    casStatsMin[lane] = mn;
+    casStatsMax[lane] = mx;
+    casStatsSum[lane] = sum;
+    casStatsCount[lane] = count;
+    CasStatsReduce(lane);
+    if (lane == 0u)
+    {
+        AU1 total = casStatsCount[0];
+        StatsBuffer.Store4(CAS_STATS_RESULT, AU4(AU1_AF1(casStatsMin[0]), AU1_AF1(casStatsMax[0]), AU1_AF1(total > 0u ? casStatsSum[0] / AF1(total) : 0.0), total));
+    }
+}
+
+#else
+
+#define CAS_STATS_ADD(c, p)
+
+#endif
+
 [numthreads(WIDTH, HEIGHT, DEPTH)]
 void mainCS(uint3 LocalThreadId : SV_GroupThreadID, uint3 WorkGroupId : SV_GroupID)
 {
+#if CAS_SAMPLE_STATS
+    // Same 8x8 swizzle with the lane order the statistics reduction needs.
+    AU2 gxy = ARmpRed8x8(LocalThreadId.x) + AU2(WorkGroupId.x << 4u, WorkGroupId.y << 4u);
+    AF1 statsMin = AF1_AU1(0x7f7fffffu);
+    AF1 statsMax = -statsMin;
+    AF1 statsSum = 0.0;
+    AU1 statsCount = 0u;
+    casStatsBins[LocalThreadId.x] = 0u;
+    GroupMemoryBarrierWithGroupSync();
+#else
     // Do remapping of local xy in workgroup for a more PS-like swizzle pattern.
     AU2 gxy = ARmp8x8(LocalThreadId.x) + AU2(WorkGroupId.x << 4u, WorkGroupId.y << 4u);
+#endif
 
     bool sharpenOnly;
 #if CAS_SAMPLE_SHARPEN_ONLY
@@ -87,12 +217,16 @@ void mainCS(uint3 LocalThreadId : SV_GroupThreadID, uint3 WorkGroupId : SV_Group
     CasDepack(c0, c1, cR, cG, cB);
     OutputTexture[ASU2(gxy)] = AF4(c0);
     OutputTexture[ASU2(gxy) + ASU2(8, 0)] = AF4(c1);
+    CAS_STATS_ADD(AF3(c0.rgb), gxy);
+    CAS_STATS_ADD(AF3(c1.rgb), gxy + AU2(8u, 0u));
     gxy.y += 8u;
     
     CasFilterH(cR, cG, cB, gxy, const0, const1, sharpenOnly);
     CasDepack(c0, c1, cR, cG, cB);
     OutputTexture[ASU2(gxy)] = AF4(c0);
     OutputTexture[ASU2(gxy) + ASU2(8, 0)] = AF4(c1);
+    CAS_STATS_ADD(AF3(c0.rgb), gxy);
+    CAS_STATS_ADD(AF3(c1.rgb), gxy + AU2(8u, 0u));
     
 #else
     
@@ -101,18 +235,26 @@ void mainCS(uint3 LocalThreadId : SV_GroupThreadID, uint3 WorkGroupId : SV_Group
     
     CasFilter(c.r, c.g, c.b, gxy, const0, const1, sharpenOnly);
     OutputTexture[ASU2(gxy)] = AF4(c, 1);
+    CAS_STATS_ADD(c, gxy);
     gxy.x += 8u;
     
     CasFilter(c.r, c.g, c.b, gxy, const0, const1, sharpenOnly);
     OutputTexture[ASU2(gxy)] = AF4(c, 1);
+    CAS_STATS_ADD(c, gxy);
     gxy.y += 8u;
     
     CasFilter(c.r, c.g, c.b, gxy, const0, const1, sharpenOnly);
     OutputTexture[ASU2(gxy)] = AF4(c, 1);
+    CAS_STATS_ADD(c, gxy);
     gxy.x -= 8u;
     
     CasFilter(c.r, c.g, c.b, gxy, const0, const1, sharpenOnly);
     OutputTexture[ASU2(gxy)] = AF4(c, 1);
+    CAS_STATS_ADD(c, gxy);
     
 #endif
+
+#if CAS_SAMPLE_STATS
+    CasStatsStore(LocalThreadId.x, WorkGroupId.xy, statsMin, statsMax, statsSum, statsCount);
+#endif
 }
\ No newline at end of file
@@ -27,6 +27,49 @@
 
 namespace CAS_SAMPLE_VK
 {
+    // Range of the luminance histogram in log2, as CAS_Filter::SetStatistics() of the CPU port defaults to.
+    static const float s_StatsMinLog2 = -10.0f;
+    static const float s_StatsMaxLog2 = 6.0f;
+    // Offset of the merged histogram and results in the stats buffer (CAS_STATS_HISTOGRAM), in bytes.
+    static const VkDeviceSize s_StatsResultOffset = 64 * sizeof(uint32_t);
+    // Bins, results and the partials that follow them (CAS_STATS_PARTIALS), in uints.
+    static const uint32_t s_StatsHeaderSize = 64 * 2 + 4;
+    // This value is the image region dim that each thread group of the CAS shader operates on
+    static const int threadGroupWorkRegionDim = 16;
+
+    void CAS_Filter::CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& memory)
+    {
+        VkBufferCreateInfo bufferInfo = {};
+        bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        bufferInfo.size = size;
+        bufferInfo.usage = usage;
+        bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        VkResult res = vkCreateBuffer(m_pDevice->GetDevice(), &bufferInfo, NULL, &buffer);
+        assert(res == VK_SUCCESS);
+
+        VkMemoryRequirements requirements;
+        vkGetBufferMemoryRequirements(m_pDevice->GetDevice(), buffer, &requirements);
+        VkPhysicalDeviceMemoryProperties memoryProperties;
+        vkGetPhysicalDeviceMemoryProperties(m_pDevice->GetPhysicalDevice(), &memoryProperties);
+
+        VkMemoryAllocateInfo allocInfo = {};
+        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocInfo.allocationSize = requirements.size;
+        allocInfo.memoryTypeIndex = memoryProperties.memoryTypeCount;
+        for (uint32_t i = 0; i < memoryProperties.memoryTypeCount && allocInfo.memoryTypeIndex == memoryProperties.memoryTypeCount; ++i)
+        {
+            if ((requirements.memoryTypeBits & (1u << i)) && (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties)
+            {
+                allocInfo.memoryTypeIndex = i;
+            }
+        }
+        assert(allocInfo.memoryTypeIndex < memoryProperties.memoryTypeCount);
+        res = vkAllocateMemory(m_pDevice->GetDevice(), &allocInfo, NULL, &memory);
+        assert(res == VK_SUCCESS);
+        res = vkBindBufferMemory(m_pDevice->GetDevice(), buffer, memory, 0);
+        assert(res == VK_SUCCESS);
+    }
+
     void CAS_Filter::OnCreate(Device* pDevice, VkRenderPass renderPass, VkFormat outFormat, ResourceViewHeaps *pResourceViewHeaps, StaticBufferPool  *pStaticBufferPool, DynamicBufferRing *pDynamicBufferRing)
     {
         m_pDevice = pDevice;
@@ -50,7 +93,7 @@ namespace CAS_SAMPLE_VK
         }
 
         {
-            std::vector<VkDescriptorSetLayoutBinding> layoutBindings(3);
+            std::vector<VkDescriptorSetLayoutBinding> layoutBindings(4);
             layoutBindings[0].binding = 0;
             layoutBindings[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
             layoutBindings[0].descriptorCount = 1;
@@ -69,12 +112,22 @@ namespace CAS_SAMPLE_VK
             layoutBindings[2].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
             layoutBindings[2].pImmutableSamplers = NULL;
 
+            layoutBindings[3].binding = 3;
+            layoutBindings[3].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            layoutBindings[3].descriptorCount = 1;
+            layoutBindings[3].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+            layoutBindings[3].pImmutableSamplers = NULL;
+
             m_pResourceViewHeaps->CreateDescriptorSetLayoutAndAllocDescriptorSet(&layoutBindings, &m_upscaleDescriptorSetLayout, &m_upscaleDescriptorSet);
             m_pDynamicBufferRing->SetDescriptorSet(0, sizeof(uint32_t) * 12, m_upscaleDescriptorSet);
 
             DefineList defines;
             defines["CAS_SAMPLE_FP16"] = "0";
             defines["CAS_SAMPLE_SHARPEN_ONLY"] = "0";
+            // Every CAS pass gathers the luminance statistics of its output into the buffer at binding 3, the
+            // CAS_SAMPLE_STATS_MERGE variant combines them.
+            defines["CAS_SAMPLE_STATS"] = "1";
+            defines["CAS_SAMPLE_STATS_MERGE"] = "0";
 
             if (pDevice->IsFp16Supported())
             {
@@ -94,6 +147,25 @@ namespace CAS_SAMPLE_VK
 
             defines["CAS_SAMPLE_SHARPEN_ONLY"] = "0";
             m_casUpsample.OnCreate(pDevice, "CAS_Shader.glsl", "main", m_upscaleDescriptorSetLayout, 64, 1, 1, &defines);
+
+            defines["CAS_SAMPLE_STATS_MERGE"] = "1";
+            m_casStatsMerge.OnCreate(pDevice, "CAS_Shader.glsl", "main", m_upscaleDescriptorSetLayout, 64, 1, 1, &defines);
+        }
+
+        // The statistics go through a ring of readback slots, each read once the GPU is done with its frame.
+        {
+            CreateBuffer(sizeof(CASStatistics) * s_StatsFrames, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                         m_statsReadback, m_statsReadbackMemory);
+            void* pMapped = NULL;
+            VkResult res = vkMapMemory(m_pDevice->GetDevice(), m_statsReadbackMemory, 0, VK_WHOLE_SIZE, 0, &pMapped);
+            assert(res == VK_SUCCESS);
+            m_pStatsReadback = static_cast<const CASStatistics*>(pMapped);
+            for (uint32_t i = 0; i < s_StatsFrames; ++i)
+            {
+                m_statsPending[i] = false;
+            }
+            m_statsFrame = 0;
+            m_statistics = {};
         }
 
         {
@@ -122,8 +194,13 @@ namespace CAS_SAMPLE_VK
             m_casPackedUpsample.OnDestroy();
             m_casPackedSharpenOnly.OnDestroy();
         }
+        m_casStatsMerge.OnDestroy();
         m_renderFullscreen.OnDestroy();
 
+        vkUnmapMemory(m_pDevice->GetDevice(), m_statsReadbackMemory);
+        vkDestroyBuffer(m_pDevice->GetDevice(), m_statsReadback, nullptr);
+        vkFreeMemory(m_pDevice->GetDevice(), m_statsReadbackMemory, nullptr);
+
         vkDestroySampler(m_pDevice->GetDevice(), m_renderSampler, nullptr);
 
         m_pResourceViewHeaps->FreeDescriptor(m_upscaleDescriptorSet);
@@ -166,10 +243,25 @@ namespace CAS_SAMPLE_VK
             UpdateSharpness(m_sharpenVal, CASState);
         }
 
+        // Stats buffer, a partial per workgroup after the header.
+        const uint32_t dispatchX = (Width + (threadGroupWorkRegionDim - 1)) / threadGroupWorkRegionDim;
+        const uint32_t dispatchY = (Height + (threadGroupWorkRegionDim - 1)) / threadGroupWorkRegionDim;
+        const VkDeviceSize statsSize = (s_StatsHeaderSize + 4 * dispatchX * dispatchY) * sizeof(uint32_t);
+        {
+            CreateBuffer(statsSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_statsBuffer, m_statsMemory);
+            m_statsUndefined = true;
+
+            const float binScale = 64.0f / (s_StatsMaxLog2 - s_StatsMinLog2);
+            const float binBias = -s_StatsMinLog2 * binScale;
+            m_consts.Const2 = XMUINT4(AU1_AF1(binScale), AU1_AF1(binBias), dispatchX, dispatchX * dispatchY);
+        }
+
         // Write CAS descriptor set
         {
             VkDescriptorImageInfo ImgInfos[2] = {};
-            VkWriteDescriptorSet SetWrites[2] = {};
+            VkDescriptorBufferInfo BufferInfo = {};
+            VkWriteDescriptorSet SetWrites[3] = {};
 
             // Source img
             ImgInfos[0].sampler = VK_NULL_HANDLE;
@@ -195,6 +287,18 @@ namespace CAS_SAMPLE_VK
             SetWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
             SetWrites[1].pImageInfo = ImgInfos + 1;
 
+            // Stats buffer
+            BufferInfo.buffer = m_statsBuffer;
+            BufferInfo.offset = 0;
+            BufferInfo.range = statsSize;
+
+            SetWrites[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            SetWrites[2].dstSet = m_upscaleDescriptorSet;
+            SetWrites[2].dstBinding = 3;
+            SetWrites[2].descriptorCount = 1;
+            SetWrites[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            SetWrites[2].pBufferInfo = &BufferInfo;
+
             vkUpdateDescriptorSets(m_pDevice->GetDevice(), _countof(SetWrites), SetWrites, 0, 0);
         }
 
@@ -239,6 +343,8 @@ namespace CAS_SAMPLE_VK
     {
         m_dstTexture.OnDestroy();
         vkDestroyImageView(m_pDevice->GetDevice(), m_dstTextureSRV, nullptr);
+        vkDestroyBuffer(m_pDevice->GetDevice(), m_statsBuffer, nullptr);
+        vkFreeMemory(m_pDevice->GetDevice(), m_statsMemory, nullptr);
     }
 
     void CAS_Filter::Upscale(VkCommandBuffer cmd_buf, Texture srcImg, VkImageView srcImgView, bool useCas, bool usePacked, CAS_State casState)
@@ -266,6 +372,26 @@ namespace CAS_SAMPLE_VK
             vkCmdPipelineBarrier(cmd_buf, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, NULL, 0, NULL, 1, &barrier);
         }
 
+        if (m_statsUndefined)
+        {
+            m_statsUndefined = false;
+
+            // The stats buffer was just created, its bins have to start at 0. The merge pass clears them after that.
+            vkCmdFillBuffer(cmd_buf, m_statsBuffer, 0, VK_WHOLE_SIZE, 0);
+
+            VkBufferMemoryBarrier barrier = {};
+            barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.buffer = m_statsBuffer;
+            barrier.offset = 0;
+            barrier.size = VK_WHOLE_SIZE;
+
+            vkCmdPipelineBarrier(cmd_buf, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, NULL, 1, &barrier, 0, NULL);
+        }
+
         VkDescriptorBufferInfo constsHandle;
         uint32_t* pConstMem;
         m_pDynamicBufferRing->AllocConstantBuffer(sizeof(CASConstants), reinterpret_cast<void **>(&pConstMem), &constsHandle);
@@ -293,8 +419,6 @@ namespace CAS_SAMPLE_VK
                 vkCmdPipelineBarrier(cmd_buf, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, NULL, 0, NULL, 1, &barrier);
             }
 
-            // This value is the image region dim that each thread group of the CAS shader operates on
-            static const int threadGroupWorkRegionDim = 16;
             int dispatchX = (m_width + (threadGroupWorkRegionDim - 1)) / threadGroupWorkRegionDim;
             int dispatchY = (m_height + (threadGroupWorkRegionDim - 1)) / threadGroupWorkRegionDim;
 
@@ -321,6 +445,51 @@ namespace CAS_SAMPLE_VK
                 }
             }
 
+            // The slot of this frame was last written s_StatsFrames frames ago, its copy is done.
+            const uint32_t statsSlot = m_statsFrame++ % s_StatsFrames;
+            if (m_statsPending[statsSlot])
+            {
+                m_statistics = m_pStatsReadback[statsSlot];
+            }
+
+            // Merge the workgroup partials once all of them are written, then copy the result out.
+            {
+                VkBufferMemoryBarrier barrier = {};
+                barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+                barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+                barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+                barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                barrier.buffer = m_statsBuffer;
+                barrier.offset = 0;
+                barrier.size = VK_WHOLE_SIZE;
+
+                vkCmdPipelineBarrier(cmd_buf, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, NULL, 1, &barrier, 0, NULL);
+                m_casStatsMerge.Draw(cmd_buf, constsHandle, m_upscaleDescriptorSet, 1, 1, 1);
+
+                barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+                barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+                vkCmdPipelineBarrier(cmd_buf, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, NULL, 1, &barrier, 0, NULL);
+
+                VkBufferCopy region = {};
+                region.srcOffset = s_StatsResultOffset;
+                region.dstOffset = sizeof(CASStatistics) * statsSlot;
+                region.size = sizeof(CASStatistics);
+                vkCmdCopyBuffer(cmd_buf, m_statsBuffer, m_statsReadback, 1, &region);
+
+                // The next frame's workgroups write the buffer after the copy read it, the host reads the slot after it is written.
+                barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+                barrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+                vkCmdPipelineBarrier(cmd_buf, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, NULL, 1, &barrier, 0, NULL);
+
+                VkBufferMemoryBarrier readbackBarrier = barrier;
+                readbackBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+                readbackBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+                readbackBarrier.buffer = m_statsReadback;
+                vkCmdPipelineBarrier(cmd_buf, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, NULL, 1, &readbackBarrier, 0, NULL);
+            }
+            m_statsPending[statsSlot] = true;
+
             // Transition dstImg from UAV to ps texture
             {
                 VkImageMemoryBarrier barrier = {};
@@ -44,6 +44,20 @@ namespace CAS_SAMPLE_VK
     {
         XMUINT4 Const0;
         XMUINT4 Const1;
+        XMUINT4 Const2;     // CAS_SAMPLE_STATS: histogram scale and bias (float bits), workgroups per row, workgroup count.
+    };
+
+    // Luminance statistics of the CAS output, the CAS_SAMPLE_STATS side output of the shader as it is laid out in the
+    // stats buffer after the CAS_SAMPLE_STATS_MERGE pass. Luminance is the Rec. 709 weighted sum of the output, the
+    // histogram has equal bins of log2 luminance from -10 to 6 (the CPU port's default), the first and last also count
+    // what is beyond.
+    struct CASStatistics
+    {
+        uint32_t Histogram[64];
+        float Min;
+        float Max;
+        float Mean;
+        uint32_t Count;
     };
 
     class CAS_Filter
@@ -62,7 +76,12 @@ namespace CAS_SAMPLE_VK
 
         static void GetSupportedResolutions(uint32_t displayWidth, uint32_t displayHeight, std::vector<ResolutionInfo>& supportedList);
 
+        // Statistics of the last CAS frame read back, s_StatsFrames frames old. Count is 0 until one was.
+        const CASStatistics& GetStatistics() const { return m_statistics; }
+
     private:
+        void CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& memory);
+
         Device                         *m_pDevice;
         ResourceViewHeaps              *m_pResourceViewHeaps;
 
@@ -77,6 +96,7 @@ namespace CAS_SAMPLE_VK
         PostProcCS                      m_casUpsample;
         PostProcCS                      m_casPackedSharpenOnly;
         PostProcCS                      m_casPackedUpsample;
+        PostProcCS                      m_casStatsMerge;
         PostProcPS                      m_renderFullscreen;
 
         DynamicBufferRing              *m_pDynamicBufferRing = NULL;
@@ -93,5 +113,18 @@ namespace CAS_SAMPLE_VK
         VkDescriptorSetLayout           m_renderDescriptorSetLayout;
 
         bool                            m_dstLayoutUndefined;
+
+        // Binding 3 of the CAS passes, zeroed once after it is created (m_statsUndefined).
+        VkBuffer                        m_statsBuffer;
+        VkDeviceMemory                  m_statsMemory;
+        bool                            m_statsUndefined;
+        // Frames a readback slot waits before it is read, more than the frames in flight (cNumSwapBufs).
+        static const uint32_t           s_StatsFrames = 3;
+        VkBuffer                        m_statsReadback;        // s_StatsFrames CASStatistics, host visible and mapped.
+        VkDeviceMemory                  m_statsReadbackMemory;
+        const CASStatistics            *m_pStatsReadback;
+        bool                            m_statsPending[s_StatsFrames];
+        uint32_t                        m_statsFrame;
+        CASStatistics                   m_statistics;
     };
 }
@@ -79,6 +79,8 @@ public:
     void OnRender(State *pState, SwapChain *pSwapChain);
 
     void UpdateCASSharpness(float sharpenControl, CAS_State CASState);
+    // Luminance statistics of the CAS output, a few frames late.
+    const CASStatistics& GetCASStatistics() const { return m_CAS.GetStatistics(); }
 
 private:
     Device                         *m_pDevice;
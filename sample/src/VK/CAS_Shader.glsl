@@ -26,12 +26,25 @@ layout(set=0,binding=0) uniform const_buffer
 {
     uvec4 const0;
     uvec4 const1;
+#if CAS_SAMPLE_STATS
+    uvec4 const2;   // Histogram scale and bias of log2 luminance (as float bits), workgroups per row, workgroup count.
+#endif
 };
 
 layout(set=0,binding=1,rgba16) uniform image2D imgSrc;
 
 layout(set=0,binding=2,rgba16) uniform image2D imgDst; 
 
+#if CAS_SAMPLE_STATS
+// Luminance statistics of the output: the 64 bins the workgroups add to, then what the CAS_SAMPLE_STATS_MERGE variant
+// writes (the frame's histogram, min, max, mean and pixel count), then the min, max, sum and count of every workgroup.
+// The merge clears the bins again for the next frame, the application only zeroes the buffer once.
+layout(set=0,binding=3,std430) buffer stats_buffer
+{
+    uint statsData[];
+};
+#endif
+
 #define A_GPU 1
 #define A_GLSL 1
 
@@ -71,10 +84,138 @@ void CasInput(inout AF1 r, inout AF1 g, inout AF1 b) {}
 #include "ffx_cas.h"
 
 layout(local_size_x=64) in;
+
+#if CAS_SAMPLE_STATS
+
+#define CAS_STATS_BINS 64u
+#define CAS_STATS_HISTOGRAM CAS_STATS_BINS
+#define CAS_STATS_RESULT (CAS_STATS_HISTOGRAM + CAS_STATS_BINS)
+#define CAS_STATS_PARTIALS (CAS_STATS_RESULT + 4u)
+
+shared AU1 casStatsBins[CAS_STATS_BINS];
+shared AF1 casStatsMin[64];
+shared AF1 casStatsMax[64];
+shared AF1 casStatsSum[64];
+shared AU1 casStatsCount[64];
+
+// Adds an output pixel to the thread's partial and the workgroup's histogram.
+void CasStatsAdd(AF3 c, AU2 gxy, inout AF1 mn, inout AF1 mx, inout AF1 sum, inout AU1 count)
+{
+    if (any(greaterThanEqual(ASU2(gxy), imageSize(imgDst))))
+    {
+        return;
+    }
+
+    AF1 luma = dot(c, AF3(0.2126, 0.7152, 0.0722));
+    mn = min(mn, luma);
+    mx = max(mx, luma);
+    sum += luma;
+    count++;
+    AF1 bin = log2(max(luma, AF1_(1.0e-30))) * AF1_AU1(const2.x) + AF1_AU1(const2.y);
+    atomicAdd(casStatsBins[AU1(clamp(bin, 0.0, AF1(CAS_STATS_BINS - 1u)))], 1u);
+}
+
+// Reduces the partials of the 64 threads into element 0. ARmpRed8x8() places 2x2 quads, then 4x4 blocks, in
+// consecutive lanes, so every step merges neighbouring 2D blocks: the order a subgroup reduction would take.
+void CasStatsReduce(AU1 lane)
+{
+    for (AU1 step = 1u; step < 64u; step <<= 1u)
+    {
+        barrier();
+        if ((lane & (step * 2u - 1u)) == 0u)
+        {
+            casStatsMin[lane] = min(casStatsMin[lane], casStatsMin[lane + step]);
+            casStatsMax[lane] = max(casStatsMax[lane], casStatsMax[lane + step]);
+            casStatsSum[lane] += casStatsSum[lane + step];
+            casStatsCount[lane] += casStatsCount[lane + step];
+        }
+    }
+    barrier();
+}
+
+// Writes the workgroup's partial and adds its histogram to the frame's.
+void CasStatsStore(AU1 lane, AU2 workGroup, AF1 mn, AF1 mx, AF1 sum, AU1 count)
+{
+    casStatsMin[lane] = mn;
+    casStatsMax[lane] = mx;
+    casStatsSum[lane] = sum;
+    casStatsCount[lane] = count;
+    CasStatsReduce(lane);
+    if (lane == 0u)
+    {
+        AU1 partial = CAS_STATS_PARTIALS + 4u * (workGroup.y * const2.z + workGroup.x);
+        statsData[partial] = AU1_AF1(casStatsMin[0]);
+        statsData[partial + 1u] = AU1_AF1(casStatsMax[0]);
+        statsData[partial + 2u] = AU1_AF1(casStatsSum[0]);
+        statsData[partial + 3u] = casStatsCount[0];
+    }
+    if (casStatsBins[lane] != 0u)
+    {
+        atomicAdd(statsData[lane], casStatsBins[lane]);
+    }
+}
+
+#define CAS_STATS_ADD(c, p) CasStatsAdd(c, p, statsMin, statsMax, statsSum, statsCount)
+
+#else
+
+#define CAS_STATS_ADD(c, p)
+
+#endif
+
+#if CAS_SAMPLE_STATS_MERGE
+
+// Merges the partials of all workgroups, one workgroup dispatched after the CAS pass.
 void main()
 {
+    AU1 lane = gl_LocalInvocationID.x;
+    statsData[CAS_STATS_HISTOGRAM + lane] = statsData[lane];
+    statsData[lane] = 0u;
+
+    AF1 mn = AF1_AU1(0x7f7fffffu);
+    AF1 mx = -mn;
+    AF1 sum = 0.0;
+    AU1 count = 0u;
+    for (AU1 group = lane; group < const2.w; group += 64u)
+    {
+        AU1 partial = CAS_STATS_PARTIALS + 4u * group;
+        mn = min(mn, AF1_AU1(statsData[partial]));
+        mx = max(mx, AF1_AU1(statsData[partial + 1u]));
+        sum += AF1_AU1(statsData[partial + 2u]);
+        count += statsData[partial + 3u];
+    }
+    casStatsMin[lane] = mn;
+    casStatsMax[lane] = mx;
+    casStatsSum[lane] = sum;
+    casStatsCount[lane] = count;
+    CasStatsReduce(lane);
+    if (lane == 0u)
+    {
+        AU1 total = casStatsCount[0];
+        statsData[CAS_STATS_RESULT] = AU1_AF1(casStatsMin[0]);
+        statsData[CAS_STATS_RESULT + 1u] = AU1_AF1(casStatsMax[0]);
+        statsData[CAS_STATS_RESULT + 2u] = AU1_AF1(total > 0u ? casStatsSum[0] / AF1(total) : 0.0);
+        statsData[CAS_STATS_RESULT + 3u] = total;
+    }
+}
+
+#else
+
+void main()
+{
+#if CAS_SAMPLE_STATS
+    // Same 8x8 swizzle with the lane order the statistics reduction needs.
+    AU2 gxy = ARmpRed8x8(gl_LocalInvocationID.x)+AU2(gl_WorkGroupID.x<<4u,gl_WorkGroupID.y<<4u);
+    AF1 statsMin = AF1_AU1(0x7f7fffffu);
+    AF1 statsMax = -statsMin;
+    AF1 statsSum = 0.0;
+    AU1 statsCount = 0u;
+    casStatsBins[gl_LocalInvocationID.x] = 0u;
+    barrier();
+#else
     // Do remapping of local xy in workgroup for a more PS-like swizzle pattern.
     AU2 gxy = ARmp8x8(gl_LocalInvocationID.x)+AU2(gl_WorkGroupID.x<<4u,gl_WorkGroupID.y<<4u);
+#endif
 
     bool sharpenOnly;
 #if CAS_SAMPLE_SHARPEN_ONLY
@@ -93,12 +234,16 @@ void main()
     CasDepack(c0, c1, cR, cG, cB);
     imageStore(imgDst, ASU2(gxy), AF4(c0));
     imageStore(imgDst, ASU2(gxy)+ASU2(8,0), AF4(c1));
+    CAS_STATS_ADD(AF3(c0.rgb), gxy);
+    CAS_STATS_ADD(AF3(c1.rgb), gxy + AU2(8u, 0u));
     gxy.y+=8u;
 
     CasFilterH(cR, cG, cB, gxy, const0, const1, sharpenOnly);
     CasDepack(c0, c1, cR, cG, cB);
     imageStore(imgDst, ASU2(gxy), AF4(c0));
     imageStore(imgDst, ASU2(gxy)+ASU2(8,0), AF4(c1));
+    CAS_STATS_ADD(AF3(c0.rgb), gxy);
+    CAS_STATS_ADD(AF3(c1.rgb), gxy + AU2(8u, 0u));
 
 #else
 
@@ -106,18 +251,28 @@ void main()
     AF4 c;
     CasFilter(c.r, c.g, c.b, gxy, const0, const1, sharpenOnly);
     imageStore(imgDst, ASU2(gxy), c);
+    CAS_STATS_ADD(c.rgb, gxy);
     gxy.x += 8u;
 
     CasFilter(c.r, c.g, c.b, gxy, const0, const1, sharpenOnly);
     imageStore(imgDst, ASU2(gxy), c);
+    CAS_STATS_ADD(c.rgb, gxy);
     gxy.y += 8u;
 
     CasFilter(c.r, c.g, c.b, gxy, const0, const1, sharpenOnly);
     imageStore(imgDst, ASU2(gxy), c);
+    CAS_STATS_ADD(c.rgb, gxy);
     gxy.x -= 8u;
 
     CasFilter(c.r, c.g, c.b, gxy, const0, const1, sharpenOnly);
     imageStore(imgDst, ASU2(gxy), c);
+    CAS_STATS_ADD(c.rgb, gxy);
 
 #endif
-}
\ No newline at end of file
+
+#if CAS_SAMPLE_STATS
+    CasStatsStore(gl_LocalInvocationID.x, gl_WorkGroupID.xy, statsMin, statsMax, statsSum, statsCount);
+#endif
+}
+
+#endif
\ No newline at end of file